@@ -2,6 +2,8 @@ grammar Commander;
 
 command : goCommand
         | stepCommand
+        | nextCommand
+        | finishCommand
         | quitCommand
         | breakCommand
         | unbreakCommand
@@ -9,24 +11,42 @@ command : goCommand
         | stackCommand
         | watchCommand
         | unwatchCommand
+        | recordCommand
+        | backCommand
         ;
         
 goCommand      : GO NEWLINE ;
 stepCommand    : STEP NEWLINE | NEWLINE ;
+nextCommand    : NEXT NEWLINE ;
+finishCommand  : FINISH NEWLINE ;
 quitCommand    : QUIT NEWLINE ;
-breakCommand   : BREAK lineNumberList? NEWLINE ;
-unbreakCommand : UNBREAK lineNumberList NEWLINE ;
+breakCommand   : BREAK lineNumberList? NEWLINE
+               | BREAK breakpoint NEWLINE
+               ;
+unbreakCommand : UNBREAK ( lineNumberList | routineEvent ) NEWLINE ;
 showCommand    : SHOW variableList NEWLINE ;
 stackCommand   : STACK NEWLINE ;
-watchCommand   : WATCH simpleVariableList? NEWLINE ;
-unwatchCommand : UNWATCH simpleVariableList NEWLINE ;
+watchCommand   : WATCH variableList? NEWLINE ;
+unwatchCommand : UNWATCH variableList NEWLINE ;
+recordCommand  : RECORD NEWLINE ;
+backCommand    : ( BACK | REVERSE_STEP ) statementCount? NEWLINE ;
 
 lineNumberList     : lineNumber ( ','? lineNumber )* ;
 variableList       : variable ( ','? variable )* ;
-simpleVariableList : simpleVariable ( ','? simpleVariable )* ;
 
 lineNumber     : INTEGER ;
-simpleVariable : IDENTIFIER;
+
+breakpoint     : lineNumber breakCondition
+               | routineEvent breakCondition?
+               ;
+routineEvent   : ( ENTRY | EXIT ) routineName ;
+routineName    : IDENTIFIER ;
+breakCondition : AFTER hitCount ( IF condition )?
+               | IF condition
+               ;
+hitCount       : INTEGER ;
+statementCount : INTEGER ;
+condition      : ~NEWLINE+ ;  // a Pascal boolean expression
 
 variable  : IDENTIFIER modifier* ;
 modifier  : '[' indexList ']' | '.' field ;
@@ -68,11 +88,23 @@ UNWATCH : U N W A T C H ;
 SHOW    : S H O W ;
 STACK   : S T A C K ;
 STEP    : S T E P ;
+NEXT    : N E X T ;
+FINISH  : F I N I S H ;
 GO      : G O ;
 QUIT    : Q U I T ;
+ENTRY   : E N T R Y ;
+EXIT    : E X I T ;
+AFTER   : A F T E R ;
+IF      : I F ;
+RECORD  : R E C O R D ;
+BACK    : B A C K ;
+
+REVERSE_STEP : R E V E R S E '-' S T E P ;
 
 IDENTIFIER : [a-zA-Z][a-zA-Z0-9]* ;
 INTEGER    : [0-9]+ ;
 NEWLINE    : '\r'? '\n' ;
 
-WS : [ \t]+ -> skip ; 
+WS : [ \t]+ -> skip ;
+
+OTHER : . ;  // any other character of a condition
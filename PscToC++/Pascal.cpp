@@ -3,20 +3,31 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 
 #include "antlr4-runtime.h"
-#include "PascalLexer.h"
 #include "PascalParser.h"
 
+#include "frontend/SourceBuffer.h"
 #include "frontend/Listing.h"
-#include "frontend/SyntaxErrorHandler.h"
+#include "frontend/SourceWatcher.h"
+#include "frontend/ResidentProgram.h"
 #include "frontend/Semantics.h"
 #include "intermediate/symtab/Predefined.h"
+#include "intermediate/symtab/UnitInterface.h"
 #include "intermediate/type/Typespec.h"
+#include "intermediate/util/CrossReferencer.h"
+#include "intermediate/util/Arena.h"
 #include "backend/BackendMode.h"
 #include "backend/interpreter/Executor.h"
 #include "backend/debugger/Debugger.h"
 #include "backend/converter/Converter.h"
+#include "backend/compiler/Compiler.h"
 
 using namespace std;
 using namespace antlrcpp;
@@ -25,67 +36,84 @@ using namespace antlr4;
 using namespace frontend;
 using namespace intermediate::type;
 using namespace intermediate::symtab;
+using namespace intermediate::util;
 using namespace backend::interpreter;
 using namespace backend::debugger;
 using namespace backend::converter;
+using namespace backend::compiler;
 
-int main(int argc, const char *args[])
+/**
+ * Print how long a pass took and the peak memory use of the process
+ * so far, of the largest child process such as a native build,
+ * and of the arena of the symbol tables and types.
+ * @param pass the name of the pass.
+ * @param start when the pass started.
+ * @param end when the pass ended.
+ * @param arena the arena.
+ */
+void printTiming(string pass, chrono::steady_clock::time_point start,
+                 chrono::steady_clock::time_point end, const Arena& arena)
 {
-    if (argc != 3)
-    {
-        cout << "USAGE: PascalCpp option sourceFileName" << endl;
-        cout << "   option: -execute, -debug, -convert, or -compile" << endl;
-        return -1;
-    }
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
 
-    string option = toLowerCase(args[1]);
-    string sourceFileName = args[2];
+    cout.flush();
+    printf("\nTiming: %s %.3f ms, peak memory %ld KB, children %ld KB, "
+           "arena %zu KB in %zu blocks (%zu objects)\n",
+           pass.c_str(),
+           chrono::duration<double, milli>(end - start).count(),
+           self.ru_maxrss, children.ru_maxrss,
+           (arena.getPeak() + 1023)/1024, arena.getBlockCount(),
+           arena.getObjectCount());
+    fflush(stdout);
+}
 
-    BackendMode mode = EXECUTOR;
+/**
+ * Translate a source file: parse it, check its semantics,
+ * and execute, debug, or convert it. A unit's interface file
+ * is written after pass 2, and then it can only be converted.
+ * A program translated again only parses and checks what changed.
+ * @param mode the backend mode.
+ * @param program the resident program of the source file.
+ * @param isolate true to run pass 3 in a child process, so that a runtime
+ *                abort or a debugger quit doesn't end the caller
+ *                or change the resident program.
+ * @param options the options for converted code.
+ * @param xref what cross-reference output to produce.
+ * @param timing true to print the time and memory use of each pass.
+ * @param check true to execute with subrange and array index checks.
+ * @return the number of syntax or semantic errors.
+ */
+int translate(BackendMode mode, ResidentProgram& program, bool isolate,
+              const ConverterOptions& options,
+              const CrossReferenceOptions& xref, bool timing, bool check)
+{
+    auto start = chrono::steady_clock::now();
 
-    if      (option == "-convert") mode = CONVERTER;
-    else if (option == "-debug")   mode = DEBUGGER;
-    else if (option == "-execute") mode = EXECUTOR;
-    else if (option == "-compile") mode = COMPILER;
-    else
-    {
-        cout << "ERROR: Invalid option." << endl;
-        cout << "   Valid options: -execute, -debug, -convert, or -compile" << endl;
-        return -2;
-    }
+    // Read the source file once. The listing, the lexer,
+    // and the syntax error handler all share the buffer.
+    const SourceBuffer& source = program.read();
 
     // Generate a source file listing.
-    Listing listing(sourceFileName);
-
-    ifstream ins;
-    ins.open(args[2]);
-
-    // Create the input stream.
-    ANTLRInputStream input(ins);
-
-    // Custom syntax error handler.
-    SyntaxErrorHandler syntaxErrorHandler;
-
-    // Create a lexer which scans the character stream
-    // to create a token stream.
-    PascalLexer lexer(&input);
-    lexer.removeErrorListeners();
-    lexer.addErrorListener(&syntaxErrorHandler);
-    CommonTokenStream tokens(&lexer);
+    Listing listing(source);
+    if (timing)
+    {
+        printTiming("Listing", start, chrono::steady_clock::now(),
+                    program.getArena());
+    }
 
-    // Create a parser which parses the token stream.
-    PascalParser parser(&tokens);
+    start = chrono::steady_clock::now();
 
-    // Pass 1: Check syntax and create the parse tree.
+    // Pass 1: Check syntax and create the parse tree,
+    // or replace the tree of only the part that changed.
     cout << endl << "PASS 1 Syntax: ";
-    parser.removeErrorListeners();
-    parser.addErrorListener(&syntaxErrorHandler);
-    tree::ParseTree *tree = parser.program();
+    int errorCount = program.parse();
+    auto end = chrono::steady_clock::now();
 
     // Allow any syntax error messages to print.
     this_thread::sleep_for(chrono::milliseconds(100));
 
-    int errorCount = syntaxErrorHandler.getCount();
     if (errorCount > 0)
     {
         printf("\nThere were %d syntax errors.\n", errorCount);
@@ -95,22 +123,112 @@ int main(int argc, const char *args[])
     else
     {
         cout << "There were no syntax errors." << endl;
+        if (!program.getReparsed().empty())
+        {
+            cout << "Re-parsed " << program.getReparsed() << "." << endl;
+        }
     }
 
-    // Pass 2: Create symbol tables and set parse tree node datatypes.
+    if (timing) printTiming("PASS 1", start, end, program.getArena());
+
+    PascalParser::CompilationUnitContext *tree = program.getTree();
+    bool unit = tree->unit() != nullptr;
+
+    // Pass 2: Create symbol tables and set parse tree node datatypes,
+    // or update those of only the parts that changed.
     cout << endl << "PASS 2 Semantics:" << endl ;
-    Semantics *pass2 = new Semantics(mode);
-    pass2->visit(tree);
+    start = chrono::steady_clock::now();
+    Semantics *pass2 = program.check();
+    if (!program.getRechecked().empty())
+    {
+        cout << "Re-checked " << program.getRechecked() << "." << endl;
+    }
+    if (timing)
+    {
+        printTiming("PASS 2", start, chrono::steady_clock::now(),
+                    program.getArena());
+    }
+
+    // The symbol tables and types of the program, and anything
+    // that pass 3 allocates.
+    Arena& arena = program.getArena();
+    Arena::Scope scope(&arena);
+
+    if (xref.table || xref.json)
+    {
+        CrossReferencer crossReferencer;
+        if (xref.table) crossReferencer.print(pass2->getProgramId());
+        if (xref.json)
+        {
+            string fileName = crossReferencer.writeJson(pass2->getProgramId());
+            cout << endl << "Cross-reference index \"" << fileName
+                 << "\" created." << endl;
+        }
+    }
 
     int error_count = pass2->getErrorCount();
     if (error_count > 0)
     {
         cout << endl << "There were " << error_count << " semantic errors."
              << " Object file not created or modified." << endl;
-        return errorCount;
+        return error_count;
+    }
+
+    if (unit)
+    {
+        SymtabEntry *unitId = pass2->getProgramId();
+        string fileName = UnitInterface::fileName(unitId->getName());
+
+        if (!UnitInterface::write(unitId, pass2->getExports(),
+                                  pass2->getUses()))
+        {
+            cout << endl << "ERROR: Failed to write interface file \""
+                 << fileName << "\"." << endl;
+            return 1;
+        }
+
+        cout << endl << "Interface file \"" << fileName << "\" created."
+             << endl;
+
+        // There's nothing to execute in a unit by itself.
+        if ((mode == EXECUTOR) || (mode == DEBUGGER)) return 0;
+    }
+
+    // The executor and debugger need the parse trees of the units'
+    // routines, which only their own translations have.
+    else if (   !pass2->getUnits().empty()
+             && ((mode == EXECUTOR) || (mode == DEBUGGER)))
+    {
+        cout << endl << "ERROR: A program that uses units must be"
+             << " converted or compiled." << endl;
+        return 1;
+    }
+
+    pid_t child = 0;
+
+    if (isolate)
+    {
+        cout.flush();
+        fflush(stdout);
+
+        child = fork();
+        if (child < 0)
+        {
+            cout << "ERROR: Failed to create a process for pass 3." << endl;
+            return 0;
+        }
+    }
+
+    // The parent of an isolated pass 3 just waits for it.
+    if (child > 0)
+    {
+        waitpid(child, nullptr, 0);
+        return 0;
     }
 
     // Pass 3: Translation.
+    start = chrono::steady_clock::now();
+
     switch (mode)
     {
         case EXECUTOR:
@@ -118,8 +236,18 @@ int main(int argc, const char *args[])
             // Pass 3: Execute the Pascal program.
             cout << endl << "PASS 3 Execution:" << endl << endl;
             SymtabEntry *programId = pass2->getProgramId();
-            Executor *pass3 = new Executor(programId);
-            pass3->visit(tree);
+
+            if (check)
+            {
+                Executor<NoHooks> *pass3 = new Executor<NoHooks>(programId);
+                pass3->visit(tree);
+            }
+            else
+            {
+                Executor<UncheckedHooks> *pass3 =
+                                new Executor<UncheckedHooks>(programId);
+                pass3->visit(tree);
+            }
             break;
         }
 
@@ -137,20 +265,189 @@ int main(int argc, const char *args[])
         {
             // Pass 3: Convert from Pascal to Java.
             cout << endl << "PASS 3 Translation:" << endl;
-            Converter *pass3 = new Converter();
+            Converter *pass3 = new Converter(options);
             pass3->visit(tree);
+            end = chrono::steady_clock::now();
+
+            long elapsed = chrono::duration_cast<chrono::microseconds>
+                                                        (end - start).count();
+            int lines = pass3->getLineCount();
 
             cout << endl << "Object file \"" << pass3->getObjectFileName()
                  << "\" created." << endl;
+            printf("Converted %d lines in %ld milliseconds "
+                   "(%.0f lines per second).\n", lines, elapsed/1000,
+                   lines/(max(elapsed, 1L)/1.0e6));
             break;
         }
 
         case COMPILER:
         {
-            // Pass 3: Compile the Pascal program.
+            // Pass 3: Convert the Pascal program to C++
+            // and build a native executable.
+            cout << endl << "PASS 3 Compilation:" << endl;
+            Compiler *pass3 = new Compiler(source, options);
+            pass3->setUnits(pass2->getUnits());
+
+            if (pass3->compile(tree))
+            {
+                cout << endl << (unit ? "Object file \"" : "Executable \"")
+                     << pass3->getExecutableFileName() << "\" created."
+                     << endl;
+            }
             break;
         }
     }
 
+    if (timing)
+    {
+        printTiming("PASS 3", start, chrono::steady_clock::now(), arena);
+    }
+
+    if (isolate)
+    {
+        cout.flush();
+        exit(0);
+    }
+
     return 0;
 }
+
+int main(int argc, const char *args[])
+{
+    if (argc < 3)
+    {
+        cout << "USAGE: PascalCpp option [-watch] [-parallel] [-vectorize]"
+             << " [-instrument] [-xref] [-xref-json] [-timing] [-nocheck]"
+             << " sourceFileName" << endl;
+        cout << "   option: -execute, -debug, -convert, or -compile" << endl;
+        cout << "   -watch: translate again whenever the source file changes,"
+             << " re-parsing and re-checking only the changed routines"
+             << endl;
+        cout << "   -parallel: run independent FOR loops of converted code"
+             << " with OpenMP" << endl;
+        cout << "   -vectorize: hoist array subscript offsets out of"
+             << " innermost FOR loops of converted code" << endl;
+        cout << "   -instrument: print the call counts and times of the"
+             << " routines of converted code" << endl;
+        cout << "   -xref: print the cross-reference table" << endl;
+        cout << "   -xref-json: write the cross-reference index"
+             << " to programName.xref.json" << endl;
+        cout << "   -timing: print the time and peak memory of each pass"
+             << endl;
+        cout << "   -nocheck: execute without subrange and array index checks"
+             << " (not with -debug)" << endl;
+        return -1;
+    }
+
+    string sourceFileName = args[argc - 1];
+
+    BackendMode mode = EXECUTOR;
+    bool modeSet = false;
+    bool watch = false;
+    ConverterOptions options;
+    CrossReferenceOptions xref;
+    bool timing = false;
+    bool check = true;
+
+    for (int i = 1; i < argc - 1; i++)
+    {
+        string option = toLowerCase(args[i]);
+
+        if (option == "-watch")
+        {
+            watch = true;
+            continue;
+        }
+        if (option == "-parallel")
+        {
+            options.parallel = true;
+            continue;
+        }
+        if (option == "-vectorize")
+        {
+            options.vectorize = true;
+            continue;
+        }
+        if (option == "-instrument")
+        {
+            options.instrument = true;
+            continue;
+        }
+        if (option == "-xref")
+        {
+            xref.table = true;
+            continue;
+        }
+        if (option == "-xref-json")
+        {
+            xref.json = true;
+            continue;
+        }
+        if (option == "-timing")
+        {
+            timing = true;
+            continue;
+        }
+        if (option == "-nocheck")
+        {
+            check = false;
+            continue;
+        }
+
+        if      (option == "-convert") mode = CONVERTER;
+        else if (option == "-debug")   mode = DEBUGGER;
+        else if (option == "-execute") mode = EXECUTOR;
+        else if (option == "-compile") mode = COMPILER;
+        else
+        {
+            cout << "ERROR: Invalid option \"" << args[i] << "\"." << endl;
+            cout << "   Valid options: -execute, -debug, -convert, or -compile"
+                 << ", and -watch, -parallel, -vectorize, -instrument,"
+                 << " -xref, -xref-json, -timing, or -nocheck" << endl;
+            return -2;
+        }
+
+        if (modeSet)
+        {
+            cout << "ERROR: More than one of -execute, -debug, -convert, "
+                 << "or -compile." << endl;
+            return -2;
+        }
+
+        modeSet = true;
+    }
+
+    if (!check && (mode == DEBUGGER))
+    {
+        cout << "ERROR: -nocheck can't be used with -debug,"
+             << " which always checks ranges." << endl;
+        return -2;
+    }
+
+    ResidentProgram program(mode, sourceFileName);
+
+    if (!watch)
+    {
+        return translate(mode, program, false, options, xref, timing, check);
+    }
+
+    // Stay resident and translate the file again after every change.
+    // The parse tree and symbol tables stay between runs, so an edit
+    // within one routine only parses and checks that routine again,
+    // and those that call it if its heading changed. Pass 3 always runs
+    // in a child process, which leaves them as they were.
+    SourceWatcher watcher(sourceFileName);
+
+    while (true)
+    {
+        translate(mode, program, true, options, xref, timing, check);
+
+        cout << endl << "Watching \"" << sourceFileName
+             << "\" for changes. Press Ctrl-C to stop." << endl;
+        watcher.waitForChange();
+
+        cout << endl << "===== \"" << sourceFileName << "\" CHANGED ====="
+             << endl << endl;
+    }
+}
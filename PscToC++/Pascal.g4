@@ -8,13 +8,28 @@ grammar Pascal;
     using namespace intermediate::type;
 }
 
-program           : programHeader block '.' ;
+compilationUnit   : program | unit ;
+
+program           : programHeader usesPart? block '.' ;
 programHeader     : PROGRAM programIdentifier programParameters? ';' ; 
 programParameters : '(' IDENTIFIER ( ',' IDENTIFIER )* ')' ;
 
 programIdentifier   locals [ SymtabEntry *entry = nullptr ]
     : IDENTIFIER ;
 
+unit               : unitHeader interfacePart implementationPart END '.' ;
+unitHeader         : UNIT unitIdentifier ';' ;
+interfacePart      : INTERFACE usesPart? ( constantsPart ';' )? 
+                     ( typesPart ';' )? ( variablesPart ';' )?
+                     ( routineHeadsPart ';' )? ;
+implementationPart : IMPLEMENTATION declarations ;
+
+unitIdentifier      locals [ SymtabEntry *entry = nullptr ]
+    : IDENTIFIER ;
+
+usesPart : USES unitName ( ',' unitName )* ';' ;
+unitName : IDENTIFIER ;
+
 block         : declarations compoundStatement ;
 declarations  : ( constantsPart ';' )? ( typesPart ';' )? 
                 ( variablesPart ';' )? ( routinesPart ';')? ;
@@ -75,6 +90,8 @@ variableIdentifier  locals [ Typespec *type = nullptr, SymtabEntry *entry = null
 
 routinesPart      : routineDefinition ( ';' routineDefinition)* ;
 routineDefinition : ( procedureHead | functionHead ) ';' block ;
+routineHeadsPart  : routineHead ( ';' routineHead )* ;
+routineHead       : procedureHead | functionHead ;
 procedureHead     : PROCEDURE routineIdentifier parameters? ;
 functionHead      : FUNCTION  routineIdentifier parameters? ':' typeIdentifier ;
 
@@ -89,7 +106,9 @@ parameterIdentifierList   : parameterIdentifier ( ',' parameterIdentifier )* ;
 parameterIdentifier   locals [ Typespec *type = nullptr, SymtabEntry *entry = nullptr ]
     : IDENTIFIER ;
 
-statement : compoundStatement
+statement
+        locals [ int debugFlags = 0 ]  // debugger breakpoint flags
+          : compoundStatement
           | assignmentStatement
           | ifStatement
           | caseStatement
@@ -227,6 +246,10 @@ fragment Y : ('y' | 'Y') ;
 fragment Z : ('z' | 'Z') ;
 
 PROGRAM   : P R O G R A M ;
+UNIT      : U N I T ;
+INTERFACE : I N T E R F A C E ;
+IMPLEMENTATION : I M P L E M E N T A T I O N ;
+USES      : U S E S ;
 CONST     : C O N S T ;
 TYPE      : T Y P E ;
 ARRAY     : A R R A Y ;
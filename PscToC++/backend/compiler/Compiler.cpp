@@ -0,0 +1,230 @@
+/**
+ * <h1>Compiler</h1>
+ *
+ * <p>Convert a Pascal program to C++ and build a native executable,
+ * caching the builds.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "antlr4-runtime.h"
+
+#include "backend/converter/Converter.h"
+#include "Compiler.h"
+
+namespace backend { namespace compiler {
+
+using namespace std;
+using namespace std::chrono;
+using namespace backend::converter;
+
+bool Compiler::compile(tree::ParseTree *tree)
+{
+    // Convert to C++.
+    auto start = steady_clock::now();
+    Converter converter(options);
+    converter.visit(tree);
+    auto converted = steady_clock::now();
+
+    string cppFileName = converter.getObjectFileName();
+    bool unit = converter.isUnit();
+    executableFileName = cppFileName.substr(0, cppFileName.rfind('.'));
+    if (unit) executableFileName += ".o";
+
+    long elapsed = (long) duration_cast<microseconds>(converted - start).count();
+    int lines = converter.getLineCount();
+
+    printf("Converted %d lines to \"%s\" in %ld milliseconds "
+           "(%.0f lines per second).\n", lines, cppFileName.c_str(),
+           elapsed/1000, lines/(max(elapsed, 1L)/1.0e6));
+
+    // Look for a cached build.
+    string compiler = hostCompiler();
+    string directory = cacheDirectory();
+    string cachedFileName = directory.empty() ? ""
+                                : directory + "/" + cacheKey(compiler, unit);
+    struct stat status;
+
+    if (   !cachedFileName.empty()
+        && (stat(cachedFileName.c_str(), &status) == 0)
+        && copyExecutable(cachedFileName, executableFileName))
+    {
+        auto copied = steady_clock::now();
+        printf("Copied the cached build of \"%s\" in %ld milliseconds.\n",
+               executableFileName.c_str(),
+               (long) duration_cast<milliseconds>(copied - converted).count());
+        return true;
+    }
+
+    // Build, then cache the executable. The build goes to a
+    // temporary file that is renamed so no one sees a partial build.
+    if (!build(compiler, cppFileName, executableFileName, unit))
+    {
+        cout << "ERROR: Native build of \"" << cppFileName << "\" failed."
+             << endl;
+        return false;
+    }
+
+    auto built = steady_clock::now();
+    printf("Built \"%s\" in %ld milliseconds.\n", executableFileName.c_str(),
+           (long) duration_cast<milliseconds>(built - converted).count());
+
+    if (!cachedFileName.empty())
+    {
+        string temporaryFileName =
+                cachedFileName + "." + to_string((long) getpid());
+
+        if (   !copyExecutable(executableFileName, temporaryFileName)
+            || (rename(temporaryFileName.c_str(), cachedFileName.c_str()) < 0))
+        {
+            unlink(temporaryFileName.c_str());
+        }
+    }
+
+    return true;
+}
+
+string Compiler::hostCompiler()
+{
+    const char *cxx = getenv("CXX");
+    return (cxx != nullptr) && (*cxx != '\0') ? cxx : "c++";
+}
+
+string Compiler::cacheKey(const string& compiler, bool unit) const
+{
+    // 64-bit FNV-1a.
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash] (const char *bytes, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= (unsigned char) bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    // Separate the parts with a null byte.
+    add(source.getText(), source.getLength());
+    add("", 1);
+    add(CONVERTER_VERSION, string(CONVERTER_VERSION).length() + 1);
+    add(options.instrument ? "instrument" : "", options.instrument ? 11 : 1);
+    add(compiler.c_str(), compiler.length() + 1);
+    for (const string& flag : flags) add(flag.c_str(), flag.length() + 1);
+    add(unit ? "unit" : "", unit ? 5 : 1);
+
+    // A program must be linked again whenever one of its units changes.
+    for (const string& unitName : units)
+    {
+        ifstream in(objectFileName(unitName), ios::binary);
+        string contents((istreambuf_iterator<char>(in)),
+                        istreambuf_iterator<char>());
+
+        add(unitName.c_str(), unitName.length() + 1);
+        add(contents.data(), contents.length());
+    }
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+    return key;
+}
+
+string Compiler::cacheDirectory()
+{
+    string directory;
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home  = getenv("HOME");
+
+    if      ((cache != nullptr) && (*cache != '\0')) directory = cache;
+    else if ((home  != nullptr) && (*home  != '\0')) directory = string(home)
+                                                                + "/.cache";
+    else return "";
+
+    directory += "/pascalcpp";
+
+    // Create each missing directory along the path.
+    for (size_t i = 1; i <= directory.length(); i++)
+    {
+        if ((i == directory.length()) || (directory[i] == '/'))
+        {
+            string path = directory.substr(0, i);
+
+            if ((mkdir(path.c_str(), 0755) < 0) && (errno != EEXIST))
+            {
+                return "";
+            }
+        }
+    }
+
+    return directory;
+}
+
+bool Compiler::build(const string& compiler, const string& cppFileName,
+                     const string& outputFileName, bool unit) const
+{
+    vector<string> command = { compiler };
+    command.insert(command.end(), flags.begin(), flags.end());
+    if (unit) command.push_back("-c");
+    command.insert(command.end(), { "-o", outputFileName, cppFileName });
+    if (!unit)
+    {
+        for (const string& unitName : units)
+        {
+            command.push_back(objectFileName(unitName));
+        }
+    }
+
+    vector<char *> argv;
+    for (string& arg : command) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+
+    cout.flush();
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid < 0) return false;
+
+    if (pid == 0)
+    {
+        execvp(argv[0], argv.data());
+        cout << "ERROR: Can't run the C++ compiler \"" << compiler << "\"."
+             << endl;
+        _exit(127);
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR) return false;
+    }
+
+    return WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+bool Compiler::copyExecutable(const string& from, const string& to)
+{
+    ifstream in(from, ios::binary);
+    ofstream out(to, ios::binary | ios::trunc);
+
+    if (!in.is_open() || !out.is_open()) return false;
+
+    out << in.rdbuf();
+    out.close();
+
+    return !out.fail() && (chmod(to.c_str(), 0755) == 0);
+}
+
+}}  // namespace backend::compiler
@@ -0,0 +1,134 @@
+/**
+ * <h1>Compiler</h1>
+ *
+ * <p>Convert a Pascal program to C++ and build a native executable,
+ * caching the builds.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef COMPILER_H_
+#define COMPILER_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "antlr4-runtime.h"
+
+#include "frontend/SourceBuffer.h"
+#include "backend/converter/Converter.h"
+
+namespace backend { namespace compiler {
+
+using namespace std;
+using namespace antlr4;
+using namespace frontend;
+using namespace backend::converter;
+
+/**
+ * The compiler runs the converter and then the host C++ compiler.
+ * Builds are cached in $XDG_CACHE_HOME/pascalcpp, or else in
+ * ~/.cache/pascalcpp, by a hash of the Pascal source, the converter
+ * version, and the host compiler and its flags, which together with
+ * -instrument cover the options for the converted code. A repeated build of
+ * an unchanged program copies the cached executable. A unit is compiled
+ * to an object file that the programs which use it link, and the key of
+ * such a program includes the object files of its units.
+ */
+class Compiler
+{
+private:
+    const SourceBuffer& source;  // the Pascal source
+    ConverterOptions options;    // options for the converted code
+    vector<string> flags;        // host compiler flags
+    vector<string> units;        // units to link, each after those it uses
+    string executableFileName;
+
+public:
+    /**
+     * Constructor.
+     * @param source the Pascal source.
+     * @param options the options for the converted code.
+     */
+    Compiler(const SourceBuffer& source, const ConverterOptions& options)
+        : source(source), options(options), flags({ "-O2", "-std=c++11" })
+    {
+        if (options.parallel)  flags.push_back("-fopenmp");
+        if (options.vectorize) flags.push_back("-ftree-vectorize");
+    }
+
+    /**
+     * Getter.
+     * @return the name of the native executable, or of the object
+     * file of a unit.
+     */
+    string getExecutableFileName() const { return executableFileName; }
+
+    /**
+     * Setter.
+     * @param units the names of the units that the program uses,
+     * whose object files it links.
+     */
+    void setUnits(const vector<string>& units) { this->units = units; }
+
+    /**
+     * Convert the program, then build it or copy its cached build.
+     * @param tree the program's parse tree.
+     * @return true if the executable was created.
+     */
+    bool compile(tree::ParseTree *tree);
+
+private:
+    /**
+     * Get the host C++ compiler: $CXX, or else c++.
+     * @return the compiler command.
+     */
+    static string hostCompiler();
+
+    /**
+     * Compute the cache key of the build.
+     * @param compiler the host compiler command.
+     * @param unit true if building the object file of a unit.
+     * @return the key as 16 hexadecimal digits.
+     */
+    string cacheKey(const string& compiler, bool unit) const;
+
+    /**
+     * Get the cache directory, creating it if necessary.
+     * @return the directory name, or "" if it can't be created.
+     */
+    static string cacheDirectory();
+
+    /**
+     * Run the host compiler.
+     * @param compiler the host compiler command.
+     * @param cppFileName the name of the C++ source file.
+     * @param outputFileName the name of the executable to create.
+     * @param unit true to compile the object file of a unit.
+     * @return true if the build succeeded.
+     */
+    bool build(const string& compiler, const string& cppFileName,
+               const string& outputFileName, bool unit) const;
+
+    /**
+     * Get the name of the object file of a unit.
+     * @param unitName the name of the unit.
+     * @return the file name.
+     */
+    static string objectFileName(const string& unitName)
+    {
+        return toLowerCase(unitName) + ".o";
+    }
+
+    /**
+     * Copy an executable file.
+     * @param from the name of the file to copy.
+     * @param to the name of the copy.
+     * @return true if successful.
+     */
+    static bool copyExecutable(const string& from, const string& to);
+};
+
+}}  // namespace backend::compiler
+
+#endif /* COMPILER_H_ */
@@ -1,20 +1,36 @@
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
 #include "CodeGenerator.h"
 
 namespace backend { namespace converter {
 
 CodeGenerator::CodeGenerator()
-    : length(0), position(0), indentation(""), needLF(false)
+    : objectFile(-1), used(CHUNK_SIZE), lineCount(0),
+      length(0), position(0), indentation(""), needLF(false)
 {
     blanks = "";
     for (int i = 0; i < 8; i++) blanks += "          ";
 }
 
+CodeGenerator::~CodeGenerator()
+{
+    if (objectFile >= 0) ::close(objectFile);
+}
+
 void CodeGenerator::open(string programName, string suffix)
 {
     objectFileName = programName + "." + suffix;
-    objectFile.open(objectFileName);
+    objectFile = ::open(objectFileName.c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
-    if (!objectFile.is_open())
+    if (objectFile < 0)
     {
         cout << "ERROR: Failed to open object file \""
              << objectFileName << "\"." << endl;
@@ -22,21 +38,91 @@ void CodeGenerator::open(string programName, string suffix)
     }
 }
 
+void CodeGenerator::close()
+{
+    if (objectFile < 0) return;
+
+    vector<struct iovec> pieces;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        size_t size = (i == chunks.size() - 1) ? used : CHUNK_SIZE;
+        pieces.push_back({ chunks[i].get(), size });
+    }
+
+    // Write as many chunks at a time as the system allows.
+    size_t next = 0;
+    while (next < pieces.size())
+    {
+        int count = (int) min(pieces.size() - next, (size_t) IOV_MAX);
+        ssize_t written = writev(objectFile, &pieces[next], count);
+
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+
+            cout << "ERROR: Failed to write object file \""
+                 << objectFileName << "\"." << endl;
+            exit(-1);
+        }
+
+        // Skip the chunks written, then what was written of the next one.
+        while (   (next < pieces.size())
+               && ((size_t) written >= pieces[next].iov_len))
+        {
+            written -= pieces[next].iov_len;
+            next++;
+        }
+        if (written > 0)
+        {
+            pieces[next].iov_base = (char *) pieces[next].iov_base + written;
+            pieces[next].iov_len -= written;
+        }
+    }
+
+    ::close(objectFile);
+    objectFile = -1;
+    chunks.clear();
+    used = CHUNK_SIZE;
+}
+
+void CodeGenerator::append(const char *text, size_t size)
+{
+    while (size > 0)
+    {
+        if (used == CHUNK_SIZE)
+        {
+            chunks.emplace_back(new char[CHUNK_SIZE]);
+            used = 0;
+        }
+
+        size_t count = min(size, CHUNK_SIZE - used);
+        memcpy(chunks.back().get() + used, text, count);
+
+        used += count;
+        text += count;
+        size -= count;
+    }
+}
+
+void CodeGenerator::newline()
+{
+    append("\n", 1);
+    lineCount++;
+}
+
 void CodeGenerator::lfIfNeeded()
 {
     if (needLF)
     {
-        objectFile << endl;
-        objectFile.flush();
+        newline();
         length = 0;
         needLF = false;
     }
 }
 
-void CodeGenerator::emit(const string code)
+void CodeGenerator::emit(const string& code)
 {
-    objectFile << code;
-    objectFile.flush();
+    append(code);
     length += code.length();
     needLF = true;
 }
@@ -48,46 +134,48 @@ void CodeGenerator::emitStart()
     position = 0;
 }
 
-void CodeGenerator::emitStart(const string code)
+void CodeGenerator::emitStart(const string& code)
 {
     lfIfNeeded();
-    emit(indentation + code);
+    append(indentation);
+    emit(code);
+    length += indentation.length();
     position = 0;
 }
 
 void CodeGenerator::emitLine()
 {
     lfIfNeeded();
-    objectFile << endl;
-    objectFile.flush();
+    newline();
 
     length = 0;
     position = 0;
     needLF = false;
 }
 
-void CodeGenerator::emitLine(const string code)
+void CodeGenerator::emitLine(const string& code)
 {
     lfIfNeeded();
-    objectFile << indentation << code << endl;
-    objectFile.flush();
+    append(indentation);
+    append(code);
+    newline();
 
     length = 0;
     position = 0;
     needLF = false;
 }
 
-void CodeGenerator::emitEnd(const string code)
+void CodeGenerator::emitEnd(const string& code)
 {
-    objectFile << code << endl;
-    objectFile.flush();
+    append(code);
+    newline();
 
     length = 0;
     position = 0;
     needLF = false;
 }
 
-void CodeGenerator::emitCommentLine(const string text)
+void CodeGenerator::emitCommentLine(const string& text)
 {
     emitLine(indentation + "// " + text);
     needLF = false;
@@ -100,7 +188,8 @@ void CodeGenerator::indent()
 
 void CodeGenerator::dedent()
 {
-    indentation = indentation.substr(0, indentation.length()-4);
+    indentation.resize(indentation.length() >= 4 ? indentation.length() - 4
+                                                 : 0);
 }
 
 void CodeGenerator::mark()
@@ -112,9 +201,8 @@ void CodeGenerator::split(const int limit)
 {
     if (length > limit)
     {
-        objectFile << endl;
-        objectFile << blanks.substr(0, position);
-        objectFile.flush();
+        newline();
+        append(blanks.data(), min((size_t) position, blanks.length()));
 
         length = position;
         position = 0;
@@ -2,20 +2,32 @@
 #define CONVERTER_CODEGENERATOR_H_
 
 #include <iostream>
-#include <fstream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <memory>
 
 namespace backend { namespace converter {
 
 using namespace std;
 
+/**
+ * The generated code accumulates in memory, in a list of fixed-size
+ * chunks that never move once allocated, and the object file is
+ * written all at once when it's closed.
+ */
 class CodeGenerator
 {
 private:
-    ofstream objectFile;
+    static const size_t CHUNK_SIZE = 64*1024;
+
+    int objectFile;      // the object file descriptor, or -1
     string objectFileName;
 
+    vector<unique_ptr<char[]>> chunks;  // the generated code
+    size_t used;         // bytes used in the last chunk
+    int lineCount;       // number of code lines
+
     int length;          // length of the code line
     int position;        // position in the code line
     string indentation;  // indentation of the code line
@@ -31,7 +43,7 @@ public:
     /**
      * Destructor.
      */
-    virtual ~CodeGenerator() {}
+    virtual ~CodeGenerator();
 
     /**
      * Get the name of the object (Java) file.
@@ -39,6 +51,12 @@ public:
      */
     string getObjectFileName() const { return objectFileName; }
 
+    /**
+     * Get the number of code lines generated.
+     * @return the count.
+     */
+    int getLineCount() const { return lineCount; }
+
     /**
      * Open the object file.
      * @param programName the name of the program.
@@ -47,9 +65,9 @@ public:
     void open(string programName, string suffix);
 
     /**
-     * Close the object file.
+     * Write the generated code to the object file and close it.
      */
-    void close() { objectFile.close(); }
+    void close();
 
     /**
      * Emit a line feed if needed.
@@ -60,7 +78,7 @@ public:
      * Emit some code.
      * @param code the code to emit.
      */
-    void emit(const string code);
+    void emit(const string& code);
 
     /**
      * Emit the start of a new line of code with indentation.
@@ -71,7 +89,7 @@ public:
      * Emit the start of a new line with indentation and some code.
      * @param code the code to emit.
      */
-    void emitStart(const string code);
+    void emitStart(const string& code);
 
     /**
      * Emit a blank code line.
@@ -82,19 +100,19 @@ public:
      * Emit a complete line of code with indentation.
      * @param code the code to emit.
      */
-    void emitLine(const string code);
+    void emitLine(const string& code);
 
     /**
      * Emit some code to end a line.
      * @param code the code to emit.
      */
-    void emitEnd(const string code);
+    void emitEnd(const string& code);
 
     /**
      * Emit a comment line with indentation.
      * @param text the comment text.
      */
-    void emitCommentLine(const string text);
+    void emitCommentLine(const string& text);
 
     /**
      * Increase the indentation.
@@ -118,6 +136,25 @@ public:
      * @param limit the limit.
      */
     void split(const int limit);
+
+private:
+    /**
+     * Append text to the generated code.
+     * @param text the text.
+     * @param size its length.
+     */
+    void append(const char *text, size_t size);
+
+    /**
+     * Append a string to the generated code.
+     * @param text the string.
+     */
+    void append(const string& text) { append(text.data(), text.length()); }
+
+    /**
+     * Append a line feed to the generated code.
+     */
+    void newline();
 };
 
 }} // namespace backend::converter
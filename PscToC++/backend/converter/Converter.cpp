@@ -6,6 +6,8 @@
 #include "intermediate/symtab/SymtabEntry.h"
 #include "intermediate/type/Typespec.h"
 #include "Converter.h"
+#include "LoopAnalyzer.h"
+#include "Runtime.h"
 
 namespace backend { namespace converter {
 
@@ -13,6 +15,12 @@ Object Converter::visitProgram(PascalParser::ProgramContext *ctx)
 {
     visit(ctx->programHeader());
 
+    if (ctx->usesPart() != nullptr)
+    {
+        emitUnitIncludes(ctx->usesPart());
+        code.emitLine();
+    }
+
     // Level 1 declarations.
     visit(ctx->block()->declarations());
 
@@ -24,6 +32,7 @@ Object Converter::visitProgram(PascalParser::ProgramContext *ctx)
 
     // Execution timer.
     code.emitLine("auto _start = steady_clock::now();");
+    if (options.instrument) code.emitLine("atexit(_printProfile);");
     code.emitLine();
 
     // Main compound statement.
@@ -31,6 +40,7 @@ Object Converter::visitProgram(PascalParser::ProgramContext *ctx)
 
     // Print the execution time.
     code.emitLine();
+    code.emitLine("_out.flush();");
     code.emitLine("auto _end = steady_clock::now();");
     code.emitStart("long _elapsed = duration_cast<milliseconds>");
     code.emitEnd("(_end - _start).count();");
@@ -49,6 +59,123 @@ Object Converter::visitProgramHeader(PascalParser::ProgramHeaderContext *ctx)
     string programName = ctx->programIdentifier()->IDENTIFIER()->getText();
     code.open(programName, "cpp");
 
+    emitRuntime();
+    if (options.instrument) emitProfiler();
+
+    return nullptr;
+}
+
+Object Converter::visitUnit(PascalParser::UnitContext *ctx)
+{
+    PascalParser::InterfacePartContext *interfaceCtx = ctx->interfacePart();
+    string unitName = toLowerCase(
+                ctx->unitHeader()->unitIdentifier()->IDENTIFIER()->getText());
+    string guard = toUpperCase(unitName) + "_H_";
+
+    unit = true;
+
+    // The profiler belongs to the program that uses the unit.
+    options.instrument = false;
+
+    // The variables and routines that the interface declares.
+    if (interfaceCtx->variablesPart() != nullptr)
+    {
+        for (PascalParser::VariableDeclarationsContext *dclCtx :
+                            interfaceCtx->variablesPart()
+                                ->variableDeclarationsList()
+                                    ->variableDeclarations())
+        {
+            for (PascalParser::VariableIdentifierContext *varCtx :
+                        dclCtx->variableIdentifierList()->variableIdentifier())
+            {
+                exports.insert(varCtx->entry);
+            }
+        }
+    }
+    if (interfaceCtx->routineHeadsPart() != nullptr)
+    {
+        for (PascalParser::RoutineHeadContext *headCtx :
+                                interfaceCtx->routineHeadsPart()->routineHead())
+        {
+            exports.insert(headCtx->functionHead() != nullptr
+                    ? headCtx->functionHead()->routineIdentifier()->entry
+                    : headCtx->procedureHead()->routineIdentifier()->entry);
+        }
+    }
+
+    // The header: the interface's declarations.
+    code.open(unitName, "h");
+    code.emitLine("#ifndef " + guard);
+    code.emitLine("#define " + guard);
+    code.emitLine();
+    code.emitLine("#include <string>");
+    emitUnitIncludes(interfaceCtx->usesPart());
+    code.emitLine();
+    code.emitLine("using namespace std;");
+    code.emitLine();
+
+    declaring = true;
+    if (interfaceCtx->constantsPart() != nullptr)
+    {
+        visit(interfaceCtx->constantsPart());
+    }
+    if (interfaceCtx->typesPart() != nullptr)
+    {
+        visit(interfaceCtx->typesPart());
+    }
+    if (interfaceCtx->variablesPart() != nullptr)
+    {
+        visit(interfaceCtx->variablesPart());
+    }
+    if (interfaceCtx->routineHeadsPart() != nullptr)
+    {
+        visit(interfaceCtx->routineHeadsPart());
+    }
+    declaring = false;
+
+    code.emitLine();
+    code.emitLine("#endif /* " + guard + " */");
+    code.close();
+
+    // The source: the interface's variables and the implementation.
+    // The unit shares the program's I/O runtime variables.
+    code.open(unitName, "cpp");
+    code.emitLine("#define _PASCAL_RUNTIME_STORAGE extern");
+    emitRuntime();
+    code.emitLine("#include \"" + unitName + ".h\"");
+    code.emitLine();
+
+    if (interfaceCtx->variablesPart() != nullptr)
+    {
+        visit(interfaceCtx->variablesPart());
+    }
+    visit(ctx->implementationPart()->declarations());
+
+    code.close();
+    return nullptr;
+}
+
+void Converter::emitUnitIncludes(PascalParser::UsesPartContext *ctx)
+{
+    if (ctx == nullptr) return;
+
+    for (PascalParser::UnitNameContext *nameCtx : ctx->unitName())
+    {
+        code.emitLine("#include \"" + toLowerCase(nameCtx->getText())
+                                      + ".h\"");
+    }
+}
+
+string Converter::storageClass(SymtabEntry *id)
+{
+    if (!unit || (id->getSymtab()->getNestingLevel() != 1)) return "";
+    if (exports.find(id) == exports.end()) return "static ";
+
+    return declaring ? "extern " : "";
+}
+
+void Converter::emitRuntime()
+{
     code.emitLine("#include <iostream>");
     code.emitLine("#include <iomanip>");
     code.emitLine("#include <chrono>");
@@ -58,7 +185,101 @@ Object Converter::visitProgramHeader(PascalParser::ProgramHeaderContext *ctx)
     code.emitLine("using namespace std::chrono;");
     code.emitLine();
 
-    return nullptr;
+    // The I/O runtime.
+    string runtime = IO_RUNTIME;
+    for (size_t start = 0, end; start < runtime.length(); start = end + 1)
+    {
+        end = runtime.find('\n', start);
+        if (end == string::npos) end = runtime.length();
+
+        if (end == start) code.emitLine();
+        else              code.emitLine(runtime.substr(start, end - start));
+    }
+    code.emitLine();
+}
+
+void Converter::emitProfiler()
+{
+    static const char *lines[] =
+    {
+        "#include <cstdio>",
+        "#include <cstdlib>",
+        "#include <vector>",
+        "#include <algorithm>",
+        "",
+        "// The call count and time of a routine. The time of a recursive",
+        "// routine runs from its outermost call to that call's return.",
+        "struct _Profile",
+        "{",
+        "    const char *name;",
+        "    long calls;",
+        "    long active;",
+        "    steady_clock::duration time;",
+        "",
+        "    static vector<_Profile *>& profiles()",
+        "    {",
+        "        static vector<_Profile *> all;",
+        "        return all;",
+        "    }",
+        "",
+        "    _Profile(const char *name)",
+        "        : name(name), calls(0), active(0), time(0)",
+        "    {",
+        "        profiles().push_back(this);",
+        "    }",
+        "};",
+        "",
+        "// Time a routine call for the lifetime of the timer.",
+        "struct _Timer",
+        "{",
+        "    _Profile& profile;",
+        "    steady_clock::time_point start;",
+        "",
+        "    _Timer(_Profile& profile) : profile(profile)",
+        "    {",
+        "        profile.calls++;",
+        "        if (profile.active++ == 0) start = steady_clock::now();",
+        "    }",
+        "",
+        "    ~_Timer()",
+        "    {",
+        "        if (--profile.active == 0)",
+        "        {",
+        "            profile.time += steady_clock::now() - start;",
+        "        }",
+        "    }",
+        "};",
+        "",
+        "static steady_clock::time_point _programStart = steady_clock::now();",
+        "",
+        "// Print the profiles, the most time first.",
+        "static void _printProfile()",
+        "{",
+        "    vector<_Profile *> profiles = _Profile::profiles();",
+        "    sort(profiles.begin(), profiles.end(),",
+        "         [] (_Profile *a, _Profile *b) { return a->time > b->time; });",
+        "",
+        "    double total = duration<double, milli>(steady_clock::now()",
+        "                                           - _programStart).count();",
+        "",
+        "    fprintf(stderr, \"\\n%-24s %12s %14s %14s %7s\\n\",",
+        "            \"Routine\", \"Calls\", \"Total ms\", \"Per call us\", \"%\");",
+        "    for (_Profile *profile : profiles)",
+        "    {",
+        "        double ms = duration<double, milli>(profile->time).count();",
+        "        fprintf(stderr, \"%-24s %12ld %14.3f %14.3f %6.1f%%\\n\",",
+        "                profile->name, profile->calls, ms,",
+        "                profile->calls > 0 ? 1000*ms/profile->calls : 0.0,",
+        "                total > 0 ? 100*ms/total : 0.0);",
+        "    }",
+        "}",
+    };
+
+    for (const char *line : lines)
+    {
+        if (*line == '\0') code.emitLine();
+        else                code.emitLine(line);
+    }
 }
 
 Object Converter::visitConstantDefinition(
@@ -188,7 +409,7 @@ Object Converter::visitVariableDeclarations(
     for (PascalParser::VariableIdentifierContext *varCtx :
                                                 listCtx->variableIdentifier())
     {
-        code.emitStart();
+        code.emitStart(storageClass(varCtx->entry));
         code.emit(typeName(typeCtx->type));
 
         code.emit(" " + varCtx->entry->getName());
@@ -281,17 +502,27 @@ Object Converter::visitRoutineDefinition(
 
     programVariables = false;
     code.emitLine();
-    code.emitStart();
+
+    if (options.instrument)
+    {
+        string name = (functionDefinition ? funcCtx->routineIdentifier()
+                                          : procCtx->routineIdentifier())
+                                                        ->entry->getName();
+        code.emitLine("static _Profile _" + name + "Profile(\"" + name
+                                                                + "\");");
+    }
+
+    idCtx = functionDefinition ? funcCtx->routineIdentifier()
+                               : procCtx->routineIdentifier();
+    code.emitStart(storageClass(idCtx->entry));
 
     if (functionDefinition)
     {
-        idCtx = funcCtx->routineIdentifier();
         parmsCtx = funcCtx->parameters();
         visit(funcCtx->typeIdentifier());
     }
     else
     {
-        idCtx = procCtx->routineIdentifier();
         parmsCtx = procCtx->parameters();
         code.emit("void");
     }
@@ -305,6 +536,11 @@ Object Converter::visitRoutineDefinition(
     code.emitLine("{");
     code.indent();
 
+    if (options.instrument)
+    {
+        code.emitLine("_Timer _timer(_" + routineName + "Profile);");
+    }
+
     if (functionDefinition)
     {
         // Function associated variable.
@@ -330,6 +566,36 @@ Object Converter::visitRoutineDefinition(
     return nullptr;
 }
 
+Object Converter::visitRoutineHead(PascalParser::RoutineHeadContext *ctx)
+{
+    PascalParser::FunctionHeadContext  *funcCtx = ctx->functionHead();
+    PascalParser::ProcedureHeadContext *procCtx = ctx->procedureHead();
+    PascalParser::RoutineIdentifierContext *idCtx = nullptr;
+    PascalParser::ParametersContext *parmsCtx = nullptr;
+
+    // The prototype of a routine that a unit's interface declares.
+    code.emitStart();
+
+    if (funcCtx != nullptr)
+    {
+        idCtx = funcCtx->routineIdentifier();
+        parmsCtx = funcCtx->parameters();
+        visit(funcCtx->typeIdentifier());
+    }
+    else
+    {
+        idCtx = procCtx->routineIdentifier();
+        parmsCtx = procCtx->parameters();
+        code.emit("void");
+    }
+
+    code.emit(" " + idCtx->entry->getName() + "(");
+    if (parmsCtx != nullptr) visit(parmsCtx);
+    code.emitEnd(");");
+
+    return nullptr;
+}
+
 Object Converter::visitParameters(PascalParser::ParametersContext *ctx)
 {
     currentSeparator = "";
@@ -340,6 +606,292 @@ Object Converter::visitParameters(PascalParser::ParametersContext *ctx)
     return nullptr;
 }
 
+/**
+ * Whether a parse tree refers to a variable.
+ * @param node the root of the parse tree.
+ * @param id the variable's entry.
+ * @return true if so.
+ */
+static bool refersTo(tree::ParseTree *node, SymtabEntry *id)
+{
+    if (auto *varCtx = dynamic_cast<PascalParser::VariableContext *>(node))
+    {
+        if (varCtx->variableIdentifier()->entry == id) return true;
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        if (refersTo(child, id)) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Whether a parse tree can modify a variable: by assigning to it or to
+ * one of its elements or fields, by reading into it, by using it as a
+ * FOR loop variable, or by passing any part of it by reference.
+ * @param node the root of the parse tree.
+ * @param id the variable's entry.
+ * @return true if so.
+ */
+static bool modifies(tree::ParseTree *node, SymtabEntry *id)
+{
+    PascalParser::ArgumentListContext *argListCtx = nullptr;
+    SymtabEntry *routineId = nullptr;
+
+    if (auto *lhsCtx = dynamic_cast<PascalParser::LhsContext *>(node))
+    {
+        if (lhsCtx->variable()->variableIdentifier()->entry == id) return true;
+    }
+    else if (auto *readCtx =
+                    dynamic_cast<PascalParser::ReadArgumentsContext *>(node))
+    {
+        if (refersTo(readCtx, id)) return true;
+    }
+    else if (auto *forCtx =
+                    dynamic_cast<PascalParser::ForStatementContext *>(node))
+    {
+        if (refersTo(forCtx->variable(), id)) return true;
+    }
+    else if (auto *callCtx =
+            dynamic_cast<PascalParser::ProcedureCallStatementContext *>(node))
+    {
+        argListCtx = callCtx->argumentList();
+        routineId  = callCtx->procedureName()->entry;
+    }
+    else if (auto *callCtx =
+                    dynamic_cast<PascalParser::FunctionCallContext *>(node))
+    {
+        argListCtx = callCtx->argumentList();
+        routineId  = callCtx->functionName()->entry;
+    }
+
+    if ((argListCtx != nullptr) && (routineId != nullptr))
+    {
+        vector<SymtabEntry *> *parms = routineId->getRoutineParameters();
+        vector<PascalParser::ArgumentContext *> args = argListCtx->argument();
+
+        for (int i = 0; (parms != nullptr) && (i < (int) parms->size())
+                                           && (i < (int) args.size()); i++)
+        {
+            if (   ((*parms)[i]->getKind() == REFERENCE_PARAMETER)
+                && refersTo(args[i], id))
+            {
+                return true;
+            }
+        }
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        if (modifies(child, id)) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Whether a variable of one type can contain a variable of another,
+ * as itself or as one of its elements or fields.
+ * @param outer the type of the containing variable.
+ * @param inner the type of the contained variable.
+ * @return true if so.
+ */
+static bool contains(Typespec *outer, Typespec *inner)
+{
+    outer = outer->baseType();
+    inner = inner->baseType();
+
+    if (outer == inner) return true;
+
+    if (outer->getForm() == ARRAY)
+    {
+        return contains(outer->getArrayElementType(), inner);
+    }
+
+    if (outer->getForm() == RECORD)
+    {
+        for (SymtabEntry *fieldId : outer->getRecordSymtab()->entries())
+        {
+            if (contains(fieldId->getType(), inner)) return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * What a routine that receives a value parameter by const reference
+ * must not write, since the parameter is an alias of its argument.
+ */
+struct AliasCheck
+{
+    Typespec *type;         // the parameter's type
+    SymtabEntry *routineId; // the parameter's routine
+    set<Symtab *> fresh;    // scopes of the routine and the routines in it
+    set<SymtabEntry *> visited;  // routines checked or being checked
+    map<SymtabEntry *, PascalParser::RoutineDefinitionContext *>
+        *definitions;       // the routine definitions by routine
+};
+
+/**
+ * Find the routine definitions in a parse tree.
+ * @param node the root of the parse tree.
+ * @param definitions the definitions by routine.
+ */
+static void collectDefinitions(tree::ParseTree *node,
+                map<SymtabEntry *, PascalParser::RoutineDefinitionContext *>&
+                                                                definitions)
+{
+    if (auto *defnCtx =
+                dynamic_cast<PascalParser::RoutineDefinitionContext *>(node))
+    {
+        SymtabEntry *routineId =
+                defnCtx->functionHead() != nullptr
+                    ? defnCtx->functionHead()->routineIdentifier()->entry
+                    : defnCtx->procedureHead()->routineIdentifier()->entry;
+        definitions[routineId] = defnCtx;
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        collectDefinitions(child, definitions);
+    }
+}
+
+/**
+ * Whether a write by a routine can change the argument of a const
+ * reference parameter. A write can't if the variable's type can't
+ * contain or be contained by the parameter's, or if the variable is
+ * local to the parameter's routine, to a routine in it, or to the
+ * writing routine. A VAR parameter of a routine that it calls is
+ * checked where it's passed instead.
+ * @param id the variable's entry.
+ * @param routineId the writing routine.
+ * @param check what not to write.
+ * @return true if it can.
+ */
+static bool writesAlias(SymtabEntry *id, SymtabEntry *routineId,
+                        AliasCheck& check)
+{
+    Kind kind = id->getKind();
+    Symtab *symtab = id->getSymtab();
+    Symtab *routineSymtab = routineId->getRoutineSymtab();
+
+    if ((kind == PROCEDURE) || (kind == FUNCTION)) return false;
+    if (   !contains(id->getType(), check.type)
+        && !contains(check.type, id->getType()))
+    {
+        return false;
+    }
+
+    if (kind == REFERENCE_PARAMETER)
+    {
+        return (symtab != routineSymtab) || (routineId == check.routineId);
+    }
+
+    return    (symtab != routineSymtab)
+           && (check.fresh.find(symtab) == check.fresh.end());
+}
+
+/**
+ * Whether a routine body, including the routines it calls,
+ * can write the argument of a const reference parameter.
+ * @param node the root of the parse tree of the body.
+ * @param routineId the routine.
+ * @param check what not to write.
+ * @return true if it can.
+ */
+static bool writesAlias(tree::ParseTree *node, SymtabEntry *routineId,
+                        AliasCheck& check)
+{
+    PascalParser::ArgumentListContext *argListCtx = nullptr;
+    SymtabEntry *calleeId = nullptr;
+
+    // Nested routines are checked where they're called.
+    if (dynamic_cast<PascalParser::RoutineDefinitionContext *>(node) != nullptr)
+    {
+        return false;
+    }
+
+    if (auto *lhsCtx = dynamic_cast<PascalParser::LhsContext *>(node))
+    {
+        SymtabEntry *id = lhsCtx->variable()->variableIdentifier()->entry;
+        if (writesAlias(id, routineId, check)) return true;
+    }
+    else if (auto *forCtx =
+                    dynamic_cast<PascalParser::ForStatementContext *>(node))
+    {
+        SymtabEntry *id = forCtx->variable()->variableIdentifier()->entry;
+        if (writesAlias(id, routineId, check)) return true;
+    }
+    else if (auto *readCtx =
+                    dynamic_cast<PascalParser::ReadArgumentsContext *>(node))
+    {
+        for (PascalParser::VariableContext *varCtx : readCtx->variable())
+        {
+            SymtabEntry *id = varCtx->variableIdentifier()->entry;
+            if (writesAlias(id, routineId, check)) return true;
+        }
+    }
+    else if (auto *callCtx =
+            dynamic_cast<PascalParser::ProcedureCallStatementContext *>(node))
+    {
+        argListCtx = callCtx->argumentList();
+        calleeId   = callCtx->procedureName()->entry;
+    }
+    else if (auto *callCtx =
+                    dynamic_cast<PascalParser::FunctionCallContext *>(node))
+    {
+        argListCtx = callCtx->argumentList();
+        calleeId   = callCtx->functionName()->entry;
+    }
+
+    if (calleeId != nullptr)
+    {
+        vector<SymtabEntry *> *parms = calleeId->getRoutineParameters();
+        vector<PascalParser::ArgumentContext *> args;
+        if (argListCtx != nullptr) args = argListCtx->argument();
+
+        // An argument passed by reference can be written.
+        for (int i = 0; (parms != nullptr) && (i < (int) parms->size())
+                                           && (i < (int) args.size()); i++)
+        {
+            auto *factorCtx =
+                dynamic_cast<PascalParser::VariableFactorContext *>(
+                    args[i]->expression()->simpleExpression()[0]
+                                        ->term()[0]->factor()[0]);
+
+            if (   ((*parms)[i]->getKind() == REFERENCE_PARAMETER)
+                && (factorCtx != nullptr)
+                && writesAlias(factorCtx->variable()->variableIdentifier()
+                                                    ->entry, routineId, check))
+            {
+                return true;
+            }
+        }
+
+        // A declared routine must be checked, too.
+        Routine code = calleeId->getRoutineCode();
+        if (   ((code == DECLARED) || (code == FORWARD))
+            && check.visited.insert(calleeId).second)
+        {
+            auto it = check.definitions->find(calleeId);
+            if (it == check.definitions->end()) return true;  // in a unit
+
+            if (writesAlias(it->second->block(), calleeId, check)) return true;
+        }
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        if (writesAlias(child, routineId, check)) return true;
+    }
+
+    return false;
+}
+
 Object Converter::visitParameterDeclarations(
                                 PascalParser::ParameterDeclarationsContext *ctx)
 {
@@ -349,15 +901,79 @@ Object Converter::visitParameterDeclarations(
     PascalParser::TypeIdentifierContext *typeCtx = ctx->typeIdentifier();
     Typespec *parmType = typeCtx->type;
 
+    // A record or string value parameter that the routine never modifies
+    // is passed by const reference instead of copied, unless the routine
+    // or a routine it calls could modify the argument some other way.
+    bool structured =    !varParm
+                      && (   (parmType->getForm() == RECORD)
+                          || (parmType->baseType() == Predefined::stringType));
+    tree::ParseTree *routineCtx = ctx;
+    while (   structured && (routineCtx != nullptr)
+           && (dynamic_cast<PascalParser::RoutineDefinitionContext *>(routineCtx)
+                                                                    == nullptr))
+    {
+        routineCtx = routineCtx->parent;
+    }
+
+    // A routine that a unit exports keeps the parameters of its prototype.
+    if (structured && (routineCtx != nullptr))
+    {
+        PascalParser::RoutineDefinitionContext *defnCtx =
+                static_cast<PascalParser::RoutineDefinitionContext *>(routineCtx);
+        SymtabEntry *routineId =
+                defnCtx->functionHead() != nullptr
+                    ? defnCtx->functionHead()->routineIdentifier()->entry
+                    : defnCtx->procedureHead()->routineIdentifier()->entry;
+
+        if (exports.find(routineId) != exports.end()) routineCtx = nullptr;
+        else if (definitions.empty())
+        {
+            tree::ParseTree *rootCtx = routineCtx;
+            while (rootCtx->parent != nullptr) rootCtx = rootCtx->parent;
+            collectDefinitions(rootCtx, definitions);
+        }
+    }
+
     // Loop over the parameters.
     for (PascalParser::ParameterIdentifierContext *parmIdCtx :
                                             parmListCtx->parameterIdentifier())
     {
+        bool constRef = false;
+
+        if (structured && (routineCtx != nullptr))
+        {
+            PascalParser::RoutineDefinitionContext *defnCtx =
+                static_cast<PascalParser::RoutineDefinitionContext *>(routineCtx);
+            SymtabEntry *routineId = parmIdCtx->entry->getSymtab()->getOwner();
+
+            map<SymtabEntry *, PascalParser::RoutineDefinitionContext *>
+                                                                    nested;
+            AliasCheck check;
+
+            collectDefinitions(defnCtx, nested);
+            for (auto& p : nested)
+            {
+                check.fresh.insert(p.first->getRoutineSymtab());
+            }
+
+            check.type = parmType;
+            check.routineId = routineId;
+            check.visited.insert(routineId);
+            check.definitions = &definitions;
+
+            constRef =    !modifies(defnCtx->block(), parmIdCtx->entry)
+                       && !writesAlias(defnCtx->block(), routineId, check);
+        }
+
         code.emit(currentSeparator);
         code.split(60);
 
+        if (constRef) code.emit("const ");
         visit(typeCtx);
-        if (varParm && (typeCtx->type->getForm() != ARRAY)) code.emit("&");
+        if (constRef || (varParm && (typeCtx->type->getForm() != ARRAY)))
+        {
+            code.emit("&");
+        }
         code.emit(" " + parmIdCtx->entry->getName());
 
         if (parmType->getForm() == ARRAY) emitArrayDimensions(parmType);
@@ -525,6 +1141,14 @@ Object Converter::visitVariable(PascalParser::VariableContext *ctx)
         variableName = type->getIdentifier()->getName() + "::" + variableName;
     }
 
+    // An element addressed through a pointer hoisted out of its loop
+    // takes the subscript already rebased on the start of its row.
+    auto it = hoistedRows.find(ctx);
+    if (it != hoistedRows.end())
+    {
+        return it->second.first + "[" + it->second.second + "]";
+    }
+
     // Loop over any subscript and field modifiers.
     for (PascalParser::ModifierContext *modCtx : ctx->modifier())
     {
@@ -534,23 +1158,13 @@ Object Converter::visitVariable(PascalParser::VariableContext *ctx)
             for (PascalParser::IndexContext *indexCtx :
                                                 modCtx->indexList()->index())
             {
-                Typespec *indexType = type->getArrayIndexType();
-                int minIndex = 0;
-
-                if (indexType->getForm() == SUBRANGE)
-                {
-                    minIndex = indexType->getSubrangeMinValue();
-                }
+                int minIndex = arrayMinIndex(type);
 
                 PascalParser::ExpressionContext *exprCtx =
                                                     indexCtx->expression();
                 string expr = visit(exprCtx).as<string>();
-                string subscript =
-                  (minIndex == 0) ? expr
-                : (minIndex < 0)  ? "(" + expr + ")+" + to_string(-minIndex)
-                :                   "(" + expr + ")-" + to_string(minIndex);
 
-                variableName += "[" + subscript + "]";
+                variableName += "[" + offsetSubscript(expr, minIndex) + "]";
 
                 type = type->getArrayElementType();
             }
@@ -567,6 +1181,128 @@ Object Converter::visitVariable(PascalParser::VariableContext *ctx)
     return variableName;
 }
 
+int Converter::arrayMinIndex(Typespec *arrayType)
+{
+    Typespec *indexType = arrayType->getArrayIndexType();
+    return indexType->getForm() == SUBRANGE ? indexType->getSubrangeMinValue()
+                                            : 0;
+}
+
+string Converter::offsetSubscript(const string& expr, int minIndex)
+{
+    return (minIndex == 0) ? expr
+         : (minIndex < 0)  ? "(" + expr + ")+" + to_string(-minIndex)
+         :                   "(" + expr + ")-" + to_string(minIndex);
+}
+
+vector<string> Converter::hoistArrayRows(
+                                    PascalParser::ForStatementContext *ctx)
+{
+    vector<string> declarations;
+    LoopAnalyzer analyzer;
+    auto references = analyzer.hoistableReferences(ctx);
+    string loopName = ctx->variable()->getText();
+
+    // The rows of each array that the loop addresses through pointers,
+    // and the arrays it also subscripts the ordinary way.
+    map<SymtabEntry *, set<string>> rows;
+    set<SymtabEntry *> subscripted;
+    vector<string> rowTexts;
+    vector<int> minIndexes;
+
+    for (auto& p : references)
+    {
+        PascalParser::VariableContext *varCtx = p.first;
+        SymtabEntry *arrayId = varCtx->variableIdentifier()->entry;
+        string row = arrayId->getName();
+        int minIndex = 0;
+
+        if (p.second)
+        {
+            Typespec *type = varCtx->variableIdentifier()->type;
+            vector<PascalParser::IndexContext *> indexes;
+
+            for (PascalParser::ModifierContext *modCtx : varCtx->modifier())
+            {
+                for (PascalParser::IndexContext *indexCtx :
+                                                modCtx->indexList()->index())
+                {
+                    indexes.push_back(indexCtx);
+                }
+            }
+
+            // Every subscript but the last selects the row.
+            for (int i = 0; i < (int) indexes.size() - 1; i++)
+            {
+                string expr = visit(indexes[i]->expression()).as<string>();
+
+                row += "[" + offsetSubscript(expr, arrayMinIndex(type)) + "]";
+                type = type->getArrayElementType();
+            }
+
+            minIndex = arrayMinIndex(type);
+            rows[arrayId].insert(row);
+        }
+        else subscripted.insert(arrayId);
+
+        rowTexts.push_back(row);
+        minIndexes.push_back(minIndex);
+    }
+
+    // A pointer is restricted if no other pointer or subscript in the loop
+    // can reach its array. An array parameter may be any other array,
+    // so neither it nor another array can be restricted if the loop
+    // references both.
+    set<SymtabEntry *> arrays(subscripted);
+    bool parameters = false;
+
+    for (auto& p : rows) arrays.insert(p.first);
+    for (SymtabEntry *arrayId : arrays)
+    {
+        Kind kind = arrayId->getKind();
+        if ((kind == VALUE_PARAMETER) || (kind == REFERENCE_PARAMETER))
+        {
+            parameters = true;
+        }
+    }
+
+    map<string, string> pointers;  // pointer names by row
+
+    for (int i = 0; i < (int) references.size(); i++)
+    {
+        if (!references[i].second) continue;
+
+        PascalParser::VariableContext *varCtx = references[i].first;
+        SymtabEntry *arrayId = varCtx->variableIdentifier()->entry;
+        string& pointer = pointers[rowTexts[i]];
+
+        // The pointer addresses the start of the row, since one offset
+        // by the minimum index could point outside the array. Instead,
+        // the minimum is folded into the subscript's constant offset.
+        if (pointer.empty())
+        {
+            bool restricted =    (rows[arrayId].size() == 1)
+                              && (subscripted.find(arrayId) == subscripted.end())
+                              && (!parameters || (arrays.size() == 1));
+
+            pointer = "_" + arrayId->getName() + to_string(++hoistCount);
+            declarations.push_back(
+                  typeName(varCtx->type) + " *"
+                + (restricted ? "__restrict " : "") + pointer + " = "
+                + rowTexts[i] + ";");
+        }
+
+        int offset = analyzer.loopOffset(varCtx) - minIndexes[i];
+        string subscript = (offset > 0) ? loopName + "+" + to_string(offset)
+                         : (offset < 0) ? loopName + "-" + to_string(-offset)
+                         :                loopName;
+
+        hoistedRows[varCtx] = make_pair(pointer, subscript);
+    }
+
+    return declarations;
+}
+
 Object Converter::visitNumberFactor(PascalParser::NumberFactorContext *ctx)
 {
     return ctx->getText();
@@ -596,131 +1332,70 @@ Object Converter::visitParenthesizedFactor(
 
 Object Converter::visitWriteStatement(PascalParser::WriteStatementContext *ctx)
 {
-    code.emit("printf(");
+    code.emit("_out");
     code.mark();
+    emitWriteArguments(ctx->writeArguments());
+    code.emitEnd(";");
 
-    string format    = createWriteFormat(ctx->writeArguments());
-    string arguments = createWriteArguments(ctx->writeArguments());
-
-    code.emit("\"" + format + "\"");
-
-    if (arguments.length() > 0)
-    {
-        code.emit(", ");
-        code.split(60);
-        code.emit(arguments);
-    }
-
-    code.emitEnd(");");
     return nullptr;
 }
 
 Object Converter::visitWritelnStatement(
                                     PascalParser::WritelnStatementContext *ctx)
 {
+    code.emit("_out");
+    code.mark();
     if (ctx->writeArguments() != nullptr)
     {
-        code.emit("printf(");
-        code.mark();
-
-        string format    = createWriteFormat(ctx->writeArguments());
-        string arguments = createWriteArguments(ctx->writeArguments());
-
-        code.emit("\"" + format + "\\n\"");  // append line feed
-
-        if (arguments.length() > 0)
-        {
-            code.emit(", ");
-            code.split(60);
-            code.emit(arguments);
-        }
-
-        code.emitEnd(");");
-    }
-    else
-    {
-        code.emit("cout << endl;");
+        emitWriteArguments(ctx->writeArguments());
     }
+    code.emitEnd(".put('\\n');");
 
     return nullptr;
 }
 
-string Converter::createWriteFormat(PascalParser::WriteArgumentsContext *ctx)
+void Converter::emitWriteArguments(PascalParser::WriteArgumentsContext *ctx)
 {
-    string format = "";
-
     // Loop over the write arguments.
     for (PascalParser::WriteArgumentContext *argCtx : ctx->writeArgument())
     {
-        Typespec *type = argCtx->expression()->type;
+        PascalParser::FieldWidthContext *fwCtx = argCtx->fieldWidth();
         string argText = argCtx->getText();
 
-        // Append any literal strings.
-        if (argText[0] == '\'')
+        // Put any literal strings as they are.
+        if ((argText[0] == '\'') && (fwCtx == nullptr))
         {
-            format += convertString(argText, true);
+            code.emit(".put(\"" + convertString(argText, true) + "\")");
         }
 
-        // For any other expressions, append a field specifier.
+        // Write any other expressions in their fields.
         else
         {
-            format += "%";
+            Typespec *type = argCtx->expression()->type->baseType();
+            string arg = visit(argCtx->expression()).as<string>();
 
-            PascalParser::FieldWidthContext *fwCtx = argCtx->fieldWidth();
+            if      (type->getForm() == ENUMERATION) arg = "(int) " + arg;
+            else if (type == Predefined::realType) arg = "(double) (" + arg + ")";
+
+            string field = "";
             if (fwCtx != nullptr)
             {
                 string sign = (   (fwCtx->sign() != nullptr)
                                && (fwCtx->sign()->getText() == "-")) ? "-" : "";
-                format += sign + fwCtx->integerConstant()->getText();
+                field += ", " + sign + fwCtx->integerConstant()->getText();
 
                 PascalParser::DecimalPlacesContext *dpCtx = fwCtx->decimalPlaces();
                 if (dpCtx != nullptr)
                 {
-                    format += "." + dpCtx->integerConstant()->getText();
+                    field += ", " + dpCtx->integerConstant()->getText();
                 }
             }
 
-            string typeFlag = type == Predefined::integerType ? "d"
-                            : type == Predefined::realType    ? "f"
-                            : type == Predefined::charType    ? "c"
-                            : type == Predefined::booleanType ? "d"
-                            :                                   "s";
-            format += typeFlag;
+            code.emit(".write(" + arg + field + ")");
         }
-    }
-
-    return format;
-}
-
-string Converter::createWriteArguments(PascalParser::WriteArgumentsContext *ctx)
-{
-    string arguments = "";
-    string separator = "";
-
-    // Loop over the write arguments.
-    for (PascalParser::WriteArgumentContext *argCtx : ctx->writeArgument())
-    {
-        string argText = argCtx->getText();
-
-        // Not a literal string.
-        if (argText[0] != '\'')
-        {
-            string arg = visit(argCtx->expression()).as<string>();
-
-            if (argCtx->expression()->type == Predefined::stringType)
-            {
-                arguments += separator + "(" + arg + ")" + ".c_str()";
-            }
-            else
-            {
-                arguments += separator + arg;
-            }
 
-            separator = ", ";
-        }
+        code.split(60);
     }
-
-    return arguments;
 }
 
 Object Converter::visitReadStatement(PascalParser::ReadStatementContext *ctx)
@@ -750,7 +1425,7 @@ Object Converter::visitReadlnStatement(PascalParser::ReadlnStatementContext *ctx
     code.emitStart();
 
     visit(ctx->readArguments());
-    code.emitLine("cin.ignore(4096, '\\n');");
+    code.emitLine("_in.skipLine();");
 
     code.dedent();
     code.emitLine("}");
@@ -765,21 +1440,9 @@ Object Converter::visitReadArguments(PascalParser::ReadArgumentsContext *ctx)
     for (int i = 0; i < size; i++)
     {
         PascalParser::VariableContext *varCtx = ctx->variable()[i];
-        string varName = varCtx->getText();
-        Typespec *type = varCtx->type;
+        string varName = visit(varCtx).as<string>();
 
-        if (type == Predefined::charType)
-        {
-            code.emit(varName + " = getchar();");
-        }
-        else if (type == Predefined::booleanType)
-        {
-            code.emit("cin >> boolalpha >> " + varName + ";");
-        }
-        else
-        {
-            code.emit("cin >> " + varName + ";");
-        }
+        code.emit("_in.read(" + varName + ");");
 
         if (i < size-1) code.emitStart();
     }
@@ -834,6 +1497,29 @@ Object Converter::visitForStatement(PascalParser::ForStatementContext *ctx){
 	string start = ctx->expression()[0]->getText();
 	string stop    = ctx->expression()[1]->getText();
 
+	// Annotate an outermost loop whose iterations are independent.
+	string pragma;
+	if (options.parallel && !parallelLoop)
+	{
+		pragma = LoopAnalyzer().parallelPragma(ctx);
+	}
+	bool parallel = !pragma.empty();
+	if (parallel) parallelLoop = true;
+
+	// Hoist the array rows of an innermost loop into pointers
+	// declared in a block around it.
+	vector<string> pointers;
+	if (options.vectorize) pointers = hoistArrayRows(ctx);
+	if (!pointers.empty())
+	{
+		code.emit("{");
+		code.indent();
+		for (string& pointer : pointers) code.emitLine(pointer);
+		code.emitStart();
+	}
+
+	if (parallel) code.emitEnd(pragma);
+
 	// Generate syntax
 	code.emitStart("for (");
 	code.emit(var);
@@ -869,6 +1555,14 @@ Object Converter::visitForStatement(PascalParser::ForStatementContext *ctx){
 		visit(ctx->statement());
 		code.dedent();
 	}
+
+	if (!pointers.empty())
+	{
+		code.dedent();
+		code.emitLine("}");
+	}
+
+	if (parallel) parallelLoop = false;
 	return nullptr;
 }
 
@@ -2,6 +2,7 @@
 #define CONVERTER_H_
 
 #include <map>
+#include <set>
 #include <vector>
 
 #include "PascalBaseVisitor.h"
@@ -18,18 +19,43 @@ using namespace std;
 using namespace intermediate::symtab;
 using namespace intermediate::type;
 
+// Change whenever the generated code changes,
+// so that cached native builds are rebuilt.
+constexpr const char *CONVERTER_VERSION = "6";
+
+/**
+ * Options for the generated code.
+ */
+struct ConverterOptions
+{
+    bool parallel = false;   // annotate independent FOR loops for OpenMP
+    bool vectorize = false;  // hoist array rows out of innermost FOR loops
+    bool instrument = false; // count and time the calls of each routine
+};
+
 class Converter : public PascalBaseVisitor
 {
 private:
     CodeGenerator code;
+    ConverterOptions options;
     bool programVariables;
     bool recordFields;
+    bool unit;          // true if converting a unit
+    bool declaring;     // true while emitting a unit's header
+    set<SymtabEntry *> exports;  // the variables and routines of a unit's interface
+    bool parallelLoop;  // true while converting a parallel loop's body
+    int hoistCount;     // number of hoisted array row pointers
+    map<SymtabEntry *, PascalParser::RoutineDefinitionContext *>
+        definitions;    // the routine definitions by routine
+    map<PascalParser::VariableContext *, pair<string, string>>
+        hoistedRows;    // pointers to the rows and their subscripts
     string currentSeparator;
 
 public:
-    Converter()
-        : programVariables(true), recordFields(false),
-          currentSeparator("")
+    Converter(const ConverterOptions& options = ConverterOptions())
+        : options(options), programVariables(true), recordFields(false),
+          unit(false), declaring(false),
+          parallelLoop(false), hoistCount(0), currentSeparator("")
     {
         typeNameTable["integer"] = "int";
         typeNameTable["real"]    = "double";
@@ -44,8 +70,23 @@ public:
      */
     string getObjectFileName() const { return code.getObjectFileName(); }
 
+    /**
+     * Determine whether the source was a unit, whose object file
+     * is compiled but not linked by itself.
+     * @return true if a unit.
+     */
+    bool isUnit() const { return unit; }
+
+    /**
+     * Get the number of lines of generated code.
+     * @return the count.
+     */
+    int getLineCount() const { return code.getLineCount(); }
+
     Object visitProgram(PascalParser::ProgramContext *ctx) override;
     Object visitProgramHeader(PascalParser::ProgramHeaderContext *ctx) override;
+    Object visitUnit(PascalParser::UnitContext *ctx) override;
+    Object visitRoutineHead(PascalParser::RoutineHeadContext *ctx) override;
     Object visitConstantDefinition(PascalParser::ConstantDefinitionContext *ctx) override;
     Object visitTypeDefinition(PascalParser::TypeDefinitionContext *ctx) override;
     Object visitEnumerationTypespec(PascalParser::EnumerationTypespecContext *ctx) override;
@@ -100,6 +141,31 @@ private:
      */
     string typeName(Typespec*pascalType);
 
+    /**
+     * Emit the standard includes and the I/O runtime.
+     */
+    void emitRuntime();
+
+    /**
+     * Emit the routine profiling support of an instrumented program.
+     */
+    void emitProfiler();
+
+    /**
+     * Emit an include of the header of each unit that is used.
+     * @param ctx the UsesPartContext, or null if none.
+     */
+    void emitUnitIncludes(PascalParser::UsesPartContext *ctx);
+
+    /**
+     * Get the storage class of a variable or routine: static if a unit
+     * declares it only in its implementation, extern if its interface
+     * declares it and the unit's header is being emitted, else none.
+     * @param id the symbol table entry of the variable or routine.
+     * @return the storage class followed by a blank, or "".
+     */
+    string storageClass(SymtabEntry *id);
+
     /**
      * Emit a variable declaration with allocation for an array or record.
      * @param type the datatype of the variable.
@@ -174,18 +240,36 @@ private:
                                Typespec *varType);
 
     /**
-     * Create the printf format string.
-     * @param ctx the WriteArgumentsContext.
-     * @return the format string.
+     * Get the minimum index of an array's first dimension.
+     * @param arrayType the array datatype.
+     * @return the minimum index, 0 unless the index type is a subrange.
+     */
+    int arrayMinIndex(Typespec *arrayType);
+
+    /**
+     * Offset a subscript by the minimum index of its dimension.
+     * @param expr the converted subscript expression.
+     * @param minIndex the minimum index.
+     * @return the zero-based subscript.
+     */
+    static string offsetSubscript(const string& expr, int minIndex);
+
+    /**
+     * Hoist the rows of the array elements that an innermost FOR loop
+     * addresses by the loop variable into pointers to the row starts.
+     * Each subscript becomes the loop variable plus a single constant,
+     * its Pascal offset less the subrange minimum, so that the loop
+     * subtracts no minimum at run time.
+     * @param ctx the FOR statement context.
+     * @return the pointer declarations to emit before the loop.
      */
-    string createWriteFormat(PascalParser::WriteArgumentsContext *ctx);
+    vector<string> hoistArrayRows(PascalParser::ForStatementContext *ctx);
 
     /**
-     * Create the string of write arguments.
+     * Emit the calls of the output writer for the write arguments.
      * @param ctx the WriteArgumentsContext.
-     * @return the string of arguments.
      */
-    string createWriteArguments(PascalParser::WriteArgumentsContext *ctx);
+    void emitWriteArguments(PascalParser::WriteArgumentsContext *ctx);
 };
 
 }} // namespace backend::converter
@@ -0,0 +1,668 @@
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#include "PascalParser.h"
+#include "antlr4-runtime.h"
+
+#include "Object.h"
+#include "intermediate/symtab/Predefined.h"
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/type/Typespec.h"
+#include "LoopAnalyzer.h"
+
+namespace backend { namespace converter {
+
+using namespace intermediate::type;
+
+/**
+ * Count the references to a variable in a parse tree.
+ * @param node the root of the parse tree.
+ * @param id the variable's entry.
+ * @return the count.
+ */
+static int countReferences(tree::ParseTree *node, SymtabEntry *id)
+{
+    int count = 0;
+
+    if (auto *varCtx = dynamic_cast<PascalParser::VariableContext *>(node))
+    {
+        if (varCtx->variableIdentifier()->entry == id) count++;
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        count += countReferences(child, id);
+    }
+
+    return count;
+}
+
+/**
+ * Whether a variable is numeric.
+ * @param id the variable's entry.
+ * @return true if its type is integer or real.
+ */
+static bool isNumeric(SymtabEntry *id)
+{
+    Typespec *type = id->getType()->baseType();
+    return (type == Predefined::integerType) || (type == Predefined::realType);
+}
+
+string LoopAnalyzer::parallelPragma(PascalParser::ForStatementContext *ctx)
+{
+    if (!ctx->variable()->modifier().empty()) return "";
+
+    loopId = ctx->variable()->variableIdentifier()->entry;
+    statement(ctx->statement(), true);
+
+    if (!parallel) return "";
+
+    // A scalar written by a plain assignment must be assigned on every
+    // path of every iteration before it's read, and it can't also be
+    // a reduction variable. Otherwise lastprivate would copy out an
+    // uninitialized value from a last iteration that didn't assign it.
+    for (SymtabEntry *id : written)
+    {
+        if (   (assigned.find(id) == assigned.end())
+            || (readFirst.find(id) != readFirst.end())
+            || (reductions.find(id) != reductions.end()))
+        {
+            return "";
+        }
+    }
+
+    // A reduction variable can only be read by its own updates.
+    for (auto& p : reductions)
+    {
+        if (readFirst.find(p.first) != readFirst.end()) return "";
+    }
+
+    // Each iteration must write only its own slice of an array.
+    // An array parameter may be another array in disguise.
+    bool arrayWritten = false;
+    bool arrayParameter = false;
+
+    for (auto& p : arrays)
+    {
+        Kind kind = p.first->getKind();
+        if ((kind == VALUE_PARAMETER) || (kind == REFERENCE_PARAMETER))
+        {
+            arrayParameter = true;
+        }
+
+        for (const ArrayReference& reference : p.second)
+        {
+            if (reference.write)
+            {
+                if (!isPartitioned(p.second)) return "";
+                arrayWritten = true;
+                break;
+            }
+        }
+    }
+
+    if (arrayWritten && arrayParameter && (arrays.size() > 1)) return "";
+
+    // Create the pragma.
+    string pragma = "#pragma omp parallel for";
+    string separator = " lastprivate(";
+
+    for (SymtabEntry *id : written)
+    {
+        pragma += separator + id->getName();
+        separator = ", ";
+    }
+    if (separator == ", ") pragma += ")";
+
+    map<string, string> operands;  // variable names by operator
+    for (auto& p : reductions)
+    {
+        string& names = operands[p.second];
+        names += (names.empty() ? "" : ", ") + p.first->getName();
+    }
+    for (auto& p : operands)
+    {
+        pragma += " reduction(" + p.first + ":" + p.second + ")";
+    }
+
+    return pragma;
+}
+
+vector<pair<PascalParser::VariableContext *, bool>>
+        LoopAnalyzer::hoistableReferences(PascalParser::ForStatementContext *ctx)
+{
+    vector<pair<PascalParser::VariableContext *, bool>> result;
+    vector<PascalParser::VariableContext *> references;
+    set<SymtabEntry *> writes;
+
+    loopId = ctx->variable()->variableIdentifier()->entry;
+    if (!collect(ctx->statement(), references, writes)) return result;
+
+    for (PascalParser::VariableContext *varCtx : references)
+    {
+        vector<PascalParser::ExpressionContext *> subscripts;
+        bool hoistable = (varCtx->type != nullptr)
+                && (   (varCtx->type->getForm() == SCALAR)
+                    || (varCtx->type->getForm() == ENUMERATION));
+
+        for (PascalParser::ModifierContext *modCtx : varCtx->modifier())
+        {
+            if (modCtx->indexList() == nullptr)
+            {
+                hoistable = false;  // record field
+                break;
+            }
+
+            for (PascalParser::IndexContext *indexCtx :
+                                                modCtx->indexList()->index())
+            {
+                subscripts.push_back(indexCtx->expression());
+            }
+        }
+
+        hoistable = hoistable && isLoopOffset(subscripts.back());
+
+        // The other subscripts may read only variables
+        // that the loop doesn't write.
+        for (int i = 0; hoistable && (i < (int) subscripts.size() - 1); i++)
+        {
+            vector<PascalParser::VariableContext *> subscriptReferences;
+            set<SymtabEntry *> unused;
+            collect(subscripts[i], subscriptReferences, unused);
+
+            hoistable =    subscriptReferences.empty()
+                        && (countReferences(subscripts[i], loopId) == 0);
+
+            for (SymtabEntry *id : writes)
+            {
+                if (countReferences(subscripts[i], id) > 0) hoistable = false;
+            }
+        }
+
+        result.push_back(make_pair(varCtx, hoistable));
+    }
+
+    return result;
+}
+
+bool LoopAnalyzer::collect(tree::ParseTree *node,
+                           vector<PascalParser::VariableContext *>& references,
+                           set<SymtabEntry *>& writes)
+{
+    if (   (dynamic_cast<PascalParser::ForStatementContext *>(node) != nullptr)
+        || (dynamic_cast<PascalParser::WhileStatementContext *>(node) != nullptr)
+        || (dynamic_cast<PascalParser::RepeatStatementContext *>(node) != nullptr)
+        || (dynamic_cast<PascalParser::ProcedureCallStatementContext *>(node)
+                                                                    != nullptr)
+        || (dynamic_cast<PascalParser::FunctionCallContext *>(node) != nullptr)
+        || (dynamic_cast<PascalParser::ReadArgumentsContext *>(node) != nullptr))
+    {
+        return false;
+    }
+
+    if (auto *lhsCtx = dynamic_cast<PascalParser::LhsContext *>(node))
+    {
+        writes.insert(lhsCtx->variable()->variableIdentifier()->entry);
+    }
+    else if (auto *varCtx = dynamic_cast<PascalParser::VariableContext *>(node))
+    {
+        for (PascalParser::ModifierContext *modCtx : varCtx->modifier())
+        {
+            if (modCtx->indexList() != nullptr)
+            {
+                references.push_back(varCtx);
+                break;
+            }
+        }
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        if (!collect(child, references, writes)) return false;
+    }
+
+    return true;
+}
+
+void LoopAnalyzer::statement(PascalParser::StatementContext *ctx, bool always)
+{
+    if (!parallel) return;
+
+    if (auto *compoundCtx = ctx->compoundStatement())
+    {
+        for (PascalParser::StatementContext *stmtCtx :
+                                compoundCtx->statementList()->statement())
+        {
+            statement(stmtCtx, always);
+        }
+    }
+    else if (auto *assignCtx = ctx->assignmentStatement())
+    {
+        assignment(assignCtx, always);
+    }
+    else if (auto *ifCtx = ctx->ifStatement())
+    {
+        if (!minMaxOperator(ifCtx).empty()) return;
+
+        reads(ifCtx->expression());
+        statement(ifCtx->trueStatement()->statement(), false);
+
+        if (ifCtx->falseStatement() != nullptr)
+        {
+            statement(ifCtx->falseStatement()->statement(), false);
+        }
+    }
+    else if (auto *caseCtx = ctx->caseStatement())
+    {
+        reads(caseCtx->expression());
+
+        for (PascalParser::CaseBranchContext *branchCtx :
+                                    caseCtx->caseBranchList()->caseBranch())
+        {
+            if (branchCtx->statement() != nullptr)
+            {
+                statement(branchCtx->statement(), false);
+            }
+        }
+    }
+    else if (auto *forCtx = ctx->forStatement())
+    {
+        PascalParser::VariableContext *varCtx = forCtx->variable();
+        SymtabEntry *id = varCtx->variableIdentifier()->entry;
+
+        reads(forCtx->expression()[0]);
+        reads(forCtx->expression()[1]);
+
+        if (   !varCtx->modifier().empty() || (id == loopId)
+            || (id->getKind() == REFERENCE_PARAMETER))
+        {
+            parallel = false;
+            return;
+        }
+
+        // The inner control variable is assigned even if
+        // the inner loop doesn't iterate.
+        written.insert(id);
+        if (always) assigned.insert(id);
+        statement(forCtx->statement(), false);
+    }
+    else if (auto *whileCtx = ctx->whileStatement())
+    {
+        reads(whileCtx->expression());
+        statement(whileCtx->statement(), false);
+    }
+    else if (auto *repeatCtx = ctx->repeatStatement())
+    {
+        // The body executes at least once.
+        for (PascalParser::StatementContext *stmtCtx :
+                                    repeatCtx->statementList()->statement())
+        {
+            statement(stmtCtx, always);
+        }
+
+        reads(repeatCtx->expression());
+    }
+    else if (ctx->emptyStatement() == nullptr)
+    {
+        // Calls and I/O.
+        parallel = false;
+    }
+}
+
+void LoopAnalyzer::assignment(PascalParser::AssignmentStatementContext *ctx,
+                              bool always)
+{
+    PascalParser::VariableContext *lhsCtx = ctx->lhs()->variable();
+    SymtabEntry *id = lhsCtx->variableIdentifier()->entry;
+
+    if ((id == loopId) || (id->getKind() == REFERENCE_PARAMETER))
+    {
+        parallel = false;
+        return;
+    }
+
+    // Array element or record field.
+    if (!lhsCtx->modifier().empty())
+    {
+        for (PascalParser::ModifierContext *modCtx : lhsCtx->modifier())
+        {
+            reads(modCtx);
+        }
+
+        reads(ctx->rhs());
+        arrayReference(lhsCtx, true);
+        return;
+    }
+
+    // Reduction.
+    string op = reductionOperator(ctx);
+    if (!op.empty())
+    {
+        reads(ctx->rhs(), id);
+        reduction(id, op);
+        return;
+    }
+
+    // The value is read before the variable is written.
+    reads(ctx->rhs());
+    written.insert(id);
+    if (always) assigned.insert(id);
+}
+
+void LoopAnalyzer::reads(tree::ParseTree *node, SymtabEntry *skipId)
+{
+    if (!parallel) return;
+
+    if (dynamic_cast<PascalParser::FunctionCallContext *>(node) != nullptr)
+    {
+        parallel = false;
+        return;
+    }
+
+    if (auto *varCtx = dynamic_cast<PascalParser::VariableContext *>(node))
+    {
+        SymtabEntry *id = varCtx->variableIdentifier()->entry;
+
+        if (!varCtx->modifier().empty()) arrayReference(varCtx, false);
+        else if (   (id != skipId) && (id != loopId)
+                 && (assigned.find(id) == assigned.end()))
+        {
+            readFirst.insert(id);
+        }
+    }
+
+    // Subscripts read variables, too.
+    for (tree::ParseTree *child : node->children) reads(child, skipId);
+}
+
+void LoopAnalyzer::arrayReference(PascalParser::VariableContext *ctx,
+                                  bool write)
+{
+    SymtabEntry *id = ctx->variableIdentifier()->entry;
+    ArrayReference reference;
+    reference.write = write;
+
+    for (PascalParser::ModifierContext *modCtx : ctx->modifier())
+    {
+        if (modCtx->indexList() == nullptr) continue;
+
+        for (PascalParser::IndexContext *indexCtx :
+                                            modCtx->indexList()->index())
+        {
+            reference.subscripts.push_back(indexCtx->expression());
+        }
+    }
+
+    // A field of a record variable.
+    if (reference.subscripts.empty())
+    {
+        if (write) parallel = false;
+        else if (assigned.find(id) == assigned.end()) readFirst.insert(id);
+
+        return;
+    }
+
+    arrays[id].push_back(reference);
+}
+
+string LoopAnalyzer::reductionOperator(
+                                PascalParser::AssignmentStatementContext *ctx)
+{
+    SymtabEntry *id = ctx->lhs()->variable()->variableIdentifier()->entry;
+    PascalParser::ExpressionContext *exprCtx = ctx->rhs()->expression();
+
+    if ((exprCtx->relOp() != nullptr) || (countReferences(exprCtx, id) != 1))
+    {
+        return "";
+    }
+
+    PascalParser::SimpleExpressionContext *simpleCtx =
+                                                exprCtx->simpleExpression()[0];
+    vector<PascalParser::TermContext *> terms = simpleCtx->term();
+    bool negated = (simpleCtx->sign() != nullptr)
+                        && (simpleCtx->sign()->getText() == "-");
+
+    // s := s + x - y, s := x + s, or s := s or x.
+    if (terms.size() > 1)
+    {
+        bool found = false;
+        bool additive = true;
+        bool logical = true;
+
+        for (int i = 0; i < (int) terms.size(); i++)
+        {
+            string op = i > 0 ? toLowerCase(simpleCtx->addOp()[i-1]->getText())
+                              : "";
+
+            if      (op == "or")  additive = false;
+            else if (i > 0)       logical  = false;
+
+            if (   (terms[i]->factor().size() == 1)
+                && (simpleVariable(terms[i]->factor()[0]) == id))
+            {
+                if (((i == 0) && negated) || (op == "-")) return "";
+                found = true;
+            }
+        }
+
+        if (!found) return "";
+        if (additive && isNumeric(id)) return "+";
+        if (logical && (id->getType() == Predefined::booleanType)) return "||";
+        return "";
+    }
+
+    // s := s*x*y or s := s and x.
+    if (negated) return "";
+
+    PascalParser::TermContext *termCtx = terms[0];
+    vector<PascalParser::FactorContext *> factors = termCtx->factor();
+    bool found = false;
+    bool multiplicative = true;
+    bool logical = true;
+
+    if (factors.size() < 2) return "";
+
+    for (int i = 0; i < (int) factors.size(); i++)
+    {
+        if (i > 0)
+        {
+            string op = toLowerCase(termCtx->mulOp()[i-1]->getText());
+            if (op != "*")   multiplicative = false;
+            if (op != "and") logical = false;
+        }
+
+        if (simpleVariable(factors[i]) == id) found = true;
+    }
+
+    if (!found) return "";
+    if (multiplicative && isNumeric(id)) return "*";
+    if (logical && (id->getType() == Predefined::booleanType)) return "&&";
+    return "";
+}
+
+string LoopAnalyzer::minMaxOperator(PascalParser::IfStatementContext *ctx)
+{
+    PascalParser::ExpressionContext *condCtx = ctx->expression();
+    PascalParser::AssignmentStatementContext *assignCtx =
+                    ctx->trueStatement()->statement()->assignmentStatement();
+
+    if (   (ctx->falseStatement() != nullptr) || (assignCtx == nullptr)
+        || (condCtx->relOp() == nullptr))
+    {
+        return "";
+    }
+
+    PascalParser::VariableContext *lhsCtx = assignCtx->lhs()->variable();
+    SymtabEntry *id = lhsCtx->variableIdentifier()->entry;
+
+    if (   !lhsCtx->modifier().empty() || !isNumeric(id) || (id == loopId)
+        || (id->getKind() == REFERENCE_PARAMETER)
+        || (countReferences(assignCtx->rhs(), id) != 0))
+    {
+        return "";
+    }
+
+    string relOp = condCtx->relOp()->getText();
+    bool greater = (relOp == ">") || (relOp == ">=");
+    bool less    = (relOp == "<") || (relOp == "<=");
+    if (!greater && !less) return "";
+
+    // if x > m then m := x  is max,  if m > x then m := x  is min.
+    PascalParser::SimpleExpressionContext *leftCtx  =
+                                                condCtx->simpleExpression()[0];
+    PascalParser::SimpleExpressionContext *rightCtx =
+                                                condCtx->simpleExpression()[1];
+    string value = toLowerCase(assignCtx->rhs()->getText());
+    string op;
+
+    if (isVariable(rightCtx, id) && (toLowerCase(leftCtx->getText()) == value))
+    {
+        op = greater ? "max" : "min";
+    }
+    else if (   isVariable(leftCtx, id)
+             && (toLowerCase(rightCtx->getText()) == value))
+    {
+        op = greater ? "min" : "max";
+    }
+    else return "";
+
+    reads(condCtx, id);
+    reads(assignCtx->rhs(), id);
+    reduction(id, op);
+
+    return op;
+}
+
+bool LoopAnalyzer::isLoopOffset(PascalParser::ExpressionContext *ctx,
+                                int *offset)
+{
+    if (ctx->relOp() != nullptr) return false;
+
+    PascalParser::SimpleExpressionContext *simpleCtx =
+                                                ctx->simpleExpression()[0];
+    bool negated = (simpleCtx->sign() != nullptr)
+                        && (simpleCtx->sign()->getText() == "-");
+    bool found = false;
+    int sum = 0;
+
+    for (int i = 0; i < (int) simpleCtx->term().size(); i++)
+    {
+        PascalParser::TermContext *termCtx = simpleCtx->term()[i];
+        string op = i > 0 ? toLowerCase(simpleCtx->addOp()[i-1]->getText())
+                          : "";
+
+        if ((op == "or") || (termCtx->factor().size() != 1)) return false;
+
+        PascalParser::FactorContext *factorCtx = termCtx->factor()[0];
+        SymtabEntry *id = simpleVariable(factorCtx);
+        bool minus = ((i == 0) && negated) || (op == "-");
+
+        if (id == loopId)
+        {
+            if (found || minus) return false;
+            found = true;
+            continue;
+        }
+
+        // Only integer constants can be folded into the offset.
+        int value;
+        auto *numberCtx =
+                dynamic_cast<PascalParser::NumberFactorContext *>(factorCtx);
+
+        if (numberCtx != nullptr)
+        {
+            if (numberCtx->number()->unsignedNumber()->integerConstant()
+                                                                    == nullptr)
+            {
+                return false;
+            }
+
+            value = stoi(numberCtx->getText());
+        }
+        else if (   (id != nullptr) && (id->getKind() == CONSTANT)
+                 && id->getValue().is<int>())
+        {
+            value = id->getValue().as<int>();
+        }
+        else return false;
+
+        sum += minus ? -value : value;
+    }
+
+    if (found && (offset != nullptr)) *offset = sum;
+    return found;
+}
+
+int LoopAnalyzer::loopOffset(PascalParser::VariableContext *ctx)
+{
+    int offset = 0;
+    isLoopOffset(ctx->modifier().back()->indexList()->index().back()
+                                                            ->expression(),
+                 &offset);
+    return offset;
+}
+
+bool LoopAnalyzer::isPartitioned(const vector<ArrayReference>& references)
+{
+    size_t count = references[0].subscripts.size();
+
+    for (const ArrayReference& reference : references)
+    {
+        if (reference.subscripts.size() != count) return false;
+    }
+
+    // Look for a dimension whose subscript is the same loop offset
+    // in every reference.
+    for (size_t d = 0; d < count; d++)
+    {
+        PascalParser::ExpressionContext *subscriptCtx =
+                                            references[0].subscripts[d];
+        if (!isLoopOffset(subscriptCtx)) continue;
+
+        string text = toLowerCase(subscriptCtx->getText());
+        bool same = true;
+
+        for (const ArrayReference& reference : references)
+        {
+            if (toLowerCase(reference.subscripts[d]->getText()) != text)
+            {
+                same = false;
+                break;
+            }
+        }
+
+        if (same) return true;
+    }
+
+    return false;
+}
+
+void LoopAnalyzer::reduction(SymtabEntry *id, const string& op)
+{
+    auto it = reductions.find(id);
+
+    if      (it == reductions.end()) reductions[id] = op;
+    else if (it->second != op)       parallel = false;
+}
+
+SymtabEntry *LoopAnalyzer::simpleVariable(PascalParser::FactorContext *ctx)
+{
+    auto *varFactorCtx = dynamic_cast<PascalParser::VariableFactorContext *>(ctx);
+    if (varFactorCtx == nullptr) return nullptr;
+
+    PascalParser::VariableContext *varCtx = varFactorCtx->variable();
+    return varCtx->modifier().empty() ? varCtx->variableIdentifier()->entry
+                                      : nullptr;
+}
+
+bool LoopAnalyzer::isVariable(PascalParser::SimpleExpressionContext *ctx,
+                              SymtabEntry *id)
+{
+    return    (ctx->sign() == nullptr) && (ctx->term().size() == 1)
+           && (ctx->term()[0]->factor().size() == 1)
+           && (simpleVariable(ctx->term()[0]->factor()[0]) == id);
+}
+
+}} // namespace backend::converter
@@ -0,0 +1,187 @@
+#ifndef CONVERTER_LOOPANALYZER_H_
+#define CONVERTER_LOOPANALYZER_H_
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <utility>
+
+#include "PascalParser.h"
+#include "antlr4-runtime.h"
+
+#include "intermediate/symtab/SymtabEntry.h"
+
+namespace backend { namespace converter {
+
+using namespace std;
+using namespace antlr4;
+using namespace intermediate::symtab;
+
+/**
+ * Decide whether the iterations of a FOR loop are independent,
+ * so that the loop can run in parallel under OpenMP.
+ *
+ * The analysis is conservative. The body may contain only assignment,
+ * compound, IF, CASE, FOR, WHILE, and REPEAT statements, and no
+ * function calls. A scalar written in the body must either be written
+ * on every path of every iteration before it is read, which makes it
+ * private, or be updated only by a sum, product, AND, OR, minimum, or
+ * maximum reduction. Every reference to a written array must have the same
+ * subscript, the loop variable plus or minus a constant, in some
+ * dimension, so that each iteration has its own slice of the array.
+ */
+class LoopAnalyzer
+{
+private:
+    /**
+     * A reference to an array element.
+     */
+    struct ArrayReference
+    {
+        vector<PascalParser::ExpressionContext *> subscripts;
+        bool write;
+    };
+
+    SymtabEntry *loopId;          // the loop control variable
+    bool parallel;                // false once a dependence is possible
+    set<SymtabEntry *> assigned;  // scalars assigned so far in the iteration
+    set<SymtabEntry *> readFirst; // scalars read before being assigned
+    set<SymtabEntry *> written;   // scalars written by plain assignments
+    map<SymtabEntry *, string> reductions;  // reduction operator by variable
+    map<SymtabEntry *, vector<ArrayReference>> arrays;  // by array variable
+
+public:
+    /**
+     * Constructor.
+     */
+    LoopAnalyzer() : loopId(nullptr), parallel(true) {}
+
+    /**
+     * Analyze a FOR loop.
+     * @param ctx the FOR statement context.
+     * @return the OpenMP pragma for the loop,
+     *         or "" if its iterations may depend on each other.
+     */
+    string parallelPragma(PascalParser::ForStatementContext *ctx);
+
+    /**
+     * Find the array element references in the body of an innermost
+     * FOR loop, and which of them can be addressed through a pointer
+     * hoisted out of the loop: those whose last subscript is the loop
+     * variable plus or minus a constant and whose other subscripts
+     * don't change in the loop.
+     * @param ctx the FOR statement context.
+     * @return each reference and whether it can be hoisted, or none
+     *         if the loop isn't innermost or calls or reads anything.
+     */
+    vector<pair<PascalParser::VariableContext *, bool>>
+                hoistableReferences(PascalParser::ForStatementContext *ctx);
+
+    /**
+     * The constant that the last subscript of a hoistable reference
+     * adds to the loop variable of the last analyzed loop.
+     * @param ctx the reference's variable context.
+     * @return the constant.
+     */
+    int loopOffset(PascalParser::VariableContext *ctx);
+
+private:
+    /**
+     * Collect the array element references and written variables
+     * of an innermost loop body.
+     * @param node the root of the parse tree.
+     * @param references the array element references.
+     * @param writes the variables written.
+     * @return false if the body has a loop, call, or read.
+     */
+    static bool collect(tree::ParseTree *node,
+                        vector<PascalParser::VariableContext *>& references,
+                        set<SymtabEntry *>& writes);
+
+    /**
+     * Analyze a statement.
+     * @param ctx the statement context.
+     * @param always true if it executes in every iteration.
+     */
+    void statement(PascalParser::StatementContext *ctx, bool always);
+
+    /**
+     * Analyze an assignment.
+     * @param ctx the assignment statement context.
+     * @param always true if it executes in every iteration.
+     */
+    void assignment(PascalParser::AssignmentStatementContext *ctx, bool always);
+
+    /**
+     * Analyze the variables read by a parse tree.
+     * @param node the root of the parse tree.
+     * @param skipId a reduction variable not to count as read, or null.
+     */
+    void reads(tree::ParseTree *node, SymtabEntry *skipId = nullptr);
+
+    /**
+     * Record a reference to an array element.
+     * @param ctx the variable context.
+     * @param write true for an assignment to the element.
+     */
+    void arrayReference(PascalParser::VariableContext *ctx, bool write);
+
+    /**
+     * Get the reduction operator of an assignment s := s op x.
+     * @param ctx the assignment statement context.
+     * @return the OpenMP operator, or "" if it isn't a reduction.
+     */
+    string reductionOperator(PascalParser::AssignmentStatementContext *ctx);
+
+    /**
+     * Get the reduction operator of "if x > m then m := x" and the like.
+     * @param ctx the IF statement context.
+     * @return min or max, or "" if it isn't a reduction.
+     */
+    string minMaxOperator(PascalParser::IfStatementContext *ctx);
+
+    /**
+     * Whether a subscript is the loop variable plus or minus
+     * integer constants.
+     * @param ctx the subscript expression context.
+     * @param offset set to the sum of the constants if not null.
+     * @return true if so.
+     */
+    bool isLoopOffset(PascalParser::ExpressionContext *ctx,
+                      int *offset = nullptr);
+
+    /**
+     * Whether each iteration has its own slice of an array.
+     * @param references the references to the array.
+     * @return true if so.
+     */
+    bool isPartitioned(const vector<ArrayReference>& references);
+
+    /**
+     * Record a reduction.
+     * @param id the reduction variable.
+     * @param op the reduction operator.
+     */
+    void reduction(SymtabEntry *id, const string& op);
+
+    /**
+     * Get the variable of a variable factor, if it is one.
+     * @param ctx the factor context.
+     * @return the variable's entry, or null.
+     */
+    static SymtabEntry *simpleVariable(PascalParser::FactorContext *ctx);
+
+    /**
+     * Whether an expression is the lone variable factor of a variable.
+     * @param ctx the expression context.
+     * @param id the variable's entry.
+     * @return true if so.
+     */
+    static bool isVariable(PascalParser::SimpleExpressionContext *ctx,
+                           SymtabEntry *id);
+};
+
+}} // namespace backend::converter
+
+#endif /* CONVERTER_LOOPANALYZER_H_ */
@@ -0,0 +1,279 @@
+#include "Runtime.h"
+
+namespace backend { namespace converter {
+
+const char *IO_RUNTIME = R"RUNTIME(#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <unistd.h>
+
+// The program defines _out and _in, and the units it uses
+// define this as extern to share them.
+#ifndef _PASCAL_RUNTIME_STORAGE
+#define _PASCAL_RUNTIME_STORAGE
+#endif
+
+// Buffered standard output. A field width less than zero
+// left-justifies, and the precision is that of printf.
+class _Writer
+{
+public:
+    _Writer() : used(0) {}
+    ~_Writer() { flush(); }
+
+    void flush()
+    {
+        if (used > 0) fwrite(buffer, 1, used, stdout);
+        fflush(stdout);
+        used = 0;
+    }
+
+    _Writer& put(char c)
+    {
+        if (used == SIZE) flush();
+        buffer[used++] = c;
+        return *this;
+    }
+
+    _Writer& put(const char *text, size_t length)
+    {
+        if (used + length > SIZE)
+        {
+            flush();
+            if (length > SIZE)
+            {
+                fwrite(text, 1, length, stdout);
+                return *this;
+            }
+        }
+
+        memcpy(buffer + used, text, length);
+        used += length;
+        return *this;
+    }
+
+    _Writer& put(const char *text) { return put(text, strlen(text)); }
+
+    _Writer& write(int value, int width = 0, int digits = 1)
+    {
+        if (digits > 16) return format(width, "%.*d", digits, value);
+
+        char text[32];
+        char *end = text + sizeof(text);
+        char *p = end;
+        unsigned long magnitude = value < 0 ? 0UL - (unsigned long) value
+                                            : (unsigned long) value;
+
+        while ((magnitude > 0) || (end - p < digits))
+        {
+            *--p = '0' + magnitude%10;
+            magnitude /= 10;
+        }
+        if (value < 0) *--p = '-';
+
+        return field(p, end - p, width);
+    }
+
+    _Writer& write(double value, int width = 0, int places = 6)
+    {
+        char text[48];
+        int length = fixed(value, places, text);
+
+        return length >= 0 ? field(text, length, width)
+                           : format(width, "%.*f", places, value);
+    }
+
+    _Writer& write(char value, int width = 0, int = 0)
+    {
+        return field(&value, 1, width);
+    }
+
+    _Writer& write(bool value, int width = 0, int digits = 1)
+    {
+        return write((int) value, width, digits);
+    }
+
+    _Writer& write(const string& value, int width = 0, int length = -1)
+    {
+        size_t size = value.length();
+        if ((length >= 0) && ((size_t) length < size)) size = length;
+
+        return field(value.data(), size, width);
+    }
+
+private:
+    static const size_t SIZE = 1 << 16;
+
+    char buffer[SIZE];
+    size_t used;
+
+    _Writer& field(const char *text, size_t length, int width)
+    {
+        size_t size = width < 0 ? -width : width;
+        size_t padding = size > length ? size - length : 0;
+
+        if (width > 0) while (padding-- > 0) put(' ');
+        put(text, length);
+        if (width < 0) while (padding-- > 0) put(' ');
+
+        return *this;
+    }
+
+    // Let printf format a value that the fast paths don't handle.
+    template <class T>
+    _Writer& format(int width, const char *spec, int precision, T value)
+    {
+        int length = snprintf(nullptr, 0, spec, precision, value);
+        string text(length + 1, '\0');
+        snprintf(&text[0], text.length(), spec, precision, value);
+
+        return field(text.data(), length, width);
+    }
+
+    // Format a real with integer arithmetic, or return -1 unless
+    // the result is certainly what printf would round it to.
+    static int fixed(double value, int places, char *text)
+    {
+        static const double scales[] =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+            1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+        };
+
+        if ((places < 0) || (places > 15)) return -1;
+
+        double scaled = fabs(value)*scales[places];
+        if (!(scaled < 1e15)) return -1;  // also NaN
+
+        // Stay away from halfway cases, where the rounding error
+        // of the scaling could decide which way to round.
+        double whole = floor(scaled);
+        double fraction = scaled - whole;
+        if (fabs(fraction - 0.5) <= 1e-15*scaled + 1e-9) return -1;
+
+        unsigned long long n = (unsigned long long) whole
+                                                + (fraction > 0.5 ? 1 : 0);
+        char digits[24];
+        int count = 0;
+
+        do
+        {
+            digits[count++] = '0' + n%10;
+            n /= 10;
+        } while ((n > 0) || (count <= places));
+
+        int length = 0;
+        if (signbit(value)) text[length++] = '-';
+
+        for (int i = count - 1; i >= 0; i--)
+        {
+            text[length++] = digits[i];
+            if ((i == places) && (places > 0)) text[length++] = '.';
+        }
+
+        return length;
+    }
+};
+
+_PASCAL_RUNTIME_STORAGE _Writer _out;
+
+// Block-buffered standard input.
+class _Reader
+{
+public:
+    _Reader() : next(0), end(0) {}
+
+    int get()
+    {
+        return (next < end) || fill() ? (unsigned char) buffer[next++] : EOF;
+    }
+
+    int peek()
+    {
+        return (next < end) || fill() ? (unsigned char) buffer[next] : EOF;
+    }
+
+    void read(char& value) { value = (char) get(); }
+
+    void read(int& value)
+    {
+        skipSpace();
+
+        bool negative = false;
+        if ((peek() == '-') || (peek() == '+')) negative = get() == '-';
+
+        long n = 0;
+        while ((peek() >= '0') && (peek() <= '9')) n = 10*n + (get() - '0');
+
+        value = (int) (negative ? -n : n);
+    }
+
+    void read(double& value)
+    {
+        skipSpace();
+
+        string text;
+        int c;
+        while (   ((c = peek()) != EOF)
+               && (isdigit(c) || (strchr("+-.eE", c) != nullptr)))
+        {
+            text += (char) get();
+        }
+
+        value = strtod(text.c_str(), nullptr);
+    }
+
+    void read(string& value)
+    {
+        skipSpace();
+
+        value.clear();
+        int c;
+        while (((c = peek()) != EOF) && !isspace(c)) value += (char) get();
+    }
+
+    void read(bool& value)
+    {
+        string word;
+        read(word);
+        value = word == "true";
+    }
+
+    void skipLine()
+    {
+        int c;
+        while (((c = get()) != EOF) && (c != '\n')) {}
+    }
+
+private:
+    static const size_t SIZE = 1 << 16;
+
+    char buffer[SIZE];
+    size_t next, end;
+
+    bool fill()
+    {
+        _out.flush();  // show any prompt
+
+        ssize_t count;
+        while (((count = ::read(0, buffer, SIZE)) < 0) && (errno == EINTR)) {}
+
+        next = 0;
+        end = count > 0 ? count : 0;
+        return end > 0;
+    }
+
+    void skipSpace()
+    {
+        int c;
+        while (((c = peek()) != EOF) && isspace(c)) next++;
+    }
+};
+
+_PASCAL_RUNTIME_STORAGE _Reader _in;
+)RUNTIME";
+
+}} // namespace backend::converter
@@ -0,0 +1,17 @@
+#ifndef CONVERTER_RUNTIME_H_
+#define CONVERTER_RUNTIME_H_
+
+namespace backend { namespace converter {
+
+/**
+ * The I/O runtime that the converter emits at the top of every program:
+ * _out, a buffered standard output writer with its own integer and
+ * fixed-point formatting, and _in, a block-buffered standard input
+ * scanner that flushes _out before it waits for input. A unit defines
+ * _PASCAL_RUNTIME_STORAGE as extern before it to share the program's.
+ */
+extern const char *IO_RUNTIME;
+
+}} // namespace backend::converter
+
+#endif /* CONVERTER_RUNTIME_H_ */
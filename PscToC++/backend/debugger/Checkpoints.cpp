@@ -0,0 +1,235 @@
+/**
+ * <h1>Checkpoints</h1>
+ *
+ * <p>Checkpoints of the program being debugged, for reverse execution.</p>
+ *
+ * <p>Copyright (c) 2020 by Ronald Mak</p>
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#include "Checkpoints.h"
+
+namespace backend { namespace debugger {
+
+using namespace std;
+
+bool Checkpoints::take(long statementCount, size_t inputLength,
+                       size_t commandCount, Resumption& resumption)
+{
+    int fds[2];
+    pid_t self = getpid();
+    bool resumed = false;
+
+    purge();
+
+    // Don't let the child inherit unwritten output.
+    cout.flush();
+    fflush(stdout);
+
+    pid_t pid = -1;
+    if (pipe(fds) == 0)
+    {
+        pid = fork();
+
+        if (pid < 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+        }
+    }
+
+    if (pid < 0)
+    {
+        cout << "*** Can't take checkpoints: " << strerror(errno) << endl;
+        enabled = false;
+        if (checkpoints.empty()) firstCount = LONG_MAX;
+        return false;
+    }
+
+    // The parent freezes. It returns only in a resumed child.
+    if (pid > 0)
+    {
+        freeze(fds[0], resumption);
+        resumed = true;
+    }
+
+    close(fds[0]);
+    checkpoints.push_back({ statementCount, inputLength, commandCount,
+                            self, fds[1] });
+    if ((int) checkpoints.size() > MAX_CHECKPOINTS) thin();
+
+    return resumed;
+}
+
+bool Checkpoints::resume(long target, const string& input,
+                         const vector<LoggedCommand>& commands)
+{
+    purge();
+    if (checkpoints.empty()) return false;
+
+    // The latest checkpoint at or before the target.
+    int k = checkpoints.size() - 1;
+    while ((k > 0) && (checkpoints[k].statementCount > target)) k--;
+    Checkpoint& checkpoint = checkpoints[k];
+
+    // Write what the resumed process must redo to a file.
+    char path[] = "/tmp/pascal-resume-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return false;
+    close(fd);
+
+    ofstream out(path, ios::binary);
+    out << target << '\n'
+        << input.length() - checkpoint.inputLength << '\n'
+        << input.substr(checkpoint.inputLength);
+    for (size_t i = checkpoint.commandCount; i < commands.size(); i++)
+    {
+        const LoggedCommand& command = commands[i];
+        out << command.statementCount << ' ' << command.event << ' '
+            << command.activation << ' ' << command.text << '\n';
+    }
+    out.close();
+
+    // Tell the checkpoint, then terminate the later checkpoints
+    // and this process. The checkpoint resumes once they're gone.
+    string message = string(path) + '\n';
+    if (write(checkpoint.resumeFd, message.c_str(), message.length()) < 0)
+    {
+        unlink(path);
+        return false;
+    }
+
+    for (int i = k + 1; i < (int) checkpoints.size(); i++)
+    {
+        kill(checkpoints[i].pid, SIGKILL);
+    }
+
+    cout.flush();
+    fflush(stdout);
+    _exit(0);
+}
+
+void Checkpoints::freeze(int resumeFd, Resumption& resumption)
+{
+    // Adopt the descendants of dropped checkpoints.
+    prctl(PR_SET_CHILD_SUBREAPER, 1);
+    fcntl(resumeFd, F_SETFL, O_NONBLOCK);
+
+    int status = 0;
+
+    while (true)
+    {
+        // Wait until every descendant is gone.
+        int childStatus;
+        pid_t pid;
+        while (   ((pid = waitpid(-1, &childStatus, 0)) > 0)
+               || (errno == EINTR))
+        {
+            if (pid > 0) status = childStatus;
+        }
+
+        // The latest resume message, if any.
+        string path;
+        char buffer[256];
+        ssize_t count;
+        string messages;
+        while ((count = read(resumeFd, buffer, sizeof(buffer))) > 0)
+        {
+            messages.append(buffer, count);
+        }
+        istringstream lines(messages);
+        for (string line; getline(lines, line); ) path = line;
+
+        // Not resumed: the program is done.
+        if (path.empty())
+        {
+            _exit(WIFEXITED(status) ? WEXITSTATUS(status)
+                                    : 128 + WTERMSIG(status));
+        }
+
+        // Read what the resumed process must redo.
+        ifstream in(path, ios::binary);
+        size_t inputLength = 0;
+        in >> resumption.target >> inputLength;
+        in.get();
+
+        resumption.input.assign(inputLength, '\0');
+        in.read(&resumption.input[0], inputLength);
+
+        resumption.commands.clear();
+        LoggedCommand command;
+        while (in >> command.statementCount >> command.event
+                  >> command.activation)
+        {
+            in.get();
+            getline(in, command.text);
+            resumption.commands.push_back(command);
+        }
+        in.close();
+        unlink(path.c_str());
+
+        // The resumed process returns. This one stays frozen.
+        pid_t child = fork();
+        if (child == 0) return;
+        if (child < 0) _exit(1);
+    }
+}
+
+void Checkpoints::purge()
+{
+    vector<Checkpoint> live;
+
+    // A checkpoint dropped in another timeline has closed its pipe.
+    for (Checkpoint& checkpoint : checkpoints)
+    {
+        struct pollfd pfd = { checkpoint.resumeFd, 0, 0 };
+
+        if ((poll(&pfd, 1, 0) == 0) || ((pfd.revents & POLLERR) == 0))
+        {
+            live.push_back(checkpoint);
+        }
+        else close(checkpoint.resumeFd);
+    }
+
+    checkpoints = live;
+}
+
+void Checkpoints::thin()
+{
+    vector<Checkpoint> kept;
+    int last = checkpoints.size() - 1;
+
+    for (int i = 0; i <= last; i++)
+    {
+        if ((i == 0) || (i == last) || (i%2 == 0))
+        {
+            kept.push_back(checkpoints[i]);
+        }
+        else
+        {
+            kill(checkpoints[i].pid, SIGKILL);
+            close(checkpoints[i].resumeFd);
+        }
+    }
+
+    checkpoints = kept;
+    interval *= 2;
+}
+
+}}  // namespace backend::debugger
@@ -0,0 +1,309 @@
+/**
+ * <h1>Checkpoints</h1>
+ *
+ * <p>Checkpoints of the program being debugged, for reverse execution.</p>
+ *
+ * <p>Copyright (c) 2020 by Ronald Mak</p>
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef CHECKPOINTS_H_
+#define CHECKPOINTS_H_
+
+#include <iostream>
+#include <streambuf>
+#include <climits>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/types.h>
+
+namespace backend { namespace debugger {
+
+using namespace std;
+
+/**
+ * A stream buffer for the program's input. It records every character
+ * that the program consumes, and it first replays input that was
+ * recorded before going back to a checkpoint. The console input is
+ * read one character at a time with read(2), since characters read
+ * ahead into a user-space buffer would be copied into every checkpoint
+ * and read again after going back to one. Debugger commands are read
+ * through it too, but they aren't recorded.
+ */
+class InputRecorder : public streambuf
+{
+private:
+    int fd;                 // the console input
+    string log;             // every character consumed so far
+    string replay;          // recorded input to consume first
+    size_t replayPosition;
+    int_type peeked;        // read from the console but not consumed
+
+public:
+    /**
+     * Constructor.
+     * @param fd the file descriptor of the console input.
+     */
+    InputRecorder(int fd)
+        : fd(fd), replayPosition(0), peeked(traits_type::eof()) {}
+
+    /**
+     * Getter.
+     * @return every character consumed so far.
+     */
+    const string& getLog() const { return log; }
+
+    /**
+     * Get the input that was read but not yet consumed.
+     * @return the unread replay input and console character, if any.
+     */
+    string getUnread() const
+    {
+        string unread = replay.substr(replayPosition);
+        if (peeked != traits_type::eof())
+        {
+            unread += traits_type::to_char_type(peeked);
+        }
+
+        return unread;
+    }
+
+    /**
+     * Consume recorded input before the console input. A console
+     * character read before the checkpoint is either in the recorded
+     * input or was consumed by a command, so it is forgotten.
+     * @param input the recorded input.
+     */
+    void replayInput(const string& input)
+    {
+        replay = input;
+        replayPosition = 0;
+        peeked = traits_type::eof();
+    }
+
+    /**
+     * Read a line that isn't program input, such as a debugger command.
+     * @param line set to the line without its newline.
+     * @return false at the end of the input, else true.
+     */
+    bool getLine(string& line)
+    {
+        line.clear();
+
+        for (int_type ch = next(); ch != traits_type::eof(); ch = next())
+        {
+            if (ch == '\n') return true;
+            line += traits_type::to_char_type(ch);
+        }
+
+        return !line.empty();
+    }
+
+protected:
+    int_type underflow() override { return peek(); }
+
+    int_type uflow() override
+    {
+        int_type ch = next();
+
+        if (ch != traits_type::eof()) log += traits_type::to_char_type(ch);
+        return ch;
+    }
+
+private:
+    /**
+     * Peek at the next character without consuming it.
+     * @return the character, or eof.
+     */
+    int_type peek()
+    {
+        if (replayPosition < replay.length())
+        {
+            return traits_type::to_int_type(replay[replayPosition]);
+        }
+
+        if (peeked == traits_type::eof())
+        {
+            char ch;
+            ssize_t count;
+
+            do count = read(fd, &ch, 1);
+            while ((count < 0) && (errno == EINTR));
+
+            if (count == 1) peeked = traits_type::to_int_type(ch);
+        }
+
+        return peeked;
+    }
+
+    /**
+     * Consume the next character.
+     * @return the character, or eof.
+     */
+    int_type next()
+    {
+        int_type ch = peek();
+
+        if (replayPosition < replay.length()) replayPosition++;
+        else                                  peeked = traits_type::eof();
+
+        return ch;
+    }
+};
+
+/**
+ * A debugger command that sets breakpoints or watchpoints, and where
+ * execution was stopped when it was entered: at a statement, or at the
+ * nth routine entry or exit since that statement.
+ */
+struct LoggedCommand
+{
+    long statementCount;       // statements executed by then
+    int event;                 // 0 at the statement, else n
+    unsigned long activation;  // of the top stack frame if it watches
+                               // array elements or record fields, else 0
+    string text;               // the command
+};
+
+/**
+ * What a process resumed from a checkpoint must redo.
+ */
+struct Resumption
+{
+    long target;                     // statement count to stop at
+    string input;                    // program input consumed after the
+                                     // checkpoint
+    vector<LoggedCommand> commands;  // debugger commands entered after it
+};
+
+/**
+ * Checkpoints taken by forking. Each checkpoint is a frozen copy of the
+ * whole process, including the runtime stack and the executor's own
+ * call stack, that the kernel shares copy-on-write with the running
+ * program. Only the pages that the program writes after a checkpoint
+ * are copied. The number of checkpoints is bounded: when there are
+ * too many, every other one is dropped and the interval doubles.
+ *
+ * Checkpoints are taken only after recording starts, so a session
+ * that never records runs as a single process. The first checkpoint
+ * is the original process. Every frozen process adopts the descendants
+ * of dropped checkpoints, and when all its descendants are gone it
+ * either exits with the program's status or, if it was asked to,
+ * forks a new process to resume from it.
+ */
+class Checkpoints
+{
+private:
+    /**
+     * A frozen process.
+     */
+    struct Checkpoint
+    {
+        long statementCount;  // statements executed when it was taken
+        size_t inputLength;   // program input consumed by then
+        size_t commandCount;  // debugger commands entered by then
+        pid_t pid;            // the frozen process
+        int resumeFd;         // write end of its resume pipe
+    };
+
+    static const int  MAX_CHECKPOINTS = 16;
+    static const long FIRST_INTERVAL  = 1000;  // statements
+
+    vector<Checkpoint> checkpoints;  // oldest first
+    long interval;                   // statements between checkpoints
+    long firstCount;                 // statement count of the first one
+    bool enabled;                    // true while recording
+
+public:
+    /**
+     * Constructor.
+     */
+    Checkpoints()
+        : interval(FIRST_INTERVAL), firstCount(LONG_MAX), enabled(false) {}
+
+    /**
+     * Start recording. The first checkpoint is taken at a statement
+     * count, and later ones at intervals after it.
+     * @param statementCount the statement count of the first checkpoint.
+     */
+    void record(long statementCount)
+    {
+        firstCount = statementCount;
+        enabled = true;
+    }
+
+    /**
+     * Getter.
+     * @return true if recording, false if not yet or if a fork failed.
+     */
+    bool isRecording() const { return enabled; }
+
+    /**
+     * Getter.
+     * @return the statement count of the first checkpoint, or
+     *         LONG_MAX if recording hasn't started.
+     */
+    long getFirstCount() const { return firstCount; }
+
+    /**
+     * Getter.
+     * @return the statement count of the next checkpoint.
+     */
+    long nextCount() const
+    {
+        return !enabled            ? LONG_MAX
+             : checkpoints.empty() ? firstCount
+             :                       checkpoints.back().statementCount
+                                        + interval;
+    }
+
+    /**
+     * Take a checkpoint. This process freezes as the checkpoint and
+     * a child process returns to continue the program. If execution
+     * later goes back to the checkpoint, another child process returns.
+     * @param statementCount the count of statements executed.
+     * @param inputLength the count of input characters consumed.
+     * @param commandCount the count of debugger commands entered.
+     * @param resumption set if returning in a resumed process.
+     * @return true if returning in a resumed process.
+     */
+    bool take(long statementCount, size_t inputLength, size_t commandCount,
+              Resumption& resumption);
+
+    /**
+     * Go back to the latest checkpoint at or before a statement count.
+     * Later checkpoints and this process are terminated.
+     * @param target the statement count.
+     * @param input all the program input consumed so far.
+     * @param commands all the debugger commands entered so far.
+     * @return false if there is no checkpoint, else doesn't return.
+     */
+    bool resume(long target, const string& input,
+                const vector<LoggedCommand>& commands);
+
+private:
+    /**
+     * Wait as a frozen checkpoint.
+     * @param resumeFd read end of the resume pipe.
+     * @param resumption set when resumed.
+     */
+    void freeze(int resumeFd, Resumption& resumption);
+
+    /**
+     * Forget the checkpoints whose processes are gone. A process
+     * resumed from a checkpoint remembers the earlier checkpoints,
+     * some of which may since have been dropped.
+     */
+    void purge();
+
+    /**
+     * Drop every other checkpoint, except the first and last,
+     * and double the interval.
+     */
+    void thin();
+};
+
+}}  // namespace backend::debugger
+
+#endif /* CHECKPOINTS_H_ */
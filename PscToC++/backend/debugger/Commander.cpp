@@ -10,6 +10,11 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <stdexcept>
+#include <cstdio>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "antlr4-runtime.h"
 #include "PascalBaseVisitor.h"
@@ -32,45 +37,108 @@ using namespace intermediate::symtab;
 using namespace intermediate::type;
 using namespace backend::interpreter;
 
-void Commander::start(ParserRuleContext *ctx)
+void Commander::start(PascalParser::ProgramContext *ctx)
 {
-    readCommands(ctx);
+    indexStatements(ctx, ctx->programHeader()->programIdentifier()->entry);
+    readCommands(ctx->block()->compoundStatement()->getStart()->getLine());
+    updateStopCount();
 }
 
 void Commander::processStatement(PascalParser::StatementContext *ctx)
 {
     int lineNumber = ctx->getStart()->getLine();
 
-    if (singleStepping || breakpoints.find(lineNumber) != breakpoints.end())
+    if (statementCount >= checkpoints.nextCount()) takeCheckpoint();
+
+    eventCount = statementCount;
+    event = 0;
+
+    bool breaks = false;
+    if ((ctx->debugFlags & BREAKPOINT) != 0)
+    {
+        auto it = breakpoints.find(lineNumber);
+        breaks = (it != breakpoints.end()) && hit(it->second);
+    }
+
+    // A replay redoes the commands entered up to here,
+    // and stops only at its target.
+    if (replaying)
+    {
+        redoCommands();
+
+        if (statementCount >= replayTarget)
+        {
+            endReplay();
+            readCommands(lineNumber);
+        }
+    }
+    else if (   (singleStepping && (runtimeStack->records()->size() <= stepDepth))
+             || breaks)
     {
-        readCommands(ctx);
+        readCommands(lineNumber);
     }
+
+    updateStopCount();
 }
 
-void Commander::processAssignment(PascalParser::VariableContext *ctx,
-                                  const Object& value, Typespec *type)
+void Commander::processEntry(SymtabEntry *routineId,
+                             PascalParser::CompoundStatementContext *ctx)
 {
-    if (watchpoints.find(ctx->entry) != watchpoints.end())
+    countEvent();
+    bool breaks = hit(entryBreakpoints[routineId]);
+
+    if (replaying)
+    {
+        redoCommands();
+        updateStopCount();
+    }
+    else if (breaks)
     {
-        printLineNumber(ctx->getStart()->getLine());
-        cout << ": " << ctx->entry->getName() << " <= ";
-        printValue(value, type);
-        cout << endl;
+        readCommands(ctx->getStart()->getLine(),
+                     "Entering " + routineId->getName());
+        updateStopCount();
     }
 }
 
-void Commander::processVariableFactor(PascalParser::VariableContext *ctx,
-                                      const Object& value, Typespec *type)
+void Commander::processExit(SymtabEntry *routineId,
+                            PascalParser::CompoundStatementContext *ctx)
 {
-    if (watchpoints.find(ctx->entry) != watchpoints.end())
+    countEvent();
+    bool breaks = hit(exitBreakpoints[routineId]);
+
+    if (replaying)
+    {
+        redoCommands();
+        updateStopCount();
+    }
+    else if (breaks)
     {
-        printLineNumber(ctx->getStart()->getLine());
-        cout << ": " << ctx->entry->getName() << " :: ";
-        printValue(value, type);
-        cout << endl;
+        readCommands(ctx->getStop()->getLine(),
+                     "Leaving " + routineId->getName());
+        updateStopCount();
     }
 }
 
+void Commander::processAssignment(PascalParser::VariableContext *ctx,
+                                  Cell *cell, const Object& value,
+                                  Typespec *type)
+{
+    printLineNumber(ctx->getStart()->getLine());
+    cout << ": " << watchName(ctx, cell) << " <= ";
+    printValue(value, type);
+    cout << endl;
+}
+
+void Commander::processVariableFactor(PascalParser::VariableContext *ctx,
+                                      Cell *cell, const Object& value,
+                                      Typespec *type)
+{
+    printLineNumber(ctx->getStart()->getLine());
+    cout << ": " << watchName(ctx, cell) << " :: ";
+    printValue(value, type);
+    cout << endl;
+}
+
 Object Commander::visitGoCommand(CommanderParser::GoCommandContext *ctx)
 {
     singleStepping = false;
@@ -80,6 +148,29 @@ Object Commander::visitGoCommand(CommanderParser::GoCommandContext *ctx)
 Object Commander::visitStepCommand(CommanderParser::StepCommandContext *ctx)
 {
     singleStepping = true;
+    stepDepth = SIZE_MAX;
+    return true;
+}
+
+Object Commander::visitNextCommand(CommanderParser::NextCommandContext *ctx)
+{
+    singleStepping = true;
+    stepDepth = runtimeStack->records()->size();
+    return true;
+}
+
+Object Commander::visitFinishCommand(CommanderParser::FinishCommandContext *ctx)
+{
+    size_t depth = runtimeStack->records()->size();
+
+    if (depth <= 1)
+    {
+        cout << "*** Not in a procedure or function." << endl;
+        return false;
+    }
+
+    singleStepping = true;
+    stepDepth = depth - 1;
     return true;
 }
 
@@ -93,32 +184,81 @@ Object Commander::visitQuitCommand(CommanderParser::QuitCommandContext *ctx)
 
 Object Commander::visitBreakCommand(CommanderParser::BreakCommandContext *ctx)
 {
-    // Record the list of breakpoints.
+    // Record the list of unconditional breakpoints.
     if (ctx->lineNumberList() != nullptr)
     {
         for (CommanderParser::LineNumberContext *lineNumberCtx :
                                             ctx->lineNumberList()->lineNumber())
         {
             int lineNumber = stoi(lineNumberCtx->INTEGER()->getText());
-            breakpoints.insert(lineNumber);
+
+            if (flagBreakpoint(lineNumber, true))
+            {
+                breakpoints[lineNumber] = Breakpoint();
+            }
+            else printf("*** No statement at line %03d\n", lineNumber);
         }
     }
-    else
+
+    // Record a breakpoint with a hit count or condition,
+    // or on a routine's entry or exit.
+    else if (ctx->breakpoint() != nullptr) visit(ctx->breakpoint());
+
+    else printBreakpoints();
+
+    return false;
+}
+
+Object Commander::visitBreakpoint(CommanderParser::BreakpointContext *ctx)
+{
+    Breakpoint breakpoint;
+
+    // Line breakpoint.
+    if (ctx->lineNumber() != nullptr)
     {
-        cout << "Breakpoints:";
+        int lineNumber = stoi(ctx->lineNumber()->INTEGER()->getText());
+        auto it = lineRoutines.find(lineNumber);
 
-        // Print the list of breakpoints.
-        if (breakpoints.size() > 0)
+        if (it == lineRoutines.end())
         {
-            for (int lineNumber : breakpoints)
-            {
-                printf(" %03d", lineNumber);
-            }
-            cout << endl;
+            printf("*** No statement at line %03d\n", lineNumber);
+        }
+        else if (createBreakpoint(ctx->breakCondition(), it->second,
+                                  breakpoint))
+        {
+            breakpoints[lineNumber] = move(breakpoint);
+            flagBreakpoint(lineNumber, true);
+        }
+
+        return false;
+    }
+
+    // Routine entry or exit breakpoint.
+    CommanderParser::RoutineEventContext *eventCtx = ctx->routineEvent();
+    string routineName =
+            toLowerCase(eventCtx->routineName()->IDENTIFIER()->getText());
+    auto it = routines.find(routineName);
+
+    if (it == routines.end())
+    {
+        cout << "*** Undeclared routine: " << routineName << endl;
+        return false;
+    }
+
+    SymtabEntry *routineId = it->second;
+
+    if (   (ctx->breakCondition() == nullptr)
+        || createBreakpoint(ctx->breakCondition(), routineId, breakpoint))
+    {
+        if (eventCtx->ENTRY() != nullptr)
+        {
+            entryBreakpoints[routineId] = move(breakpoint);
+            routineId->setDebugFlags(ENTRY_BREAKPOINT);
         }
         else
         {
-            cout << " none" << endl;
+            exitBreakpoints[routineId] = move(breakpoint);
+            routineId->setDebugFlags(EXIT_BREAKPOINT);
         }
     }
 
@@ -133,9 +273,33 @@ Object Commander::visitUnbreakCommand(CommanderParser::UnbreakCommandContext *ct
                                             ctx->lineNumberList()->lineNumber())
         {
             int lineNumber = stoi(lineNumberCtx->INTEGER()->getText());
+
+            flagBreakpoint(lineNumber, false);
             breakpoints.erase(lineNumber);
         }
     }
+    else
+    {
+        CommanderParser::RoutineEventContext *eventCtx = ctx->routineEvent();
+        string routineName =
+                toLowerCase(eventCtx->routineName()->IDENTIFIER()->getText());
+        auto it = routines.find(routineName);
+
+        if (it == routines.end())
+        {
+            cout << "*** Undeclared routine: " << routineName << endl;
+        }
+        else if (eventCtx->ENTRY() != nullptr)
+        {
+            it->second->clearDebugFlags(ENTRY_BREAKPOINT);
+            entryBreakpoints.erase(it->second);
+        }
+        else
+        {
+            it->second->clearDebugFlags(EXIT_BREAKPOINT);
+            exitBreakpoints.erase(it->second);
+        }
+    }
 
     return false;
 }
@@ -217,16 +381,12 @@ Object Commander::visitStackCommand(CommanderParser::StackCommandContext *ctx)
 Object Commander::visitWatchCommand(CommanderParser::WatchCommandContext *ctx)
 {
     // Record the list of watchpoints.
-    if (ctx->simpleVariableList() != nullptr)
+    if (ctx->variableList() != nullptr)
     {
-        for (CommanderParser::SimpleVariableContext *variableCtx :
-                                    ctx->simpleVariableList()->simpleVariable())
+        for (CommanderParser::VariableContext *variableCtx :
+                                            ctx->variableList()->variable())
         {
-            string variableName = variableCtx->IDENTIFIER()->getText();
-            SymtabEntry *id = getSymtabEntry(variableName);
-
-            if (id != nullptr) watchpoints.insert(id);
-            else cout << "*** Undeclared: " + variableName << endl;
+            watch(variableCtx, true);
         }
     }
     else
@@ -234,12 +394,16 @@ Object Commander::visitWatchCommand(CommanderParser::WatchCommandContext *ctx)
         cout << "Watchpoints:";
 
         // Print the list of watchpoints.
-        if (watchpoints.size() > 0)
+        if ((watchpoints.size() > 0) || (cellWatchpoints.size() > 0))
         {
             for (SymtabEntry *id : watchpoints)
             {
                 printf(" %s", id->getName().c_str());
             }
+            for (auto& p : cellWatchpoints)
+            {
+                printf(" %s", p.second.name.c_str());
+            }
             cout << endl;
         }
         else
@@ -253,53 +417,446 @@ Object Commander::visitWatchCommand(CommanderParser::WatchCommandContext *ctx)
 
 Object Commander::visitUnwatchCommand(CommanderParser::UnwatchCommandContext *ctx)
 {
-    // Record the list of watchpoints.
-    if (ctx->simpleVariableList() != nullptr)
+    for (CommanderParser::VariableContext *variableCtx :
+                                            ctx->variableList()->variable())
+    {
+        watch(variableCtx, false);
+    }
+
+    return false;
+}
+
+Object Commander::visitRecordCommand(CommanderParser::RecordCommandContext *ctx)
+{
+    if (checkpoints.isRecording())
+    {
+        cout << "*** Already recording." << endl;
+    }
+    else
+    {
+        // The first checkpoint is at the next statement.
+        checkpoints.record(statementCount + 1);
+    }
+
+    return false;
+}
+
+Object Commander::visitBackCommand(CommanderParser::BackCommandContext *ctx)
+{
+    long count = ctx->statementCount() != nullptr
+                    ? stol(ctx->statementCount()->INTEGER()->getText())
+                    : 1;
+
+    if (statementCount == 0)
+    {
+        cout << "*** At the start of the program." << endl;
+        return false;
+    }
+
+    long first = checkpoints.getFirstCount();
+    if (first == LONG_MAX)
+    {
+        cout << "*** Not recording. Use record first." << endl;
+        return false;
+    }
+
+    // Go back no further than the start of the recording.
+    long target = statementCount - count;
+    if (target < first) target = first;
+
+    if (target >= statementCount)
     {
-        for (CommanderParser::SimpleVariableContext *variableCtx :
-                                    ctx->simpleVariableList()->simpleVariable())
+        cout << "*** At the start of the recording." << endl;
+        return false;
+    }
+
+    // Doesn't return if successful. The input that was read but not
+    // yet consumed is gone from the console, so it's redone too.
+    if (!checkpoints.resume(target,
+                            inputRecorder.getLog() + inputRecorder.getUnread(),
+                            commandLog))
+    {
+        cout << "*** No checkpoint to go back to." << endl;
+    }
+
+    return false;
+}
+
+void Commander::watch(CommanderParser::VariableContext *variableCtx, bool set)
+{
+    string variableName = variableCtx->IDENTIFIER()->getText();
+
+    // Simple variable.
+    if (variableCtx->modifier().empty())
+    {
+        SymtabEntry *id = getSymtabEntry(variableName);
+
+        if (id == nullptr)
         {
-            string variableName = variableCtx->IDENTIFIER()->getText();
-            SymtabEntry *id = getSymtabEntry(variableName);
+            cout << "*** Undeclared: " + variableName << endl;
+        }
+        else if (set)
+        {
+            id->setDebugFlags(WATCHPOINT);
+            watchpoints.insert(id);
+        }
+        else
+        {
+            id->clearDebugFlags(WATCHPOINT);
+            watchpoints.erase(id);
+        }
+
+        return;
+    }
+
+    // Array element or record field.
+    unsigned long activation = 0;
+    Cell *cell = getCellTypePair(variableCtx, &activation).first;
+
+    if (cell == nullptr)
+    {
+        cout << "*** Undeclared or invalid: " << variableCtx->getText() << endl;
+    }
+    else if (set)
+    {
+        cell->setWatched(true);
+        cellWatchpoints[cell] = { variableCtx->getText(), activation };
+    }
+    else
+    {
+        cell->setWatched(false);
+        cellWatchpoints.erase(cell);
+    }
+}
 
-            if (id != nullptr) watchpoints.erase(id);
-            else cout << "*** Undeclared: " + variableName << endl;
+string Commander::watchName(PascalParser::VariableContext *ctx, Cell *cell)
+{
+    if ((cell != nullptr) && cell->isWatched())
+    {
+        auto it = cellWatchpoints.find(cell);
+        if (it != cellWatchpoints.end()) return it->second.name;
+    }
+
+    return ctx->entry->getName();
+}
+
+void Commander::unwatchReturningCells()
+{
+    unsigned long activation = runtimeStack->records()->back()->getActivation();
+
+    for (auto it = cellWatchpoints.begin(); it != cellWatchpoints.end(); )
+    {
+        if (it->second.activation == activation)
+        {
+            it->first->setWatched(false);
+            it = cellWatchpoints.erase(it);
         }
+        else it++;
     }
+}
 
-    return false;
+void Commander::indexStatements(tree::ParseTree *node, SymtabEntry *routineId)
+{
+    PascalParser::RoutineDefinitionContext *routineCtx =
+                dynamic_cast<PascalParser::RoutineDefinitionContext *>(node);
+    PascalParser::StatementContext *stmtCtx =
+                dynamic_cast<PascalParser::StatementContext *>(node);
+
+    if (routineCtx != nullptr)
+    {
+        PascalParser::RoutineIdentifierContext *idCtx =
+                routineCtx->procedureHead() != nullptr
+                    ? routineCtx->procedureHead()->routineIdentifier()
+                    : routineCtx->functionHead()->routineIdentifier();
+
+        routineId = idCtx->entry;
+        routines[routineId->getName()] = routineId;
+    }
+    else if (stmtCtx != nullptr)
+    {
+        int lineNumber = stmtCtx->getStart()->getLine();
+
+        lineStatements[lineNumber].push_back(stmtCtx);
+        lineRoutines.insert(make_pair(lineNumber, routineId));
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        indexStatements(child, routineId);
+    }
 }
 
-void Commander::readCommands(ParserRuleContext *ctx)
+bool Commander::flagBreakpoint(int lineNumber, bool set)
 {
+    auto it = lineStatements.find(lineNumber);
+    if (it == lineStatements.end()) return false;
+
+    for (PascalParser::StatementContext *stmtCtx : it->second)
+    {
+        if (set) stmtCtx->debugFlags |= BREAKPOINT;
+        else     stmtCtx->debugFlags &= ~BREAKPOINT;
+    }
+
+    return true;
+}
+
+bool Commander::createBreakpoint(CommanderParser::BreakConditionContext *ctx,
+                                 SymtabEntry *routineId, Breakpoint& breakpoint)
+{
+    if (ctx->hitCount() != nullptr)
+    {
+        breakpoint.ignoreCount = stoi(ctx->hitCount()->INTEGER()->getText());
+    }
+
+    if (ctx->condition() != nullptr)
+    {
+        // The condition's source text, spaces and all.
+        size_t start = ctx->condition()->getStart()->getStartIndex();
+        size_t stop  = ctx->condition()->getStop()->getStopIndex();
+        string text  = commandText.substr(start, stop - start + 1);
+
+        breakpoint.condition.reset(new Condition(text));
+        return breakpoint.condition->compile(routineId, runtimeStack, executor);
+    }
+
+    return true;
+}
+
+bool Commander::hit(Breakpoint& breakpoint)
+{
+    if (   (breakpoint.condition != nullptr)
+        && !breakpoint.condition->evaluate())
+    {
+        return false;
+    }
+
+    return ++breakpoint.hitCount > breakpoint.ignoreCount;
+}
+
+void Commander::printBreakpoints()
+{
+    cout << "Breakpoints:";
+
+    if (breakpoints.empty() && entryBreakpoints.empty()
+                            && exitBreakpoints.empty())
+    {
+        cout << " none" << endl;
+        return;
+    }
+
+    for (auto& p : breakpoints)
+    {
+        printf(" %03d", p.first);
+        printBreakCondition(p.second);
+    }
+    for (auto& p : entryBreakpoints)
+    {
+        cout << " entry " << p.first->getName();
+        printBreakCondition(p.second);
+    }
+    for (auto& p : exitBreakpoints)
+    {
+        cout << " exit " << p.first->getName();
+        printBreakCondition(p.second);
+    }
+
     cout << endl;
-    printLineNumber(ctx->getStart()->getLine());
-    cout << endl;
+}
 
-    bool resume = false;
+void Commander::printBreakCondition(const Breakpoint& breakpoint)
+{
+    bool after = breakpoint.ignoreCount > 0;
+    bool cond  = breakpoint.condition != nullptr;
 
-    do
+    if (!after && !cond) return;
+
+    cout << " (";
+    if (after) cout << "after " << breakpoint.ignoreCount;
+    if (after && cond) cout << " ";
+    if (cond) cout << "if " << breakpoint.condition->getText();
+    cout << ")";
+}
+
+void Commander::updateStopCount()
+{
+    long next = checkpoints.nextCount();
+
+    // A replay also stops where the next command to redo was entered.
+    if (replaying)
+    {
+        if (replayTarget < next) next = replayTarget;
+        if (   (replayNext < replayCommands.size())
+            && (replayCommands[replayNext].statementCount < next))
+        {
+            next = replayCommands[replayNext].statementCount;
+        }
+    }
+
+    // Statements deeper than the step depth run without stopping
+    // until the routine call at the step depth returns.
+    if (singleStepping && (runtimeStack->records()->size() > stepDepth))
+    {
+        stopCount = next;
+        returnDepth = stepDepth + 1;
+    }
+    else
+    {
+        stopCount = singleStepping ? 0 : next;
+        returnDepth = 0;
+    }
+}
+
+void Commander::takeCheckpoint()
+{
+    Resumption resumption;
+
+    if (checkpoints.take(statementCount, inputRecorder.getLog().length(),
+                         commandLog.size(), resumption))
+    {
+        startReplay(resumption);
+    }
+}
+
+void Commander::startReplay(const Resumption& resumption)
+{
+    replaying = true;
+    replayTarget = resumption.target;
+
+    // Discard the output that was already printed.
+    cout.flush();
+    fflush(stdout);
+    savedStdout = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+
+    inputRecorder.replayInput(resumption.input);
+
+    // The commands are redone where they were entered, so that
+    // breakpoint hit counts and watched cells are as they were then.
+    replayCommands = resumption.commands;
+    replayNext = 0;
+}
+
+void Commander::countEvent()
+{
+    if (eventCount != statementCount)
+    {
+        eventCount = statementCount;
+        event = 0;
+    }
+
+    event++;
+}
+
+void Commander::redoCommands()
+{
+    while (replayNext < replayCommands.size())
+    {
+        const LoggedCommand& command = replayCommands[replayNext];
+
+        if (   (command.statementCount > statementCount)
+            || (   (command.statementCount == statementCount)
+                && (command.event > event)))
+        {
+            break;
+        }
+
+        replayNext++;
+        executeCommand(command.text);
+    }
+}
+
+void Commander::endReplay()
+{
+    // The commands entered after the target are redone here.
+    unsigned long activation = runtimeStack->records()->back()->getActivation();
+
+    for (; replayNext < replayCommands.size(); replayNext++)
+    {
+        const LoggedCommand& command = replayCommands[replayNext];
+
+        if ((command.activation == 0) || (command.activation == activation))
+        {
+            executeCommand(command.text);
+        }
+    }
+
+    replayCommands.clear();
+    replayNext = 0;
+
+    cout.flush();
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+
+    savedStdout = -1;
+    replaying = false;
+}
+
+bool Commander::executeCommand(const string& text)
+{
+    commandText = text + '\n';
+
+    // Point the lexer and parser at the new command.
+    commandInput.load(commandText);
+    commandLexer.setInputStream(&commandInput);
+    commandTokens.setTokenSource(&commandLexer);
+    commandParser.setTokenStream(&commandTokens);
+
+    // Parse the command and visit the parse tree.
+    CommanderParser::CommandContext *commandCtx = commandParser.command();
+    bool resume = visit(commandCtx).as<bool>();
+
+    // Log the commands that set breakpoints and watchpoints, and where
+    // they were entered, to redo them after going back to a checkpoint.
+    if (   (commandCtx->breakCommand()   != nullptr)
+        || (commandCtx->unbreakCommand() != nullptr)
+        || (commandCtx->watchCommand()   != nullptr)
+        || (commandCtx->unwatchCommand() != nullptr))
     {
-        cout << "Command? ";
+        CommanderParser::VariableListContext *listCtx =
+              commandCtx->watchCommand() != nullptr
+                    ? commandCtx->watchCommand()->variableList()
+            : commandCtx->unwatchCommand() != nullptr
+                    ? commandCtx->unwatchCommand()->variableList()
+            : nullptr;
+        bool cells = false;
+
+        if (listCtx != nullptr)
+        {
+            for (CommanderParser::VariableContext *variableCtx :
+                                                        listCtx->variable())
+            {
+                if (!variableCtx->modifier().empty()) cells = true;
+            }
+        }
 
-        string command;
-        getline(cin, command);
-        command += '\n';
+        unsigned long activation =
+                cells ? runtimeStack->records()->back()->getActivation() : 0;
 
-        // Create the character stream from the input string.
-        ANTLRInputStream inputStream(command);
+        commandLog.push_back({ statementCount, event, activation, text });
+    }
 
-        // Create a lexer which scans the character stream
-        // to create a token stream.
-        CommanderLexer lexer(&inputStream);
-        CommonTokenStream tokens(&lexer);
+    return resume;
+}
 
-        // Create a parser which parses the token stream.
-        CommanderParser parser(&tokens);
+void Commander::readCommands(int lineNumber, const string& event)
+{
+    cout << endl;
+    printLineNumber(lineNumber);
+    if (!event.empty()) cout << ": " << event;
+    cout << endl;
+
+    bool resume = false;
 
-        // Parse the command and visit the parse tree.
-        tree::ParseTree *tree = parser.command();
-        resume = visit(tree).as<bool>();
+    do
+    {
+        cout << "Command? " << flush;
+
+        string text;
+        inputRecorder.getLine(text);
+        resume = executeCommand(text);
     } while (!resume);
 }
 
@@ -309,7 +866,8 @@ void Commander::printLineNumber(int lineNumber)
 }
 
 pair<Cell*, Typespec*> Commander::getCellTypePair(
-                                CommanderParser::VariableContext *variableCtx)
+                                CommanderParser::VariableContext *variableCtx,
+                                unsigned long *activation)
 {
     string variableName = variableCtx->IDENTIFIER()->getText();
     int currentLevel = runtimeStack->currentNestingLevel();
@@ -324,6 +882,7 @@ pair<Cell*, Typespec*> Commander::getCellTypePair(
     }
 
     if (cell == nullptr) return make_pair(nullptr, nullptr);
+    if (activation != nullptr) *activation = frame->getActivation();
 
     // Get the variable's datatype.
     SymtabEntry *routineId = frame->getRoutineId();
@@ -337,33 +896,42 @@ pair<Cell*, Typespec*> Commander::getCellTypePair(
         // Subscripts.
         if (modCtx->indexList() != nullptr)
         {
-            if (variableType->getForm() == ARRAY)
+            // Compute a new reference for each subscript.
+            for (CommanderParser::IndexContext *indexCtx :
+                                            modCtx->indexList()->index())
             {
-                // Compute a new reference for each subscript.
-                for (CommanderParser::IndexContext *indexCtx :
-                                                modCtx->indexList()->index())
+                if (variableType->getForm() != ARRAY)
                 {
-                    Typespec *indexType = variableType->getArrayIndexType();
-                    int minIndex = 0;
+                    cout << "*** Not an array." << endl;
+                    return make_pair(nullptr, nullptr);
+                }
+
+                Typespec *indexType = variableType->getArrayIndexType();
+                int minIndex = 0;
+
+                if (indexType->getForm() == SUBRANGE)
+                {
+                    minIndex = indexType->getSubrangeMinValue();
+                }
 
-                    if (indexType->getForm() == SUBRANGE)
-                    {
-                        minIndex = indexType->getSubrangeMinValue();
-                    }
+                string text = indexCtx->INTEGER()->getText();
+                long index = -1;
 
-                    int value = stoi(indexCtx->INTEGER()->getText());
-                    int index = value - minIndex;
+                try
+                {
+                    index = stol(text) - minIndex;
+                }
+                catch (out_of_range& ex) {}
 
-                    vector<Cell *> *array =
-                                        cell->getValue().as<vector<Cell *>*>();
-                    cell = (*array)[index];
-                    variableType = variableType->getArrayElementType();
+                if ((index < 0) || (index >= variableType->getArrayElementCount()))
+                {
+                    cout << "*** Subscript out of range: " << text << endl;
+                    return make_pair(nullptr, nullptr);
                 }
-            }
-            else
-            {
-                cout << "*** Not an array." << endl;
-                return make_pair(nullptr, nullptr);
+
+                vector<Cell *> *array = cell->getValue().as<vector<Cell *>*>();
+                cell = (*array)[index];
+                variableType = variableType->getArrayElementType();
             }
         }
 
@@ -11,16 +11,24 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <memory>
 #include <utility>
+#include <iostream>
+#include <cstdint>
 
 #include "antlr4-runtime.h"
 #include "PascalBaseVisitor.h"
 #include "CommanderBaseVisitor.h"
+#include "CommanderLexer.h"
+#include "CommanderParser.h"
 
 #include "intermediate/symtab/Symtab.h"
 #include "intermediate/symtab/SymtabEntry.h"
 #include "intermediate/symtab/SymtabStack.h"
 #include "backend/interpreter/RuntimeStack.h"
+#include "Condition.h"
+#include "Checkpoints.h"
 
 namespace backend { namespace debugger {
 
@@ -30,66 +38,279 @@ using namespace intermediate::symtab;
 using namespace intermediate::type;
 using namespace backend::interpreter;
 
+// Debugger flag bits of statement contexts.
+constexpr int BREAKPOINT = 0x01;  // stop at the statement
+
+// Debugger flag bits of symbol table entries.
+constexpr int WATCHPOINT       = 0x01;  // trace the variable
+constexpr int ENTRY_BREAKPOINT = 0x02;  // stop on entry to the routine
+constexpr int EXIT_BREAKPOINT  = 0x04;  // stop on exit from the routine
+
+/**
+ * A breakpoint's hit count and condition.
+ */
+struct Breakpoint
+{
+    int ignoreCount = 0;              // hits to pass before stopping
+    int hitCount = 0;                 // hits so far
+    unique_ptr<Condition> condition;  // if set, only true ones are hits
+};
+
+/**
+ * A watched array element or record field.
+ */
+struct CellWatchpoint
+{
+    string name;               // the name to print
+    unsigned long activation;  // of the stack frame it was found in
+};
+
 class Commander : public CommanderBaseVisitor
 {
 private:
     RuntimeStack *runtimeStack;
-    set<int>           breakpoints;
-    set<SymtabEntry *> watchpoints;
+    PascalBaseVisitor *executor;  // executes the program being debugged
+    map<int, Breakpoint>           breakpoints;       // by line number
+    map<SymtabEntry *, Breakpoint> entryBreakpoints;  // by routine
+    map<SymtabEntry *, Breakpoint> exitBreakpoints;   // by routine
+    set<SymtabEntry *> watchpoints;      // watched variables
+    map<Cell *, CellWatchpoint> cellWatchpoints;  // elements and fields
     bool singleStepping;
+    size_t stepDepth;     // deepest runtime stack depth to step at
+    size_t returnDepth;   // depth whose return resumes stepping, or 0
+    long statementCount;  // statements executed so far
+    long stopCount;       // statement count of the next stop to process
+    long eventCount;      // statement count of the latest stop
+    int event;            // routine entries and exits stopped at since it
+
+    // Checkpoints, and what to redo after going back to one.
+    Checkpoints checkpoints;
+    InputRecorder inputRecorder;   // records the program's input
+    istream programInput;          // the program reads from the recorder
+    vector<LoggedCommand> commandLog;  // commands that set debugger state
+    bool replaying;                // true while redoing up to the target
+    long replayTarget;             // statement count to go back to
+    vector<LoggedCommand> replayCommands;  // commands to redo
+    size_t replayNext;             // the next one to redo
+    int savedStdout;               // output is discarded while replaying
+
+    // The statements that start on each source line,
+    // the routine that contains each line, and the routines by name.
+    map<int, vector<PascalParser::StatementContext *>> lineStatements;
+    map<int, SymtabEntry *> lineRoutines;
+    map<string, SymtabEntry *> routines;
+
+    // The lexer and parser are reused for every command.
+    string commandText;
+    ANTLRInputStream commandInput;
+    CommanderLexer commandLexer;
+    CommonTokenStream commandTokens;
+    CommanderParser commandParser;
 
 public:
     /**
      * Constructor
      * @param runtimeStack the runtime stack.
+     * @param executor the executor of the program being debugged.
+     */
+    Commander(RuntimeStack *runtimeStack, PascalBaseVisitor *executor)
+        : runtimeStack(runtimeStack), executor(executor),
+          singleStepping(false), stepDepth(SIZE_MAX), returnDepth(0),
+          statementCount(0), stopCount(0), eventCount(0), event(0),
+          inputRecorder(STDIN_FILENO), programInput(&inputRecorder),
+          replaying(false), replayTarget(0), replayNext(0), savedStdout(-1),
+          commandLexer(&commandInput), commandTokens(&commandLexer),
+          commandParser(&commandTokens)
+    {
+        // Like cin, flush the output before reading the program's input.
+        programInput.tie(&cout);
+    }
+
+    /**
+     * Index the program's statements by line and start reading commands.
+     * @param ctx the program context.
+     */
+    void start(PascalParser::ProgramContext *ctx);
+
+    /**
+     * Count a statement and decide whether to process it.
+     * @param ctx the statement context.
+     * @return true if single stepping, the statement is a breakpoint,
+     *         or it's time for a checkpoint or the end of a replay.
+     */
+    bool stopsAt(PascalParser::StatementContext *ctx)
+    {
+        return (++statementCount >= stopCount) || (ctx->debugFlags != 0);
+    }
+
+    /**
+     * Resume stepping if the returning routine was stepped over or out of.
+     * Until then, its statements run without stopping.
      */
-    Commander(RuntimeStack *runtimeStack)
-        : runtimeStack(runtimeStack), singleStepping(false) {}
+    void returning()
+    {
+        if (runtimeStack->records()->size() == returnDepth) stopCount = 0;
+        if (!cellWatchpoints.empty()) unwatchReturningCells();
+    }
 
     /**
-     * Start reading commands.
-     * @param ctx the current context.
+     * Getter.
+     * @return the stream that the program reads its input from.
      */
-    void start(ParserRuleContext *ctx);
+    istream& getProgramInput() { return programInput; }
 
     /**
-     * Debug a statement if single stepping or the statement is a breakpoint.
+     * Debug a statement that execution stops at.
      * @param ctx the statement context.
      */
     void processStatement(PascalParser::StatementContext *ctx);
 
     /**
-     * Debug an assignment if the target variable is a watchpoint.
+     * Debug entry to a routine that is a breakpoint.
+     * @param routineId the routine's symbol table entry.
+     * @param ctx the routine's compound statement.
+     */
+    void processEntry(SymtabEntry *routineId,
+                      PascalParser::CompoundStatementContext *ctx);
+
+    /**
+     * Debug exit from a routine that is a breakpoint.
+     * @param routineId the routine's symbol table entry.
+     * @param ctx the routine's compound statement.
+     */
+    void processExit(SymtabEntry *routineId,
+                     PascalParser::CompoundStatementContext *ctx);
+
+    /**
+     * Debug an assignment to a watchpoint.
      * @param ctx the target variable context.
+     * @param cell the target memory cell.
      * @param value the value to assign.
+     * @param type the value's datatype.
      */
-    void processAssignment(PascalParser::VariableContext *ctx,
+    void processAssignment(PascalParser::VariableContext *ctx, Cell *cell,
                            const Object& value, Typespec *type);
 
     /**
-     * Debug a variable factor if the variable is a watchpoint.
+     * Debug a variable factor of a watchpoint.
      * @param ctx the variable context.
+     * @param cell the variable's memory cell, or null for a constant.
      * @param value the variable's value.
+     * @param type the value's datatype.
      */
-    void processVariableFactor(PascalParser::VariableContext *ctx,
+    void processVariableFactor(PascalParser::VariableContext *ctx, Cell *cell,
                                const Object& value, Typespec *type);
 
     Object visitGoCommand(CommanderParser::GoCommandContext *ctx);
     Object visitStepCommand(CommanderParser::StepCommandContext *ctx);
+    Object visitNextCommand(CommanderParser::NextCommandContext *ctx);
+    Object visitFinishCommand(CommanderParser::FinishCommandContext *ctx);
     Object visitQuitCommand(CommanderParser::QuitCommandContext *ctx);
     Object visitBreakCommand(CommanderParser::BreakCommandContext *ctx);
     Object visitUnbreakCommand(CommanderParser::UnbreakCommandContext *ctx);
+    Object visitBreakpoint(CommanderParser::BreakpointContext *ctx);
     Object visitShowCommand(CommanderParser::ShowCommandContext *ctx);
     Object visitStackCommand(CommanderParser::StackCommandContext *ctx);
     Object visitWatchCommand(CommanderParser::WatchCommandContext *ctx);
     Object visitUnwatchCommand(CommanderParser::UnwatchCommandContext *ctx);
+    Object visitRecordCommand(CommanderParser::RecordCommandContext *ctx);
+    Object visitBackCommand(CommanderParser::BackCommandContext *ctx);
 
 private:
     /**
-     * Read a debugger command from the console.
-     * @param ctx the current context.
+     * Index the statements and routines of a parse tree.
+     * @param node the root node of the parse tree.
+     * @param routineId the symbol table entry of the containing routine.
+     */
+    void indexStatements(tree::ParseTree *node, SymtabEntry *routineId);
+
+    /**
+     * Set or clear the breakpoint flag of the statements on a line.
+     * @param lineNumber the line number.
+     * @param set true to set the flag, false to clear it.
+     * @return false if no statement starts on the line.
+     */
+    bool flagBreakpoint(int lineNumber, bool set);
+
+    /**
+     * Create a breakpoint with a hit count or condition.
+     * @param ctx the break condition context.
+     * @param routineId the routine whose scope the condition is in.
+     * @param breakpoint the breakpoint to set.
+     * @return false if the condition is invalid.
+     */
+    bool createBreakpoint(CommanderParser::BreakConditionContext *ctx,
+                          SymtabEntry *routineId, Breakpoint& breakpoint);
+
+    /**
+     * Count a hit of a breakpoint if its condition, if any, is true.
+     * @param breakpoint the breakpoint.
+     * @return true if execution should stop.
+     */
+    bool hit(Breakpoint& breakpoint);
+
+    /**
+     * Print the list of breakpoints.
+     */
+    void printBreakpoints();
+
+    /**
+     * Print a breakpoint's hit count and condition, if any.
+     * @param breakpoint the breakpoint.
+     */
+    void printBreakCondition(const Breakpoint& breakpoint);
+
+    /**
+     * Compute the next statement count to process.
+     */
+    void updateStopCount();
+
+    /**
+     * Take a checkpoint, and start a replay if execution
+     * later goes back to it.
+     */
+    void takeCheckpoint();
+
+    /**
+     * Replay execution up to the target statement count, discarding
+     * output. Each debugger command is redone where it was entered.
+     * @param resumption what to redo.
+     */
+    void startReplay(const Resumption& resumption);
+
+    /**
+     * Count a routine entry or exit stop since the latest statement.
+     */
+    void countEvent();
+
+    /**
+     * Redo the commands of a replay that were entered at or before
+     * the current stop.
+     */
+    void redoCommands();
+
+    /**
+     * Restore the output at the end of a replay, and redo the commands
+     * that were entered after the target. A command that watches array
+     * elements or record fields is redone only if the stack frame it
+     * was entered in is on top, since another frame's cells are not
+     * the ones it named.
      */
-    void readCommands(ParserRuleContext *ctx);
+    void endReplay();
+
+    /**
+     * Execute a debugger command.
+     * @param text the command text.
+     * @return true if the command resumes execution.
+     */
+    bool executeCommand(const string& text);
+
+    /**
+     * Read debugger commands from the console until one resumes execution.
+     * @param lineNumber the current line number.
+     * @param event what happened at the line, if anything.
+     */
+    void readCommands(int lineNumber, const string& event = "");
 
     /**
      * Print the current line number.
@@ -100,10 +321,36 @@ private:
     /**
      * Get a variable's cell and datatype from its stack frame.
      * @param variableCtx the variable context.
-     * @return the pair<Cell*, Typespec*>.
+     * @param activation if not null, set to the stack frame's activation.
+     * @return the pair<Cell*, Typespec*>, or a pair of nulls if
+     *         the variable is undeclared or a modifier is invalid.
      */
     pair<Cell*, Typespec*> getCellTypePair(
-                                CommanderParser::VariableContext *variableCtx);
+                                CommanderParser::VariableContext *variableCtx,
+                                unsigned long *activation = nullptr);
+
+    /**
+     * Clear the watchpoints of the cells that were found in
+     * the stack frame of the returning routine.
+     */
+    void unwatchReturningCells();
+
+    /**
+     * Set or clear a watchpoint. A simple variable is watched through
+     * its symbol table entry, in every activation of its routine. An
+     * array element or record field is watched through its memory cell.
+     * @param variableCtx the variable context.
+     * @param set true to set the watchpoint, false to clear it.
+     */
+    void watch(CommanderParser::VariableContext *variableCtx, bool set);
+
+    /**
+     * Get the name to print for a watched variable or memory cell.
+     * @param ctx the variable context.
+     * @param cell the memory cell, or null.
+     * @return the name.
+     */
+    string watchName(PascalParser::VariableContext *ctx, Cell *cell);
 
     /**
      * Get the symbol table entry of a variable.
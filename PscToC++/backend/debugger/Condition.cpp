@@ -0,0 +1,351 @@
+/**
+ * <h1>Condition</h1>
+ *
+ * <p>A breakpoint condition for the debugger.</p>
+ *
+ * <p>Copyright (c) 2020 by Ronald Mak</p>
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <string>
+#include <functional>
+
+#include "antlr4-runtime.h"
+#include "PascalParser.h"
+
+#include "../../Object.h"
+#include "intermediate/symtab/SymtabStack.h"
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/symtab/Predefined.h"
+#include "intermediate/type/Typespec.h"
+#include "frontend/Semantics.h"
+#include "backend/interpreter/Cell.h"
+#include "backend/interpreter/StackFrame.h"
+#include "Condition.h"
+
+namespace backend { namespace debugger {
+
+using namespace std;
+using namespace frontend;
+
+bool Condition::compile(SymtabEntry *routineId, RuntimeStack *runtimeStack,
+                        PascalBaseVisitor *executor)
+{
+    this->runtimeStack = runtimeStack;
+    exprCtx = parser.expression();
+
+    // The expression must be the entire condition.
+    if (   (lexer.getNumberOfSyntaxErrors() > 0)
+        || (parser.getNumberOfSyntaxErrors() > 0)
+        || (exprCtx->getStop() == nullptr)
+        || (exprCtx->getStop()->getStopIndex() + 1 != text.length()))
+    {
+        cout << "*** Invalid condition: " << text << endl;
+        return false;
+    }
+
+    // Check the expression in the routine's scope.
+    SymtabStack symtabStack(routineId);
+    Semantics semantics(&symtabStack);
+    semantics.visit(exprCtx);
+
+    if (semantics.getErrorCount() > 0) return false;
+
+    if (exprCtx->type != Predefined::booleanType)
+    {
+        cout << "*** Condition must be boolean: " << text << endl;
+        return false;
+    }
+
+    Code code = compileExpression(exprCtx);
+
+    if (code.isValid())
+    {
+        function<int()> value = code.integer;
+        predicate = [value] { return value() != 0; };
+    }
+    else
+    {
+        PascalParser::ExpressionContext *ctx = exprCtx;
+        predicate = [executor, ctx] { return executor->visit(ctx).as<bool>(); };
+    }
+
+    return true;
+}
+
+Condition::Code Condition::compileExpression(
+                                        PascalParser::ExpressionContext *ctx)
+{
+    Code code = compileSimpleExpression(ctx->simpleExpression()[0]);
+    PascalParser::RelOpContext *relOpCtx = ctx->relOp();
+
+    if ((relOpCtx == nullptr) || !code.isValid()) return code;
+
+    Code code2 = compileSimpleExpression(ctx->simpleExpression()[1]);
+    if (!code2.isValid()) return Code();
+
+    string op = relOpCtx->getText();
+    Code result;
+
+    if (code.integer && code2.integer)
+    {
+        result.integer = compare<int>(op, code.integer, code2.integer);
+    }
+    else
+    {
+        result.integer = compare<double>(op, realCode(code), realCode(code2));
+    }
+
+    return result;
+}
+
+Condition::Code Condition::compileSimpleExpression(
+                                    PascalParser::SimpleExpressionContext *ctx)
+{
+    Code code = compileTerm(ctx->term()[0]);
+    if (!code.isValid()) return code;
+
+    // Negate the first term.
+    if ((ctx->sign() != nullptr) && (ctx->sign()->getText() == "-"))
+    {
+        if (code.integer)
+        {
+            function<int()> value = code.integer;
+            code.integer = [value] { return -value(); };
+        }
+        else
+        {
+            function<double()> value = code.real;
+            code.real = [value] { return -value(); };
+        }
+    }
+
+    // Loop over the subsequent terms.
+    for (int i = 1; i < (int) ctx->term().size(); i++)
+    {
+        string op = toLowerCase(ctx->addOp()[i-1]->getText());
+        Code code2 = compileTerm(ctx->term()[i]);
+        if (!code2.isValid()) return Code();
+
+        Code result;
+
+        if (code.integer && code2.integer)
+        {
+            function<int()> value1 = code.integer;
+            function<int()> value2 = code2.integer;
+
+            if      (op == "+") result.integer = [=] { return value1() + value2(); };
+            else if (op == "-") result.integer = [=] { return value1() - value2(); };
+            else                result.integer = [=] { return value1() || value2(); };
+        }
+        else
+        {
+            function<double()> value1 = realCode(code);
+            function<double()> value2 = realCode(code2);
+
+            if (op == "+") result.real = [=] { return value1() + value2(); };
+            else           result.real = [=] { return value1() - value2(); };
+        }
+
+        code = result;
+    }
+
+    return code;
+}
+
+Condition::Code Condition::compileTerm(PascalParser::TermContext *ctx)
+{
+    Code code = compileFactor(ctx->factor()[0]);
+    if (!code.isValid()) return code;
+
+    // Loop over the subsequent factors.
+    for (int i = 1; i < (int) ctx->factor().size(); i++)
+    {
+        string op = toLowerCase(ctx->mulOp()[i-1]->getText());
+        Code code2 = compileFactor(ctx->factor()[i]);
+        if (!code2.isValid()) return Code();
+
+        Code result;
+
+        if (code.integer && code2.integer && (op != "/"))
+        {
+            function<int()> value1 = code.integer;
+            function<int()> value2 = code2.integer;
+
+            // Division by zero evaluates to zero.
+            if (op == "*")
+            {
+                result.integer = [=] { return value1()*value2(); };
+            }
+            else if (op == "div")
+            {
+                result.integer = [=] { int divisor = value2();
+                                       return divisor != 0 ? value1()/divisor : 0; };
+            }
+            else if (op == "mod")
+            {
+                result.integer = [=] { int divisor = value2();
+                                       return divisor != 0 ? value1()%divisor : 0; };
+            }
+            else  // and
+            {
+                result.integer = [=] { return value1() && value2(); };
+            }
+        }
+        else
+        {
+            function<double()> value1 = realCode(code);
+            function<double()> value2 = realCode(code2);
+
+            if (op == "*")
+            {
+                result.real = [=] { return value1()*value2(); };
+            }
+            else
+            {
+                result.real = [=] { double divisor = value2();
+                                    return divisor != 0 ? value1()/divisor : 0; };
+            }
+        }
+
+        code = result;
+    }
+
+    return code;
+}
+
+Condition::Code Condition::compileFactor(PascalParser::FactorContext *ctx)
+{
+    Code code;
+
+    if (auto *varCtx = dynamic_cast<PascalParser::VariableFactorContext *>(ctx))
+    {
+        code = compileVariable(varCtx->variable());
+    }
+    else if (dynamic_cast<PascalParser::NumberFactorContext *>(ctx) != nullptr)
+    {
+        if (ctx->type == Predefined::integerType)
+        {
+            int value = stoi(ctx->getText());
+            code.integer = [value] { return value; };
+        }
+        else
+        {
+            double value = stod(ctx->getText());
+            code.real = [value] { return value; };
+        }
+    }
+    else if (dynamic_cast<PascalParser::CharacterFactorContext *>(ctx) != nullptr)
+    {
+        int value = ctx->getText()[1];
+        code.integer = [value] { return value; };
+    }
+    else if (auto *notCtx = dynamic_cast<PascalParser::NotFactorContext *>(ctx))
+    {
+        Code operand = compileFactor(notCtx->factor());
+
+        if (operand.integer)
+        {
+            function<int()> value = operand.integer;
+            code.integer = [value] { return !value(); };
+        }
+    }
+    else if (auto *parenCtx =
+                dynamic_cast<PascalParser::ParenthesizedFactorContext *>(ctx))
+    {
+        code = compileExpression(parenCtx->expression());
+    }
+
+    // Strings and function calls are left to the executor.
+    return code;
+}
+
+Condition::Code Condition::compileVariable(PascalParser::VariableContext *ctx)
+{
+    Code code;
+    SymtabEntry *id = ctx->entry;
+    Typespec *type = ctx->type->baseType();
+    Kind kind = id->getKind();
+
+    if (   (type == Predefined::stringType)
+        || ((type->getForm() != SCALAR) && (type->getForm() != ENUMERATION))
+        || !ctx->modifier().empty())
+    {
+        return code;
+    }
+
+    // A constant's value is compiled in.
+    if ((kind == CONSTANT) || (kind == ENUMERATION_CONSTANT))
+    {
+        try
+        {
+            Object value = id->getValue();
+
+            if (type == Predefined::realType)
+            {
+                double realValue = value.is<int>() ? value.as<int>()
+                                                   : value.as<double>();
+                code.real = [realValue] { return realValue; };
+            }
+            else
+            {
+                int intValue = value.is<char>() ? value.as<char>()
+                             : value.is<bool>() ? value.as<bool>()
+                             :                    value.as<int>();
+                code.integer = [intValue] { return intValue; };
+            }
+        }
+        catch (bad_cast& ex)
+        {
+            code = Code();
+        }
+
+        return code;
+    }
+
+    // A variable's value is read from its memory cell. An uninitialized
+    // value is empty, so casting it throws and evaluate() returns false.
+    shared_ptr<Slot> slot(new Slot(runtimeStack, id->getName(),
+                                   id->getSymtab()->getNestingLevel()));
+
+    if (type == Predefined::realType)
+    {
+        code.real = [slot] { return slot->value().as<double>(); };
+    }
+    else if (type == Predefined::charType)
+    {
+        code.integer = [slot] { return (int) slot->value().as<char>(); };
+    }
+    else if (type == Predefined::booleanType)
+    {
+        code.integer = [slot] { return (int) slot->value().as<bool>(); };
+    }
+    else  // integer or enumeration
+    {
+        code.integer = [slot] { return slot->value().as<int>(); };
+    }
+
+    return code;
+}
+
+function<double()> Condition::realCode(const Code& code)
+{
+    if (code.real) return code.real;
+
+    function<int()> value = code.integer;
+    return [value] { return (double) value(); };
+}
+
+template <typename T>
+function<int()> Condition::compare(const string& op,
+                                   function<T()> left, function<T()> right)
+{
+    if      (op == "=" ) return [=] { return left() == right(); };
+    else if (op == "<>") return [=] { return left() != right(); };
+    else if (op == "<" ) return [=] { return left() <  right(); };
+    else if (op == "<=") return [=] { return left() <= right(); };
+    else if (op == ">" ) return [=] { return left() >  right(); };
+    else                 return [=] { return left() >= right(); };
+}
+
+}}  // namespace backend::debugger
@@ -0,0 +1,176 @@
+/**
+ * <h1>Condition</h1>
+ *
+ * <p>A breakpoint condition for the debugger.</p>
+ *
+ * <p>Copyright (c) 2020 by Ronald Mak</p>
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef CONDITION_H_
+#define CONDITION_H_
+
+#include <string>
+#include <memory>
+#include <typeinfo>
+#include <functional>
+
+#include "antlr4-runtime.h"
+#include "PascalLexer.h"
+#include "PascalParser.h"
+#include "PascalBaseVisitor.h"
+
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/type/Typespec.h"
+#include "backend/interpreter/Cell.h"
+#include "backend/interpreter/StackFrame.h"
+#include "backend/interpreter/RuntimeStack.h"
+
+namespace backend { namespace debugger {
+
+using namespace std;
+using namespace antlr4;
+using namespace intermediate::symtab;
+using namespace intermediate::type;
+using namespace backend::interpreter;
+
+/**
+ * A Pascal boolean expression that is parsed and type-checked once
+ * in the scope of a routine and then compiled into a predicate.
+ * The predicate reads the variables' memory cells directly.
+ * An expression that it can't compile, such as one with a function
+ * call, string, subscript, or record field, is instead evaluated
+ * by the executor. A condition that reads an uninitialized variable
+ * is false.
+ */
+class Condition
+{
+private:
+    /**
+     * Compiled code of an expression. Integer, character, boolean,
+     * and enumeration values are all computed as integers.
+     * Neither function is set if the expression can't be compiled.
+     */
+    struct Code
+    {
+        function<int()>    integer;  // set if the value isn't real
+        function<double()> real;     // set if the value is real
+
+        bool isValid() const { return integer || real; }
+    };
+
+    /**
+     * A variable's memory cell in the topmost stack frame at its
+     * nesting level. The cell is looked up by name only once per
+     * activation of that frame.
+     */
+    struct Slot
+    {
+        RuntimeStack *stack;
+        string name;
+        int level;
+        unsigned long activation;  // activation the cell was found in
+        Cell *cell;
+
+        Slot(RuntimeStack *stack, const string& name, int level)
+            : stack(stack), name(name), level(level),
+              activation(0), cell(nullptr) {}
+
+        const Object& value()
+        {
+            StackFrame *frame = stack->getTopmost(level);
+
+            if (frame->getActivation() != activation)
+            {
+                activation = frame->getActivation();
+                cell = frame->getCell(name);
+            }
+
+            return cell->getValueRef();
+        }
+    };
+
+    string text;                 // the source text of the condition
+    ANTLRInputStream input;      // the parse of the condition, which
+    PascalLexer lexer;           //   must live as long as the condition
+    CommonTokenStream tokens;
+    PascalParser parser;
+    PascalParser::ExpressionContext *exprCtx;
+    RuntimeStack *runtimeStack;  // runtime stack of the executing program
+    function<bool()> predicate;  // the compiled condition
+
+public:
+    /**
+     * Constructor.
+     * @param text the source text of the condition.
+     */
+    Condition(const string& text)
+        : text(text), input(text), lexer(&input), tokens(&lexer),
+          parser(&tokens), exprCtx(nullptr), runtimeStack(nullptr) {}
+
+    /**
+     * Getter.
+     * @return the source text of the condition.
+     */
+    string getText() const { return text; }
+
+    /**
+     * Parse, check, and compile the condition.
+     * @param routineId the symbol table entry of the routine whose scope
+     *                  the condition is evaluated in.
+     * @param runtimeStack the runtime stack.
+     * @param executor the executor to evaluate what can't be compiled.
+     * @return true if successful, else false after printing why not.
+     */
+    bool compile(SymtabEntry *routineId, RuntimeStack *runtimeStack,
+                 PascalBaseVisitor *executor);
+
+    /**
+     * Evaluate the condition.
+     * @return the value of the condition, or false if it
+     *         reads an uninitialized variable.
+     */
+    bool evaluate() const
+    {
+        try
+        {
+            return predicate();
+        }
+        catch (bad_cast& ex)
+        {
+            return false;
+        }
+    }
+
+private:
+    Condition(const Condition&) = delete;
+    Condition& operator =(const Condition&) = delete;
+
+    Code compileExpression(PascalParser::ExpressionContext *ctx);
+    Code compileSimpleExpression(PascalParser::SimpleExpressionContext *ctx);
+    Code compileTerm(PascalParser::TermContext *ctx);
+    Code compileFactor(PascalParser::FactorContext *ctx);
+    Code compileVariable(PascalParser::VariableContext *ctx);
+
+    /**
+     * Get the real-valued code of an expression,
+     * converting an integer value if necessary.
+     * @param code the code of the expression.
+     * @return the real-valued code.
+     */
+    static function<double()> realCode(const Code& code);
+
+    /**
+     * Compile a relational operation.
+     * @param op the operator.
+     * @param left the code of the left operand.
+     * @param right the code of the right operand.
+     * @return the code of the comparison.
+     */
+    template <typename T>
+    static function<int()> compare(const string& op,
+                                   function<T()> left, function<T()> right);
+};
+
+}}  // namespace backend::debugger
+
+#endif /* CONDITION_H_ */
@@ -0,0 +1,97 @@
+/**
+ * <h1>DebugHooks</h1>
+ *
+ * <p>The execution hooks of the debugger.</p>
+ *
+ * <p>Copyright (c) 2020 by Ronald Mak</p>
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef DEBUGHOOKS_H_
+#define DEBUGHOOKS_H_
+
+#include "antlr4-runtime.h"
+#include "PascalParser.h"
+
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/type/Typespec.h"
+#include "backend/interpreter/Cell.h"
+#include "Commander.h"
+
+namespace backend { namespace debugger {
+
+using namespace std;
+using namespace intermediate::symtab;
+using namespace intermediate::type;
+using namespace backend::interpreter;
+
+/**
+ * Each hook tests the flags on the statement, routine, variable,
+ * or memory cell inline and calls the commander only if there is
+ * something to do. The program reads its input through the commander,
+ * which records it for replay after going back to a checkpoint.
+ */
+struct DebugHooks
+{
+    static constexpr bool rangeChecks = true;
+
+    Commander *commander = nullptr;  // debugger command interpreter
+
+    void start(PascalParser::ProgramContext *ctx)
+    {
+        commander->start(ctx);
+    }
+
+    void statement(PascalParser::StatementContext *ctx)
+    {
+        if (commander->stopsAt(ctx)) commander->processStatement(ctx);
+    }
+
+    void enter(SymtabEntry *routineId,
+               PascalParser::CompoundStatementContext *ctx)
+    {
+        if ((routineId->getDebugFlags() & ENTRY_BREAKPOINT) != 0)
+        {
+            commander->processEntry(routineId, ctx);
+        }
+    }
+
+    void leave(SymtabEntry *routineId,
+               PascalParser::CompoundStatementContext *ctx)
+    {
+        if ((routineId->getDebugFlags() & EXIT_BREAKPOINT) != 0)
+        {
+            commander->processExit(routineId, ctx);
+        }
+
+        commander->returning();
+    }
+
+    void assignment(PascalParser::VariableContext *ctx, Cell *cell,
+                    const Object& value, Typespec *type)
+    {
+        if (   cell->isWatched()
+            || ((ctx->entry->getDebugFlags() & WATCHPOINT) != 0))
+        {
+            commander->processAssignment(ctx, cell, value, type);
+        }
+    }
+
+    void variableFactor(PascalParser::VariableContext *ctx, Cell *cell,
+                        const Object& value, Typespec *type)
+    {
+        if (   ((cell != nullptr) && cell->isWatched())
+            || ((ctx->entry->getDebugFlags() & WATCHPOINT) != 0))
+        {
+            commander->processVariableFactor(ctx, cell, value, type);
+        }
+    }
+
+    istream& input()
+    {
+        return commander->getProgramInput();
+    }
+};
+
+}}  // namespace backend::debugger
+
+#endif /* DEBUGHOOKS_H_ */
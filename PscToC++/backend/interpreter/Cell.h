@@ -19,6 +19,7 @@ class Cell
 {
 private:
     Object value = nullptr;  // value contained in the memory cell
+    bool watched = false;    // true if the debugger watches the cell
 
 public:
     /**
@@ -38,11 +39,29 @@ public:
      */
     Object getValue() { return value; }
 
+    /**
+     * Get the value in the cell without copying it.
+     * @return a reference to the value.
+     */
+    const Object& getValueRef() const { return value; }
+
     /**
      * Set a new value into the cell.
      * @param value the new value.
      */
     void setValue(const Object value) { this->value = value; }
+
+    /**
+     * Getter.
+     * @return true if the debugger watches the cell.
+     */
+    bool isWatched() const { return watched; }
+
+    /**
+     * Setter.
+     * @param watched true if the debugger watches the cell.
+     */
+    void setWatched(bool watched) { this->watched = watched; }
 };
 
 }}  // namespace backend::interpreter
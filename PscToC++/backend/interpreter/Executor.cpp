@@ -14,19 +14,22 @@
 #include "intermediate/type/Typespec.h"
 #include "StackFrame.h"
 #include "Executor.h"
+#include "backend/debugger/DebugHooks.h"
 
 namespace backend { namespace interpreter {
 
 using namespace std;
 using namespace std::chrono;
 
-Object Executor::visitProgram(PascalParser::ProgramContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitProgram(PascalParser::ProgramContext *ctx)
 {
     auto start = steady_clock::now();
 
     StackFrame *programFrame = new StackFrame(programId);
     runtimeStack.push(programFrame);
 
+    hooks.start(ctx);
     visit(ctx->block()->compoundStatement());
 
     auto end = steady_clock::now();
@@ -40,36 +43,44 @@ Object Executor::visitProgram(PascalParser::ProgramContext *ctx)
     return nullptr;
 }
 
-Object Executor::visitStatement(PascalParser::StatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitStatement(PascalParser::StatementContext *ctx)
 {
+    hooks.statement(ctx);
+
     executionCount++;
     visitChildren(ctx);
 
     return nullptr;
 }
 
-Object Executor::visitAssignmentStatement(
+template <class Hooks>
+Object Executor<Hooks>::visitAssignmentStatement(
                                 PascalParser::AssignmentStatementContext *ctx)
 {
     PascalParser::ExpressionContext*exprCtx = ctx->rhs()->expression();
     Object value = visit(exprCtx);
+    checkRange(ctx->lhs()->variable()->type, value, exprCtx->type, exprCtx);
     assignValue(ctx->lhs()->variable(), value, exprCtx->type);
 
     return nullptr;
 }
 
-Cell *Executor::assignValue(PascalParser::VariableContext *varCtx,
+template <class Hooks>
+Cell *Executor<Hooks>::assignValue(PascalParser::VariableContext *varCtx,
                             const Object& value, Typespec *valueType)
 {
     Typespec *targetType = varCtx->type;
     Cell *targetCell = visit(varCtx).as<Cell *>();
 
     assignValue(targetCell, targetType, value, valueType);
+    hooks.assignment(varCtx, targetCell, value, valueType);
 
     return targetCell;
 }
 
-void Executor::assignValue(Cell *targetCell, Typespec *targetType,
+template <class Hooks>
+void Executor<Hooks>::assignValue(Cell *targetCell, Typespec *targetType,
                            const Object& value, Typespec *valueType)
 {
     // Assign with any necessary type conversions.
@@ -98,7 +109,23 @@ void Executor::assignValue(Cell *targetCell, Typespec *targetType,
     }
 }
 
-Object Executor::visitIfStatement(PascalParser::IfStatementContext *ctx)
+template <class Hooks>
+void Executor<Hooks>::checkRange(Typespec *targetType, const Object& value,
+                                 Typespec *valueType,
+                                 antlr4::ParserRuleContext *ctx)
+{
+    if (!Hooks::rangeChecks || (targetType->getForm() != SUBRANGE)) return;
+
+    Typespec *baseType = valueType->baseType();
+    int ordinal = (baseType == Predefined::charType)    ? value.as<char>()
+                : (baseType == Predefined::booleanType) ? value.as<bool>()
+                :                                         value.as<int>();
+
+    if (!targetType->inSubrange(ordinal)) error.flag(VALUE_RANGE, ctx);
+}
+
+template <class Hooks>
+Object Executor<Hooks>::visitIfStatement(PascalParser::IfStatementContext *ctx)
 {
     PascalParser::TrueStatementContext  *trueCtx  = ctx->trueStatement();
     PascalParser::FalseStatementContext *falseCtx = ctx->falseStatement();
@@ -110,7 +137,8 @@ Object Executor::visitIfStatement(PascalParser::IfStatementContext *ctx)
     return nullptr;
 }
 
-Object Executor::visitCaseStatement(PascalParser::CaseStatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitCaseStatement(PascalParser::CaseStatementContext *ctx)
 {
     PascalParser::ExpressionContext *exprCtx = ctx->expression();
     PascalParser::CaseBranchListContext *branchListCtx = ctx->caseBranchList();
@@ -142,7 +170,8 @@ Object Executor::visitCaseStatement(PascalParser::CaseStatementContext *ctx)
  * @param branchListCtx the CaseBranchListContext.
  * @return the jump table.
  */
-map<int, PascalParser::StatementContext*> *Executor::createJumpTable(
+template <class Hooks>
+map<int, PascalParser::StatementContext*> *Executor<Hooks>::createJumpTable(
                             PascalParser::CaseBranchListContext *branchListCtx)
 {
     auto *table = new map<int, PascalParser::StatementContext*>();
@@ -169,7 +198,8 @@ map<int, PascalParser::StatementContext*> *Executor::createJumpTable(
     return table;
 }
 
-Object Executor::visitRepeatStatement(PascalParser::RepeatStatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitRepeatStatement(PascalParser::RepeatStatementContext *ctx)
 {
     PascalParser::StatementListContext *listCtx = ctx->statementList();
     Object objValue;
@@ -184,7 +214,8 @@ Object Executor::visitRepeatStatement(PascalParser::RepeatStatementContext *ctx)
     return nullptr;
 }
 
-Object Executor::visitWhileStatement(PascalParser::WhileStatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitWhileStatement(PascalParser::WhileStatementContext *ctx)
 {
     PascalParser::StatementContext *stmtCtx = ctx->statement();
     bool value = visit(ctx->expression()).as<bool>();
@@ -198,7 +229,8 @@ Object Executor::visitWhileStatement(PascalParser::WhileStatementContext *ctx)
     return nullptr;
 }
 
-Object Executor::visitForStatement(PascalParser::ForStatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitForStatement(PascalParser::ForStatementContext *ctx)
 {
     PascalParser::VariableContext *controlCtx = ctx->variable();
     PascalParser::ExpressionContext *startExprCtx = ctx->expression()[0];
@@ -206,9 +238,11 @@ Object Executor::visitForStatement(PascalParser::ForStatementContext *ctx)
 
     // Initial value.
     Object startValue = visit(startExprCtx);
+    checkRange(controlCtx->type, startValue, startExprCtx->type, startExprCtx);
     assignValue(controlCtx, startValue, startExprCtx->type);
 
-    // Terminal value.
+    // Terminal value. If the loop runs and both it and the initial value
+    // are in range, so is every value of the control variable.
     bool to = ctx->TO() != nullptr;
     Object stopValue = visit(stopExprCtx);
     
@@ -217,6 +251,12 @@ Object Executor::visitForStatement(PascalParser::ForStatementContext *ctx)
     {
         int control = startValue.as<int>();
         int stop    = stopValue.as<int>();
+
+        if (to ? control <= stop : control >= stop)
+        {
+            checkRange(controlCtx->type, stopValue, stopExprCtx->type,
+                       stopExprCtx);
+        }
         
         if (to)
         {
@@ -243,6 +283,12 @@ Object Executor::visitForStatement(PascalParser::ForStatementContext *ctx)
     {
         char control = startValue.as<char>();
         char stop    = stopValue.as<char>();
+
+        if (to ? control <= stop : control >= stop)
+        {
+            checkRange(controlCtx->type, stopValue, stopExprCtx->type,
+                       stopExprCtx);
+        }
         
         if (to)
         {
@@ -267,7 +313,8 @@ Object Executor::visitForStatement(PascalParser::ForStatementContext *ctx)
     return nullptr;
 }
 
-Object Executor::visitProcedureCallStatement(
+template <class Hooks>
+Object Executor<Hooks>::visitProcedureCallStatement(
                             PascalParser::ProcedureCallStatementContext *ctx)
 {
     SymtabEntry *routineId = ctx->procedureName()->entry;
@@ -293,7 +340,9 @@ Object Executor::visitProcedureCallStatement(
     Object stmtObj = routineId->getExecutable();
     PascalParser::CompoundStatementContext *stmtCtx =
                     stmtObj.as<PascalParser::CompoundStatementContext *>();
+    hooks.enter(routineId, stmtCtx);
     visit(stmtCtx);
+    hooks.leave(routineId, stmtCtx);
 
     // Pop off the routine's stack frame.
     runtimeStack.pop();
@@ -301,7 +350,8 @@ Object Executor::visitProcedureCallStatement(
     return nullptr;
 }
 
-void Executor::executeCallArguments(PascalParser::ArgumentListContext *argListCtx,
+template <class Hooks>
+void Executor<Hooks>::executeCallArguments(PascalParser::ArgumentListContext *argListCtx,
                                     vector<SymtabEntry*> *parameters,
                                     StackFrame *frame)
 {
@@ -318,6 +368,8 @@ void Executor::executeCallArguments(PascalParser::ArgumentListContext *argListCt
         // Value parameter: Copy the argument's value.
         if (parmKind == VALUE_PARAMETER)
         {
+            checkRange(parmId->getType(), value,
+                       argCtx->expression()->type, argCtx);
             assignValue(parmCell, parmId->getType(),
                         value, argCtx->expression()->type);
         }
@@ -331,13 +383,14 @@ void Executor::executeCallArguments(PascalParser::ArgumentListContext *argListCt
             PascalParser::VariableContext *varCtx =
                 ((PascalParser::VariableFactorContext *) factorCtx)->variable();
             
-            Cell *argCell = visitVariable(varCtx).as<Cell*>();
+            Cell *argCell = visit(varCtx).as<Cell *>();
             frame->replaceCell(parmName, argCell);
         }
     }
 }
 
-Object Executor::visitExpression(PascalParser::ExpressionContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitExpression(PascalParser::ExpressionContext *ctx)
 {
     PascalParser::SimpleExpressionContext *simpleCtx1 =
                                                     ctx->simpleExpression()[0];
@@ -428,7 +481,8 @@ Object Executor::visitExpression(PascalParser::ExpressionContext *ctx)
     return operand1;
 }
 
-Object Executor::visitSimpleExpression(PascalParser::SimpleExpressionContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitSimpleExpression(PascalParser::SimpleExpressionContext *ctx)
 {
     {
         int count = ctx->term().size();
@@ -512,7 +566,8 @@ Object Executor::visitSimpleExpression(PascalParser::SimpleExpressionContext *ct
     }
 }
 
-Object Executor::visitTerm(PascalParser::TermContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitTerm(PascalParser::TermContext *ctx)
 {
     int count = ctx->factor().size();
 
@@ -603,7 +658,8 @@ Object Executor::visitTerm(PascalParser::TermContext *ctx)
     return operand1;
 }
 
-Object Executor::visitVariableFactor(PascalParser::VariableFactorContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitVariableFactor(PascalParser::VariableFactorContext *ctx)
 {
     PascalParser::VariableContext *varCtx = ctx->variable();
     Kind kind = varCtx->entry->getKind();
@@ -618,6 +674,7 @@ Object Executor::visitVariableFactor(PascalParser::VariableFactorContext *ctx)
             value = value.as<int>() != 0;
         }
 
+        hooks.variableFactor(varCtx, nullptr, value, varCtx->type);
         return value;
     }
 
@@ -627,13 +684,15 @@ Object Executor::visitVariableFactor(PascalParser::VariableFactorContext *ctx)
         Cell *variableCell = visit(varCtx).as<Cell *>();
 
         Object value = variableCell->getValue();
+        if (ctx->type == Predefined::stringType) value = *(value.as<string *>());
 
-        if (ctx->type == Predefined::stringType) return *(value.as<string *>());
-        else                                     return value;
+        hooks.variableFactor(varCtx, variableCell, value, varCtx->type);
+        return value;
     }
 }
 
-Object Executor::visitVariable(PascalParser::VariableContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitVariable(PascalParser::VariableContext *ctx)
 {
     SymtabEntry *variableId = ctx->entry;
     string variableName = variableId->getName();
@@ -665,6 +724,15 @@ Object Executor::visitVariable(PascalParser::VariableContext *ctx)
                 int value = visit(indexCtx->expression()).as<int>();
                 int index = value - minIndex;
 
+                // Below the minimum wraps around past the element count.
+                if (   Hooks::rangeChecks
+                    && (   (unsigned) value - (unsigned) minIndex
+                        >= (unsigned) variableType->getArrayElementCount()))
+                {
+                    error.flag(VALUE_RANGE, indexCtx);
+                    index = 0;  // continue with the first element
+                }
+
                 vector<Cell *> *array =
                                 variableCell->getValue().as<vector<Cell *>*>();
                 variableCell = (*array)[index];
@@ -689,7 +757,8 @@ Object Executor::visitVariable(PascalParser::VariableContext *ctx)
     return variableCell;
 }
 
-Object Executor::visitNumberFactor(PascalParser::NumberFactorContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitNumberFactor(PascalParser::NumberFactorContext *ctx)
 {
     Typespec *type = ctx->type;
 
@@ -703,18 +772,21 @@ Object Executor::visitNumberFactor(PascalParser::NumberFactorContext *ctx)
     }
 }
 
-Object Executor::visitCharacterFactor(PascalParser::CharacterFactorContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitCharacterFactor(PascalParser::CharacterFactorContext *ctx)
 {
     return ctx->getText()[1];
 }
 
-Object Executor::visitStringFactor(PascalParser::StringFactorContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitStringFactor(PascalParser::StringFactorContext *ctx)
 {
     string pascalString = ctx->stringConstant()->STRING()->getText();
     return convertString(pascalString, false);
 }
 
-Object Executor::visitFunctionCallFactor(
+template <class Hooks>
+Object Executor<Hooks>::visitFunctionCallFactor(
                                 PascalParser::FunctionCallFactorContext *ctx)
 {
     PascalParser::FunctionCallContext *callCtx = ctx->functionCall();
@@ -741,7 +813,9 @@ Object Executor::visitFunctionCallFactor(
     Object stmtObj = routineId->getExecutable();
     PascalParser::CompoundStatementContext *stmtCtx =
                     stmtObj.as<PascalParser::CompoundStatementContext *>();
+    hooks.enter(routineId, stmtCtx);
     visit(stmtCtx);
+    hooks.leave(routineId, stmtCtx);
 
     // Get the function value from its associated variable.
     string functionName = routineId->getName();
@@ -754,19 +828,22 @@ Object Executor::visitFunctionCallFactor(
     return functionValue;
 }
 
-Object Executor::visitNotFactor(PascalParser::NotFactorContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitNotFactor(PascalParser::NotFactorContext *ctx)
 {
     bool value = visit(ctx->factor()).as<bool>();
     return !value;
 }
 
-Object Executor::visitParenthesizedFactor(
+template <class Hooks>
+Object Executor<Hooks>::visitParenthesizedFactor(
                                 PascalParser::ParenthesizedFactorContext *ctx)
 {
     return visit(ctx->expression());
 }
 
-Object Executor::visitWritelnStatement(PascalParser::WritelnStatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitWritelnStatement(PascalParser::WritelnStatementContext *ctx)
 {
     visitChildren(ctx);
     cout << endl;
@@ -774,7 +851,8 @@ Object Executor::visitWritelnStatement(PascalParser::WritelnStatementContext *ct
     return nullptr;
 }
 
-Object Executor::visitWriteArguments(PascalParser::WriteArgumentsContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitWriteArguments(PascalParser::WriteArgumentsContext *ctx)
 {
     // Loop over each argument.
     for (PascalParser::WriteArgumentContext *argCtx : ctx->writeArgument())
@@ -844,56 +922,72 @@ Object Executor::visitWriteArguments(PascalParser::WriteArgumentsContext *ctx)
     return nullptr;
 }
 
-Object Executor::visitReadlnStatement(PascalParser::ReadlnStatementContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitReadlnStatement(PascalParser::ReadlnStatementContext *ctx)
 {
     visitChildren(ctx);
-    cin.ignore(4096, '\n');
+    hooks.input().ignore(4096, '\n');
 
     return nullptr;
 }
 
-Object Executor::visitReadArguments(PascalParser::ReadArgumentsContext *ctx)
+template <class Hooks>
+Object Executor<Hooks>::visitReadArguments(PascalParser::ReadArgumentsContext *ctx)
 {
     int size = ctx->variable().size();
+    istream& input = hooks.input();
 
     // Loop over read arguments.
     for (int i = 0; i < size; i++)
     {
         PascalParser::VariableContext *varCtx = ctx->variable()[i];
         Typespec *varType = varCtx->type;
-        
-        if (varType == Predefined::integerType)
+
+        // A subrange variable reads a value of its base type.
+        Typespec *baseType = varType->baseType();
+        Object value;
+
+        if (baseType == Predefined::integerType)
         {
-            int value;
-            cin >> value;
-            assignValue(varCtx, value, Predefined::integerType);
+            int intValue;
+            input >> intValue;
+            value = intValue;
         }
-        else if (varType == Predefined::realType)
+        else if (baseType == Predefined::realType)
         {
-            double value;
-            cin >> value;
-            assignValue(varCtx, value, Predefined::realType);
+            double realValue;
+            input >> realValue;
+            value = realValue;
         }
-        else if (varType == Predefined::booleanType)
+        else if (baseType == Predefined::booleanType)
         {
-            bool value;
-            cin >> boolalpha >> value;
-            assignValue(varCtx, value, Predefined::booleanType);
+            bool boolValue;
+            input >> boolalpha >> boolValue;
+            value = boolValue;
         }
-        else if (varType == Predefined::charType)
+        else if (baseType == Predefined::charType)
         {
-            char value = getchar();
-            assignValue(varCtx, value, Predefined::charType);
+            char charValue = input.get();
+            value = charValue;
         }
         else  // string
         {
-            string value;
-            cin >> value;
-            assignValue(varCtx, value, Predefined::stringType);
+            string stringValue;
+            input >> stringValue;
+            value = stringValue;
+            baseType = Predefined::stringType;
         }
+
+        checkRange(varType, value, baseType, varCtx);
+        assignValue(varCtx, value, baseType);
     }
 
     return nullptr;
 }
 
-}} // namespace backend::converter
+// The interpreter, with and without range checks, and the debugger.
+template class Executor<NoHooks>;
+template class Executor<UncheckedHooks>;
+template class Executor<backend::debugger::DebugHooks>;
+
+}} // namespace backend::interpreter
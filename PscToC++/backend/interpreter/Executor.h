@@ -1,6 +1,8 @@
 #ifndef EXECUTOR_H_
 #define EXECUTOR_H_
 
+#include <iostream>
+
 #include "PascalBaseVisitor.h"
 #include "antlr4-runtime.h"
 
@@ -16,16 +18,58 @@ using namespace std;
 using namespace intermediate::symtab;
 using namespace intermediate::type;
 
+/**
+ * The hooks of the plain interpreter. They are all empty,
+ * so the compiler removes every call to them.
+ */
+struct NoHooks
+{
+    static constexpr bool rangeChecks = true;
+
+    void start(PascalParser::ProgramContext *ctx) {}
+    void statement(PascalParser::StatementContext *ctx) {}
+    void enter(SymtabEntry *routineId,
+               PascalParser::CompoundStatementContext *ctx) {}
+    void leave(SymtabEntry *routineId,
+               PascalParser::CompoundStatementContext *ctx) {}
+    void assignment(PascalParser::VariableContext *ctx, Cell *cell,
+                    const Object& value, Typespec *type) {}
+    void variableFactor(PascalParser::VariableContext *ctx, Cell *cell,
+                        const Object& value, Typespec *type) {}
+    istream& input() { return cin; }
+};
+
+/**
+ * The hooks of the interpreter without subrange and array index
+ * checks, for runs that need the speed more than the checks.
+ */
+struct UncheckedHooks : NoHooks
+{
+    static constexpr bool rangeChecks = false;
+};
+
 /**
  * Execute Pascal programs.
+ *
+ * The interpreter and the debugger share this engine. The Hooks
+ * policy is called at program start, at each statement, on entry to
+ * and exit from each routine, at each assignment, and at each
+ * variable read, and it supplies the stream that read and readln
+ * statements read from. Its rangeChecks constant decides at compile
+ * time whether values assigned to subrange variables and array
+ * subscripts are checked. The interpreter uses NoHooks, or
+ * UncheckedHooks with -nocheck, and the debugger uses DebugHooks.
+ * They are all explicitly instantiated in Executor.cpp.
  */
+template <class Hooks>
 class Executor : public PascalBaseVisitor
 {
-private:
+protected:
     int executionCount;         // count of executed statements
     SymtabEntry *programId;     // program identifier's symbol table entry
     RuntimeStack runtimeStack;  // runtime stack
     RuntimeErrorHandler error;  // runtime error handler
+    Hooks hooks;                // execution hooks
 
 public:
     Executor(SymtabEntry *programId) : executionCount(0), programId(programId) {}
@@ -76,6 +120,17 @@ private:
     void assignValue(Cell *targetCell, Typespec *targetType,
                      const Object& value, Typespec *valueType);
 
+    /**
+     * Flag a value that is out of the range of a subrange target,
+     * if the hooks ask for range checks.
+     * @param targetType the datatype of the target.
+     * @param value the value.
+     * @param valueType the datatype of the value.
+     * @param ctx the node to flag the error at.
+     */
+    void checkRange(Typespec *targetType, const Object& value,
+                    Typespec *valueType, antlr4::ParserRuleContext *ctx);
+
     /**
      * Create the jump table for a CASE statement.
      * @param branchListCtx the CaseBranchListContext.
@@ -93,10 +93,8 @@ public:
      */
     MemoryMap(Symtab *symtab)
     {
-        vector<SymtabEntry *> entries = symtab->sortedEntries();
-
         // Loop for each entry of the symbol table.
-        for (SymtabEntry *entry : entries)
+        for (SymtabEntry *entry : symtab->entries())
         {
             Kind kind = entry->getKind();
 
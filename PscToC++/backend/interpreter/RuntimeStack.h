@@ -21,12 +21,13 @@ class RuntimeStack
 private:
     vector<StackFrame *> stack;  // runtime stack
     RuntimeDisplay *display;     // runtime display
+    unsigned long activations;   // count of pushed stack frames
 
 public:
     /**
      * Constructor.
      */
-    RuntimeStack() : display(new RuntimeDisplay()) {}
+    RuntimeStack() : display(new RuntimeDisplay()), activations(0) {}
 
     /**
      * Destructor.
@@ -69,6 +70,7 @@ public:
     {
         int nestingLevel = frame->getNestingLevel();
 
+        frame->setActivation(++activations);
         stack.push_back(frame);
         display->callUpdate(nestingLevel, frame);
     }
@@ -28,6 +28,7 @@ private:
     SymtabEntry *routineId;  // symbol table entry of the routine's name
     int nestingLevel;        // scope nesting level of this stack frame
     MemoryMap *memoryMap;    // memory map of this stack frame
+    unsigned long activation;  // serial number of the push, if pushed
 
 public:
     /**
@@ -35,7 +36,7 @@ public:
      * @param routineId the symbol table entry of the routine's name.
      */
     StackFrame(SymtabEntry *routineId)
-        : backlink(nullptr), routineId(routineId)
+        : backlink(nullptr), routineId(routineId), activation(0)
     {
         Symtab *symtab = routineId->getRoutineSymtab();
         nestingLevel = symtab->getNestingLevel();
@@ -58,7 +59,7 @@ public:
      * @param name the name.
      * @return the cell.
      */
-    Cell *getCell(string& name) { return memoryMap->getCell(name); }
+    Cell *getCell(const string& name) { return memoryMap->getCell(name); }
 
     /**
      * Replace the memory cell with the given name in the memory map.
@@ -85,6 +86,22 @@ public:
      */
     int getNestingLevel() const { return nestingLevel; }
 
+    /**
+     * Get the activation serial number. Unlike the frame's address,
+     * it is never reused by a later frame.
+     * @return the number, or 0 if the frame hasn't been pushed.
+     */
+    unsigned long getActivation() const { return activation; }
+
+    /**
+     * Set the activation serial number.
+     * @param activation the number.
+     */
+    void setActivation(unsigned long activation)
+    {
+        this->activation = activation;
+    }
+
     /**
      * Get the stack frame to which this frame is dynamically linked.
      * @return the link.
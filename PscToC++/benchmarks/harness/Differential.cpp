@@ -0,0 +1,523 @@
+/**
+ * <h1>Differential</h1>
+ *
+ * <p>Run each Pascal program through the interpreter (-execute) and as
+ * a native build (-compile), compare what the two print, and record how
+ * many times faster the native build runs. The program output of both
+ * engines is also compared against checked-in expected output, and
+ * against the output of a checked-in conversion of the program, since
+ * a bug that the two engines share would otherwise go unnoticed.</p>
+ *
+ * <p>Build and run from the PscToC++ directory:</p>
+ *
+ * <pre>
+ *   c++ -std=c++11 -O2 -o benchmarks/harness/Differential \
+ *       benchmarks/harness/Differential.cpp
+ *   benchmarks/harness/Differential --record  # store the expected outputs
+ *   benchmarks/harness/Differential           # check against them
+ * </pre>
+ *
+ * <p>Options:</p>
+ *
+ * <pre>
+ *   --pascal PATH      the PascalCpp executable (Release/PscToC++)
+ *   --programs DIR     a directory of programs; may be repeated
+ *                      (benchmarks/programs and .)
+ *   --expected DIR     the expected outputs (benchmarks/expected)
+ *   --reference DIR    the checked-in conversions (C++)
+ *   --cxx COMPILER     to build the checked-in conversions ($CXX or c++)
+ *   --option OPTION    a -compile option such as -vectorize; may be repeated
+ *   --runs N           measured runs of each program in each engine (3)
+ *   --output FILE      where to write the results (differential-results.json)
+ *   --record           store the output of each program on which the two
+ *                      engines agree as its expected output
+ *   NAME ...           only these programs, by name without ".pas"
+ * </pre>
+ *
+ * <p>A program NAME.pas reads NAME.in from its directory, if there is one,
+ * as its standard input. Its expected output is NAME.out in the expected
+ * directory, and its checked-in conversion, if any, is NAME.cpp in the
+ * reference directory. A program whose engines disagree with either
+ * isn't recorded. The exit status is 1 if any program failed or if any
+ * output differed.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Process.h"
+#include "Stats.h"
+#include "Json.h"
+
+using namespace std;
+using namespace benchmarks;
+
+/**
+ * Differential settings.
+ */
+struct Settings
+{
+    string pascal      = "Release/PscToC++";
+    vector<string> programsDirs;
+    string expectedDir = "benchmarks/expected";
+    string referenceDir = "C++";
+    string cxx         = getenv("CXX") != nullptr ? getenv("CXX") : "c++";
+    vector<string> options;
+    int runs           = 3;
+    string outputFile  = "differential-results.json";
+    bool record        = false;
+    vector<string> names;
+};
+
+/**
+ * A program to compare.
+ */
+struct Program
+{
+    string name;
+    string sourcePath;  // absolute
+    string input;       // its standard input
+};
+
+/**
+ * The comparison of one program.
+ */
+struct Comparison
+{
+    string program;
+    string verdict = "match";  // match, mismatch, unexpected, or failed
+    string detail;
+    string output;             // the interpreter's program output
+    vector<double> interpretedMs;
+    vector<double> nativeMs;
+
+    double ratio() const
+    {
+        double native = median(nativeMs);
+        return native > 0 ? median(interpretedMs)/native : 0;
+    }
+};
+
+/**
+ * Read a whole file.
+ * @param path the file path.
+ * @param text set to the contents.
+ * @return true if read.
+ */
+static bool readFile(const string& path, string& text)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return false;
+
+    stringstream contents;
+    contents << in.rdbuf();
+    text = contents.str();
+
+    return true;
+}
+
+/**
+ * Extract the program output from the interpreter's output, which
+ * surrounds it with the pass messages and the execution statistics.
+ * @param text the interpreter's output.
+ * @param output set to the program output.
+ * @return true if found.
+ */
+static bool interpretedOutput(const string& text, string& output)
+{
+    const string marker = "PASS 3 Execution:\n\n";
+    size_t start = text.find(marker);
+    size_t stats = text.rfind(" statements executed.");
+    if ((start == string::npos) || (stats == string::npos)) return false;
+
+    // The statistics follow a line feed of their own.
+    start += marker.length();
+    size_t end = text.rfind('\n', stats);
+    if ((end == string::npos) || (end < start)) return false;
+
+    output = text.substr(start, end - start);
+    return true;
+}
+
+/**
+ * Extract the program output from a native build's output,
+ * which ends with the execution time.
+ * @param text the native build's output.
+ * @param output set to the program output.
+ * @return true if found.
+ */
+static bool nativeOutput(const string& text, string& output)
+{
+    size_t end = text.rfind("\n[");
+    if (   (end == string::npos)
+        || (text.find("milliseconds execution time.]", end) == string::npos))
+    {
+        return false;
+    }
+
+    output = text.substr(0, end);
+    return true;
+}
+
+/**
+ * Describe the first difference between two outputs.
+ * @param expected the expected output.
+ * @param actual the actual output.
+ * @return the line number and both versions of the line.
+ */
+static string firstDifference(const string& expected, const string& actual)
+{
+    istringstream a(expected), b(actual);
+    string lineA, lineB;
+    int number = 0;
+
+    while (true)
+    {
+        bool moreA = (bool) getline(a, lineA);
+        bool moreB = (bool) getline(b, lineB);
+        number++;
+
+        if (!moreA && !moreB) return "outputs differ in their final newline";
+        if (!moreA) lineA = "<end of output>";
+        if (!moreB) lineB = "<end of output>";
+
+        if (!moreA || !moreB || (lineA != lineB))
+        {
+            return "line " + to_string(number) + ": \"" + lineA
+                                           + "\" vs. \"" + lineB + "\"";
+        }
+    }
+}
+
+/**
+ * Compare a program's two executions.
+ * @param settings the settings.
+ * @param program the program.
+ * @param c the comparison to fill.
+ */
+static void compare(const Settings& settings, const Program& program,
+                    Comparison& c)
+{
+    // Interpret.
+    string interpreted;
+    for (int run = 0; run < settings.runs; run++)
+    {
+        ProcessResult result = runProcess(
+                { settings.pascal, "-execute", program.sourcePath },
+                program.input);
+        long execMs;
+
+        if (   !result.succeeded()
+            || !interpretedOutput(result.output, interpreted)
+            || !findCount(result.output, "milliseconds execution time.",
+                          execMs))
+        {
+            c.verdict = "failed";
+            c.detail = "interpreter failed";
+            return;
+        }
+
+        c.interpretedMs.push_back(execMs);
+    }
+    c.output = interpreted;
+
+    // Build natively in a scratch directory.
+    char dirTemplate[] = "/tmp/pascal-diff-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr)
+    {
+        c.verdict = "failed";
+        c.detail = "could not create a work directory";
+        return;
+    }
+    string workDir = dirTemplate;
+
+    struct Cleanup
+    {
+        string path;
+        ~Cleanup() { runProcess({ "rm", "-rf", path }); }
+    } cleanup { workDir };
+
+    vector<string> argv = { absolutePath(settings.pascal), "-compile" };
+    argv.insert(argv.end(), settings.options.begin(), settings.options.end());
+    argv.push_back(program.sourcePath);
+
+    ProcessResult built = runProcess(argv, "", workDir);
+    string binary = workDir + "/" + program.name;
+    struct stat status;
+
+    if (!built.succeeded() || (stat(binary.c_str(), &status) != 0))
+    {
+        c.verdict = "failed";
+        c.detail = "native build failed";
+        return;
+    }
+
+    string native;
+    for (int run = 0; run < settings.runs; run++)
+    {
+        ProcessResult result = runProcess({ binary }, program.input, workDir);
+        long execMs;
+
+        if (   !result.succeeded()
+            || !nativeOutput(result.output, native)
+            || !findCount(result.output, "milliseconds execution time.]",
+                          execMs))
+        {
+            c.verdict = "failed";
+            c.detail = "native build did not run";
+            return;
+        }
+
+        c.nativeMs.push_back(execMs);
+    }
+
+    // Compare the two, then both against any expected output
+    // and the output of any checked-in conversion.
+    string expected;
+    bool haveExpected = readFile(settings.expectedDir + "/" + program.name
+                                 + ".out", expected);
+    string referencePath = settings.referenceDir + "/" + program.name
+                                                 + ".cpp";
+    bool haveReference = stat(referencePath.c_str(), &status) == 0;
+
+    if (interpreted != native)
+    {
+        c.verdict = "mismatch";
+        c.detail = "interpreter vs. native, "
+                 + firstDifference(interpreted, native);
+    }
+    else if (haveExpected && !settings.record && (interpreted != expected))
+    {
+        c.verdict = "unexpected";
+        c.detail = "expected vs. both, "
+                 + firstDifference(expected, interpreted);
+    }
+    else if (haveReference)
+    {
+        string referenceBinary = workDir + "/" + program.name + "-reference";
+        ProcessResult compiled = runProcess(
+                { settings.cxx, "-O2", "-o", referenceBinary,
+                  absolutePath(referencePath) }, "", workDir);
+        ProcessResult result = runProcess({ referenceBinary }, program.input,
+                                          workDir);
+        string reference;
+
+        if (   !compiled.succeeded() || !result.succeeded()
+            || !nativeOutput(result.output, reference))
+        {
+            c.verdict = "failed";
+            c.detail = referencePath + " did not build or run";
+        }
+        else if (interpreted != reference)
+        {
+            c.verdict = "unexpected";
+            c.detail = referencePath + " vs. both, "
+                     + firstDifference(reference, interpreted);
+        }
+    }
+}
+
+/**
+ * Write the comparisons as JSON.
+ * @param path the file to write.
+ * @param comparisons the comparisons.
+ * @return true if written.
+ */
+static bool writeResults(const string& path,
+                         const vector<Comparison>& comparisons)
+{
+    ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "{\n  \"results\": [";
+
+    for (size_t i = 0; i < comparisons.size(); i++)
+    {
+        const Comparison& c = comparisons[i];
+        char buffer[160];
+
+        snprintf(buffer, sizeof(buffer),
+                 "\"interpreted_ms\": %.1f, \"native_ms\": %.1f, "
+                 "\"ratio\": %.2f", median(c.interpretedMs),
+                 median(c.nativeMs), c.ratio());
+
+        out << (i > 0 ? "," : "") << "\n    { \"program\": "
+            << jsonQuote(c.program) << ", \"verdict\": "
+            << jsonQuote(c.verdict) << ", " << buffer;
+        if (!c.detail.empty()) out << ", \"detail\": " << jsonQuote(c.detail);
+        out << " }";
+    }
+
+    out << "\n  ]\n}\n";
+    return out.good();
+}
+
+/**
+ * List the programs of a directory.
+ * @param dir the directory.
+ * @param programs the list to append to.
+ */
+static void listPrograms(const string& dir, vector<Program>& programs)
+{
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) return;
+
+    vector<string> names;
+    while (struct dirent *entry = readdir(d))
+    {
+        string name = entry->d_name;
+        if ((name.length() > 4) && (name.substr(name.length() - 4) == ".pas"))
+        {
+            names.push_back(name.substr(0, name.length() - 4));
+        }
+    }
+
+    closedir(d);
+    sort(names.begin(), names.end());
+
+    for (const string& name : names)
+    {
+        Program program;
+        program.name = name;
+        program.sourcePath = absolutePath(dir + "/" + name + ".pas");
+        readFile(dir + "/" + name + ".in", program.input);
+
+        programs.push_back(program);
+    }
+}
+
+/**
+ * Parse the command line.
+ * @param argc the argument count.
+ * @param args the arguments.
+ * @param settings the settings to fill.
+ * @return true if valid.
+ */
+static bool parseArguments(int argc, const char *args[], Settings& settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+
+        if      (arg == "--record") settings.record = true;
+        else if (arg == "--pascal"   && hasValue) settings.pascal = args[++i];
+        else if (arg == "--programs" && hasValue) settings.programsDirs.push_back(args[++i]);
+        else if (arg == "--expected" && hasValue) settings.expectedDir = args[++i];
+        else if (arg == "--reference" && hasValue) settings.referenceDir = args[++i];
+        else if (arg == "--cxx"      && hasValue) settings.cxx = args[++i];
+        else if (arg == "--option"   && hasValue) settings.options.push_back(args[++i]);
+        else if (arg == "--runs"     && hasValue) settings.runs = atoi(args[++i]);
+        else if (arg == "--output"   && hasValue) settings.outputFile = args[++i];
+        else if ((arg.length() > 0) && (arg[0] != '-'))
+        {
+            settings.names.push_back(arg);
+        }
+        else
+        {
+            cout << "ERROR: Invalid option \"" << arg << "\"." << endl;
+            return false;
+        }
+    }
+
+    if (settings.programsDirs.empty())
+    {
+        settings.programsDirs = { "benchmarks/programs", "." };
+    }
+
+    return settings.runs > 0;
+}
+
+int main(int argc, const char *args[])
+{
+    Settings settings;
+    if (!parseArguments(argc, args, settings))
+    {
+        cout << "USAGE: Differential [--record] [--pascal PATH] "
+             << "[--programs DIR] [--expected DIR] [--reference DIR] "
+             << "[--cxx COMPILER] [--option OPTION] [--runs N] "
+             << "[--output FILE] [NAME ...]" << endl;
+        return 2;
+    }
+
+    vector<Program> programs;
+    for (const string& dir : settings.programsDirs) listPrograms(dir, programs);
+
+    if (!settings.names.empty())
+    {
+        vector<Program> chosen;
+        for (const Program& program : programs)
+        {
+            if (   find(settings.names.begin(), settings.names.end(),
+                        program.name) != settings.names.end())
+            {
+                chosen.push_back(program);
+            }
+        }
+        programs = chosen;
+    }
+
+    if (programs.empty())
+    {
+        cout << "ERROR: No programs to compare." << endl;
+        return 2;
+    }
+
+    if (settings.record) mkdir(settings.expectedDir.c_str(), 0755);
+
+    vector<Comparison> comparisons;
+    int failures = 0;
+
+    printf("%-16s %14s %12s %8s  %s\n", "Program", "Interpreted ms",
+           "Native ms", "Ratio", "Verdict");
+    printf("%-16s %14s %12s %8s  %s\n", "-------", "--------------",
+           "---------", "-----", "-------");
+
+    for (const Program& program : programs)
+    {
+        Comparison c;
+        c.program = program.name;
+        compare(settings, program, c);
+
+        if (c.verdict == "match")
+        {
+            if (settings.record)
+            {
+                ofstream out(settings.expectedDir + "/" + program.name
+                             + ".out", ios::binary);
+                out << c.output;
+            }
+        }
+        else failures++;
+
+        printf("%-16s %14.1f %12.1f %7.1fx  %s%s%s\n", c.program.c_str(),
+               median(c.interpretedMs), median(c.nativeMs), c.ratio(),
+               c.verdict.c_str(), c.detail.empty() ? "" : ": ",
+               c.detail.c_str());
+
+        comparisons.push_back(c);
+    }
+
+    if (!writeResults(settings.outputFile, comparisons))
+    {
+        cout << "ERROR: Failed to write \"" << settings.outputFile << "\"."
+             << endl;
+        return 2;
+    }
+
+    printf("\n%d of %d programs differed or failed. Results written to \"%s\".\n",
+           failures, (int) programs.size(), settings.outputFile.c_str());
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * <h1>Generate</h1>
+ *
+ * <p>Write a generated Pascal program to a file or to standard output.</p>
+ *
+ * <p>Build and run from the PscToC++ directory:</p>
+ *
+ * <pre>
+ *   c++ -std=c++11 -O2 -o benchmarks/harness/Generate \
+ *       benchmarks/harness/Generate.cpp
+ *   benchmarks/harness/Generate --statements 100000 --routines 200 Big.pas
+ * </pre>
+ *
+ * <p>Options:</p>
+ *
+ * <pre>
+ *   --statements N     statements in the whole program (1000)
+ *   --depth N          deepest nesting of control statements (3)
+ *   --routines N       procedures and functions (10)
+ *   --expression N     deepest nesting of subexpressions (3)
+ *   --array N          elements in each array (100)
+ *   --seed N           different seeds generate different programs (1)
+ *   FILE               where to write the program, named after the file
+ *                      (standard output, as program Generated)
+ * </pre>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+
+#include "Generator.h"
+
+using namespace std;
+using namespace benchmarks;
+
+/**
+ * Parse the command line.
+ * @param argc the argument count.
+ * @param args the arguments.
+ * @param settings the settings to fill.
+ * @param fileName set to the output file name, if any.
+ * @return true if valid.
+ */
+static bool parseArguments(int argc, const char *args[],
+                           GeneratorSettings& settings, string& fileName)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+
+        if      (arg == "--statements" && hasValue) settings.statements = atol(args[++i]);
+        else if (arg == "--depth"      && hasValue) settings.depth = atoi(args[++i]);
+        else if (arg == "--routines"   && hasValue) settings.routines = atoi(args[++i]);
+        else if (arg == "--expression" && hasValue) settings.expressionDepth = atoi(args[++i]);
+        else if (arg == "--array"      && hasValue) settings.arraySize = atoi(args[++i]);
+        else if (arg == "--seed"       && hasValue) settings.seed = atoi(args[++i]);
+        else if ((arg.length() > 0) && (arg[0] != '-') && fileName.empty())
+        {
+            fileName = arg;
+        }
+        else
+        {
+            cout << "ERROR: Invalid option \"" << arg << "\"." << endl;
+            return false;
+        }
+    }
+
+    return settings.statements > 0;
+}
+
+int main(int argc, const char *args[])
+{
+    GeneratorSettings settings;
+    string fileName;
+
+    if (!parseArguments(argc, args, settings, fileName))
+    {
+        cout << "USAGE: Generate [--statements N] [--depth N] "
+             << "[--routines N] [--expression N] [--array N] [--seed N] "
+             << "[FILE]" << endl;
+        return 2;
+    }
+
+    if (fileName.empty())
+    {
+        ProgramGenerator(settings).generate(cout);
+        return 0;
+    }
+
+    // The program is named after the file.
+    size_t slash = fileName.rfind('/');
+    string base = fileName.substr(slash == string::npos ? 0 : slash + 1);
+    settings.name = base.substr(0, base.find('.'));
+
+    ofstream out(fileName);
+    if (!out.is_open())
+    {
+        cout << "ERROR: Failed to create \"" << fileName << "\"." << endl;
+        return 2;
+    }
+
+    long statements = ProgramGenerator(settings).generate(out);
+    cout << "Generated " << statements << " statements in \""
+         << fileName << "\"." << endl;
+
+    return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * <h1>Generator</h1>
+ *
+ * <p>Generate valid, terminating Pascal programs of any size, shaped by
+ * the number of statements, the nesting depth of control statements, the
+ * number of routines, the nesting depth of expressions, and the size of
+ * arrays. The same settings always generate the same program.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef BENCHMARKS_GENERATOR_H_
+#define BENCHMARKS_GENERATOR_H_
+
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+namespace benchmarks {
+
+using namespace std;
+
+/**
+ * The shape of a generated program.
+ */
+struct GeneratorSettings
+{
+    long statements     = 1000;   // statements in the whole program
+    int depth           = 3;      // deepest nesting of control statements
+    int routines        = 10;     // procedures and functions
+    int expressionDepth = 3;      // deepest nesting of subexpressions
+    int arraySize       = 100;    // elements in each array
+    unsigned seed       = 1;      // different seeds, different programs
+    string name         = "Generated";
+};
+
+/**
+ * Every integer value in a generated program stays in 0..MODULUS-1,
+ * so no product of two values overflows and no subscript is negative.
+ * Loops run at most twice, so a statement nested in d loops runs at
+ * most 2^d times for each call of its routine.
+ */
+class ProgramGenerator
+{
+public:
+    /**
+     * Constructor.
+     * @param settings the shape of the program.
+     */
+    ProgramGenerator(const GeneratorSettings& settings)
+        : settings(settings), state(settings.seed*2654435761u + 1),
+          out(nullptr), emitted(0)
+    {
+        this->settings.depth = max(this->settings.depth, 0);
+        this->settings.routines = max(this->settings.routines, 0);
+        this->settings.expressionDepth =
+                                    max(this->settings.expressionDepth, 0);
+        this->settings.arraySize = max(this->settings.arraySize, 1);
+    }
+
+    /**
+     * Generate the program.
+     * @param stream where to write it.
+     * @return the number of statements generated.
+     */
+    long generate(ostream& stream)
+    {
+        out = &stream;
+        emitted = 0;
+
+        long perRoutine = settings.statements/(settings.routines + 1);
+
+        *out << "PROGRAM " << settings.name << ";\n\n"
+             << "{ Generated: " << settings.statements << " statements, "
+             << settings.routines << " routines, depth "
+             << settings.depth << ", expression depth "
+             << settings.expressionDepth << ", arrays of "
+             << settings.arraySize << ". }\n\n"
+             << "CONST\n"
+             << "    size = " << settings.arraySize << ";\n\n"
+             << "VAR\n"
+             << "    a, b : ARRAY [1..size] OF integer;\n"
+             << "    g0, g1, g2, g3, g4, g5, g6, g7 : integer;\n";
+        declareCounters("    ");
+
+        for (int r = 1; r <= settings.routines; r++)
+        {
+            *out << (r == 1 ? "\n" : ";\n\n");
+            generateRoutine(r, perRoutine);
+        }
+        if (settings.routines > 0) *out << ";\n";
+
+        // The main program: initialize, call each routine once,
+        // run its own share of the statements, and print a checksum.
+        *out << "\nBEGIN\n"
+             << "    FOR i0 := 1 TO size DO BEGIN\n"
+             << "        a[i0] := i0 MOD 7;\n"
+             << "        b[i0] := 0\n"
+             << "    END;\n";
+        for (int i = 0; i < 8; i++)
+        {
+            *out << "    g" << i << " := " << i + 1 << ";\n";
+        }
+        emitted += 11;
+
+        scalars = 8;
+        locals = false;
+
+        for (int r = 1; r <= settings.routines; r++)
+        {
+            string args = expression(1) + ", " + expression(1);
+
+            if (isFunction(r))
+            {
+                *out << "    g" << r%8 << " := " << routineName(r)
+                     << "(" << args << ");\n";
+            }
+            else *out << "    " << routineName(r) << "(" << args << ");\n";
+
+            emitted++;
+        }
+
+        long rest = settings.statements - emitted - 2;
+        generateStatements(max(rest, 0L), 1, "    ");
+
+        *out << ";\n"
+             << "    FOR i0 := 1 TO size DO "
+             << "g0 := (g0 + a[i0] + b[i0]) MOD " << MODULUS << ";\n"
+             << "    writeln('checksum = ', "
+             << "((g0 + g1 + g2 + g3 + g4 + g5 + g6 + g7) MOD "
+             << MODULUS << "):0)\n"
+             << "END.\n";
+        emitted += 2;
+
+        return emitted;
+    }
+
+private:
+    static const int MODULUS = 10007;
+
+    GeneratorSettings settings;
+    unsigned long long state;  // of the random number generator
+    ostream *out;
+    long emitted;              // statements generated so far
+    int scalars;               // scalar variables assignable in scope
+    bool locals;               // true in a routine, false in the main
+
+    /**
+     * A random number, the same on every platform.
+     * @param n the limit.
+     * @return a number from 0 through n-1.
+     */
+    int random(int n)
+    {
+        state = state*6364136223846793005ULL + 1442695040888963407ULL;
+        return (int) ((state >> 33) % (unsigned long long) n);
+    }
+
+    bool isFunction(int r) const { return r%2 == 0; }
+
+    string routineName(int r) const
+    {
+        return (isFunction(r) ? "f" : "p") + to_string(r);
+    }
+
+    /**
+     * Declare the loop counters, one FOR and one WHILE/REPEAT counter
+     * for each nesting level, so that nested loops never share one.
+     */
+    void declareCounters(const string& indent)
+    {
+        *out << indent << "i0";
+        for (int d = 1; d <= settings.depth; d++) *out << ", i" << d;
+        for (int d = 1; d <= settings.depth; d++) *out << ", w" << d;
+        *out << " : integer;\n";
+    }
+
+    /**
+     * Generate a procedure or function with two value parameters.
+     */
+    void generateRoutine(int r, long statements)
+    {
+        bool function = isFunction(r);
+        long start = emitted;
+
+        *out << (function ? "FUNCTION " : "PROCEDURE ") << routineName(r)
+             << "(x, y : integer)" << (function ? " : integer" : "") << ";\n"
+             << "\nVAR\n"
+             << "    v0, v1, v2, v3 : integer;\n";
+        declareCounters("    ");
+
+        *out << "\nBEGIN\n"
+             << "    v0 := x MOD " << MODULUS << ";\n"
+             << "    v1 := y MOD " << MODULUS << ";\n"
+             << "    v2 := (x + y) MOD " << MODULUS << ";\n"
+             << "    v3 := 0;\n";
+        emitted += 4;
+
+        scalars = 4;
+        locals = true;
+
+        long rest = statements - (emitted - start) - (function ? 1 : 0);
+        generateStatements(max(rest, 1L), 1, "    ");
+
+        if (function)
+        {
+            *out << ";\n    " << routineName(r) << " := "
+                 << expression(settings.expressionDepth);
+            emitted++;
+        }
+
+        *out << "\nEND";
+    }
+
+    /**
+     * Generate a statement list, without its final semicolon.
+     * @param count how many statements to generate, counting the
+     *              statements nested in control statements.
+     * @param level the nesting level of the list.
+     * @param indent the indentation.
+     */
+    void generateStatements(long count, int level, const string& indent)
+    {
+        long end = emitted + max(count, 1L);
+        bool first = true;
+
+        while (emitted < end)
+        {
+            if (!first) *out << ";\n";
+            first = false;
+
+            long left = end - emitted;
+            if ((level <= settings.depth) && (left >= 3) && (random(4) == 0))
+            {
+                long inner = 1 + random((int) min(left - 2, 8L));
+                generateControl(inner, level, indent);
+            }
+            else generateAssignment(indent);
+        }
+    }
+
+    /**
+     * Generate a compound statement.
+     */
+    void generateBlock(long count, int level, const string& indent)
+    {
+        *out << "BEGIN\n";
+        generateStatements(count, level + 1, indent + "    ");
+        *out << "\n" << indent << "END";
+    }
+
+    /**
+     * Generate a control statement with count nested statements.
+     */
+    void generateControl(long count, int level, const string& indent)
+    {
+        string i = "i" + to_string(level);
+        string w = "w" + to_string(level);
+
+        emitted++;
+
+        switch (random(5))
+        {
+            case 0:
+            {
+                *out << indent << "FOR " << i << " := 1 TO 2 DO ";
+                generateBlock(count, level, indent);
+                break;
+            }
+
+            case 1:
+            {
+                // The counter's increment is one of the nested statements.
+                *out << indent << w << " := 0;\n"
+                     << indent << "WHILE " << w << " < 2 DO BEGIN\n";
+                generateStatements(max(count - 2, 1L), level + 1,
+                                   indent + "    ");
+                *out << ";\n" << indent << "    " << w << " := "
+                     << w << " + 1\n" << indent << "END";
+                emitted += 2;
+                break;
+            }
+
+            case 2:
+            {
+                *out << indent << w << " := 0;\n"
+                     << indent << "REPEAT\n";
+                generateStatements(max(count - 2, 1L), level + 1,
+                                   indent + "    ");
+                *out << ";\n" << indent << "    " << w << " := "
+                     << w << " + 1\n"
+                     << indent << "UNTIL " << w << " >= 2";
+                emitted += 2;
+                break;
+            }
+
+            case 3:
+            {
+                *out << indent << "IF " << condition() << " THEN ";
+                if (count >= 2)
+                {
+                    generateBlock(count/2, level, indent);
+                    *out << "\n" << indent << "ELSE ";
+                    generateBlock(count - count/2, level, indent);
+                }
+                else generateBlock(count, level, indent);
+                break;
+            }
+
+            default:
+            {
+                *out << indent << "CASE " << expression(1) << " MOD 3 OF\n";
+                for (int c = 0; c < 3; c++)
+                {
+                    long share = max(count/3, 1L);
+                    *out << indent << "    " << c << ": ";
+                    generateBlock(share, level + 1, indent + "    ");
+                    *out << (c < 2 ? ";\n" : "\n");
+                }
+                *out << indent << "END";
+                break;
+            }
+        }
+    }
+
+    /**
+     * Generate an assignment to a scalar variable or an array element.
+     */
+    void generateAssignment(const string& indent)
+    {
+        *out << indent;
+
+        switch (random(4))
+        {
+            case 0:  *out << "a[" << subscript() << "]"; break;
+            case 1:  *out << "b[" << subscript() << "]"; break;
+            default: *out << scalar(); break;
+        }
+
+        *out << " := " << expression(settings.expressionDepth);
+        emitted++;
+    }
+
+    /**
+     * @return the name of a random scalar variable in scope.
+     */
+    string scalar()
+    {
+        return (locals ? "v" : "g") + to_string(random(scalars));
+    }
+
+    /**
+     * @return a subscript expression within the bounds of the arrays.
+     */
+    string subscript()
+    {
+        return "1 + " + expression(1) + " MOD size";
+    }
+
+    /**
+     * Generate an expression with a value from 0 through MODULUS-1.
+     * @param depth how deeply to nest subexpressions.
+     * @return the expression.
+     */
+    string expression(int depth)
+    {
+        if ((depth <= 0) || (random(3) == 0))
+        {
+            switch (random(6))
+            {
+                case 0:  return to_string(random(1000));
+                case 1:  return locals ? (random(2) == 0 ? "x" : "y")
+                                       : scalar();
+                case 2:  return "a[1 + " + scalar() + " MOD size]";
+                default: return scalar();
+            }
+        }
+
+        string left  = expression(depth - 1);
+        string right = expression(depth - 1);
+        string mod   = " MOD " + to_string(MODULUS);
+
+        switch (random(3))
+        {
+            case 0:  return "((" + left + " + " + right + ")" + mod + ")";
+            case 1:  return "((" + left + "*" + right + ")" + mod + ")";
+            default: return "(" + left + " DIV (1 + " + right + " MOD 7))";
+        }
+    }
+
+    /**
+     * @return a boolean expression.
+     */
+    string condition()
+    {
+        string left  = expression(max(settings.expressionDepth - 1, 0));
+        string right = expression(max(settings.expressionDepth - 1, 0));
+
+        switch (random(3))
+        {
+            case 0:  return left + " < " + right;
+            case 1:  return left + " MOD 2 = 0";
+            default: return left + " <> " + right;
+        }
+    }
+};
+
+} // namespace benchmarks
+
+#endif /* BENCHMARKS_GENERATOR_H_ */
@@ -0,0 +1,614 @@
+/**
+ * <h1>Harness</h1>
+ *
+ * <p>Run the benchmark programs through the interpreter (-execute),
+ * the debugger with no breakpoints (-debug), and the converter followed
+ * by a native build of the converted program (native). Record the wall
+ * time, statements executed per second, and peak resident set size of
+ * each, write them as JSON, and compare them against a stored baseline.</p>
+ *
+ * <p>Build and run from the PscToC++ directory:</p>
+ *
+ * <pre>
+ *   c++ -std=c++11 -O2 -o benchmarks/harness/Harness \
+ *       benchmarks/harness/Harness.cpp
+ *   benchmarks/harness/Harness --record     # store this machine's baseline
+ *   benchmarks/harness/Harness              # compare against it
+ * </pre>
+ *
+ * <p>Options:</p>
+ *
+ * <pre>
+ *   --pascal PATH      the PascalCpp executable (Release/PscToC++)
+ *   --programs DIR     the benchmark programs (benchmarks/programs)
+ *   --modes LIST       comma-separated: execute,debug,native (all three)
+ *   --runs N           measured runs of each program in each mode (5)
+ *   --warmup N         unmeasured runs first (1)
+ *   --cxx COMPILER     to build converted programs ($CXX or c++)
+ *   --output FILE      where to write the results (benchmark-results.json)
+ *   --baseline FILE    the baseline (benchmarks/baselines/HOSTNAME.json)
+ *   --record           write the results as the new baseline
+ *   --tolerance PCT    ignore changes smaller than this percentage (5)
+ *   --sigmas K         ignore changes within K noise deviations (3)
+ *   NAME ...           only these programs, by name without ".pas"
+ * </pre>
+ *
+ * <p>A change counts as a regression only if it is larger than both the
+ * relative tolerance and K times the noise, estimated from the median
+ * absolute deviation of the baseline's and the current runs, and larger
+ * than a small absolute floor (2 ms, 256 KB). The exit status is 1 if
+ * any metric regressed.</p>
+ *
+ * <p>Without --record, the baseline must exist: a missing one is an
+ * error (exit status 2) before anything runs, since results that
+ * nothing is compared against can't catch a regression. No baseline
+ * is committed, because timings from one machine say nothing about
+ * another. Record one on each machine that checks for regressions.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Process.h"
+#include "Stats.h"
+#include "Json.h"
+
+using namespace std;
+using namespace benchmarks;
+
+/**
+ * Harness settings.
+ */
+struct Settings
+{
+    string pascal      = "Release/PscToC++";
+    string programsDir = "benchmarks/programs";
+    vector<string> modes = { "execute", "debug", "native" };
+    int runs           = 5;
+    int warmup         = 1;
+    string cxx         = getenv("CXX") != nullptr ? getenv("CXX") : "c++";
+    string outputFile  = "benchmark-results.json";
+    string baselineFile;
+    bool record        = false;
+    double tolerance   = 0.05;
+    double sigmas      = 3;
+    vector<string> names;
+};
+
+/**
+ * The measurements of one program in one mode.
+ */
+struct Measurement
+{
+    string program;
+    string mode;
+    bool ok = true;
+    string error;
+    long statements = 0;               // statements executed, if known
+    map<string, vector<double>> metrics;  // metric name to its samples
+};
+
+/**
+ * Metrics for which a larger value is better.
+ */
+static bool higherIsBetter(const string& metric)
+{
+    return metric == "statements_per_sec";
+}
+
+/**
+ * The smallest change of a metric worth reporting, whatever the noise
+ * estimate says: timer granularity and page rounding are not regressions.
+ */
+static double absoluteFloor(const string& metric)
+{
+    if (metric == "peak_rss_kb") return 256;
+    if (metric.length() > 3 && metric.substr(metric.length() - 3) == "_ms")
+    {
+        return 2;
+    }
+
+    return 0;
+}
+
+/**
+ * Measure a program run by the interpreter or the debugger.
+ * @param settings the harness settings.
+ * @param sourcePath the absolute path of the Pascal source.
+ * @param m the measurement to fill.
+ */
+static void measureInterpreted(const Settings& settings,
+                               const string& sourcePath, Measurement& m)
+{
+    vector<string> argv = { settings.pascal, "-" + m.mode, sourcePath };
+
+    // With no breakpoints set, the debugger runs to the end after "go".
+    string input = m.mode == "debug" ? "go\nquit\n" : "";
+
+    for (int run = -settings.warmup; run < settings.runs; run++)
+    {
+        ProcessResult result = runProcess(argv, input);
+
+        if (!result.succeeded())
+        {
+            m.ok = false;
+            m.error = describeFailure(result);
+            return;
+        }
+
+        if (run < 0) continue;
+
+        long statements, execMs;
+        m.metrics["wall_ms"].push_back(result.wallMs);
+        m.metrics["peak_rss_kb"].push_back(result.peakRssKb);
+
+        if (findCount(result.output, "statements executed.", statements))
+        {
+            m.statements = statements;
+        }
+
+        if (findCount(result.output, "milliseconds execution time.", execMs))
+        {
+            m.metrics["exec_ms"].push_back(execMs);
+
+            if ((m.statements > 0) && (execMs > 0))
+            {
+                m.metrics["statements_per_sec"]
+                    .push_back(m.statements/(execMs/1000.0));
+            }
+        }
+    }
+}
+
+/**
+ * Measure a program converted to C++ and built natively.
+ * @param settings the harness settings.
+ * @param sourcePath the absolute path of the Pascal source.
+ * @param statements the statement count from the interpreter, or 0.
+ * @param m the measurement to fill.
+ */
+static void measureNative(const Settings& settings, const string& sourcePath,
+                          long statements, Measurement& m)
+{
+    char dirTemplate[] = "/tmp/pascal-bench-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr)
+    {
+        m.ok = false;
+        m.error = "could not create a work directory";
+        return;
+    }
+    string workDir = dirTemplate;
+
+    // Remove the work directory however the measurement ends.
+    struct Cleanup
+    {
+        string path;
+        ~Cleanup() { runProcess({ "rm", "-rf", path }); }
+    } cleanup { workDir };
+
+    // The converter writes <program>.cpp into its working directory.
+    ProcessResult converted = runProcess(
+            { absolutePath(settings.pascal), "-convert", sourcePath },
+            "", workDir);
+    string cppFile = workDir + "/" + m.program + ".cpp";
+    struct stat status;
+
+    if (!converted.succeeded() || (stat(cppFile.c_str(), &status) != 0))
+    {
+        m.ok = false;
+        m.error = "conversion failed, " + describeFailure(converted);
+        return;
+    }
+
+    string binary = workDir + "/" + m.program;
+    ProcessResult built = runProcess(
+            { settings.cxx, "-O2", "-o", binary, cppFile });
+
+    if (!built.succeeded())
+    {
+        m.ok = false;
+        m.error = "native build failed, " + describeFailure(built);
+        return;
+    }
+
+    m.statements = statements;
+    m.metrics["convert_ms"].push_back(converted.wallMs);
+    m.metrics["build_ms"].push_back(built.wallMs);
+
+    for (int run = -settings.warmup; run < settings.runs; run++)
+    {
+        ProcessResult result = runProcess({ binary }, "", workDir);
+
+        if (!result.succeeded())
+        {
+            m.ok = false;
+            m.error = describeFailure(result);
+            return;
+        }
+
+        if (run < 0) continue;
+
+        long execMs;
+        m.metrics["wall_ms"].push_back(result.wallMs);
+        m.metrics["peak_rss_kb"].push_back(result.peakRssKb);
+
+        if (findCount(result.output, "milliseconds execution time.", execMs))
+        {
+            m.metrics["exec_ms"].push_back(execMs);
+
+            // Executing the same program executes the same statements.
+            if ((statements > 0) && (execMs > 0))
+            {
+                m.metrics["statements_per_sec"]
+                    .push_back(statements/(execMs/1000.0));
+            }
+        }
+    }
+}
+
+/**
+ * Write the measurements as JSON.
+ * @param path the file to write.
+ * @param settings the harness settings.
+ * @param host the name of this machine.
+ * @param measurements the measurements.
+ * @return true if written.
+ */
+static bool writeResults(const string& path, const Settings& settings,
+                         const string& host,
+                         const vector<Measurement>& measurements)
+{
+    ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "{\n";
+    out << "  \"host\": " << jsonQuote(host) << ",\n";
+    out << "  \"runs\": " << settings.runs << ",\n";
+    out << "  \"results\": [";
+
+    for (size_t i = 0; i < measurements.size(); i++)
+    {
+        const Measurement& m = measurements[i];
+
+        out << (i > 0 ? "," : "") << "\n    {\n";
+        out << "      \"program\": " << jsonQuote(m.program) << ",\n";
+        out << "      \"mode\": " << jsonQuote(m.mode) << ",\n";
+        out << "      \"ok\": " << (m.ok ? "true" : "false") << ",\n";
+        if (!m.ok) out << "      \"error\": " << jsonQuote(m.error) << ",\n";
+        out << "      \"statements\": " << m.statements << ",\n";
+        out << "      \"metrics\": {";
+
+        bool first = true;
+        for (auto& entry : m.metrics)
+        {
+            char buffer[128];
+            const vector<double>& samples = entry.second;
+
+            out << (first ? "" : ",") << "\n        "
+                << jsonQuote(entry.first) << ": {";
+            snprintf(buffer, sizeof(buffer), "\"median\": %.3f, \"mad\": %.3f",
+                     median(samples), medianAbsoluteDeviation(samples));
+            out << buffer << ", \"samples\": [";
+
+            for (size_t j = 0; j < samples.size(); j++)
+            {
+                snprintf(buffer, sizeof(buffer), "%s%.3f",
+                         j > 0 ? ", " : "", samples[j]);
+                out << buffer;
+            }
+
+            out << "]}";
+            first = false;
+        }
+
+        out << (first ? "" : "\n      ") << "}\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+    return out.good();
+}
+
+/**
+ * Compare the measurements against a baseline and print a report.
+ * @param settings the harness settings.
+ * @param baseline the parsed baseline.
+ * @param measurements the current measurements.
+ * @return the number of regressions.
+ */
+static int compare(const Settings& settings, const JsonValue& baseline,
+                   const vector<Measurement>& measurements)
+{
+    int regressions = 0;
+
+    printf("\n%-14s %-8s %-19s %12s %12s %8s  %s\n", "Program", "Mode",
+           "Metric", "Baseline", "Current", "Change", "Verdict");
+    printf("%-14s %-8s %-19s %12s %12s %8s  %s\n", "-------", "----",
+           "------", "--------", "-------", "------", "-------");
+
+    for (const Measurement& m : measurements)
+    {
+        const JsonValue *base = nullptr;
+
+        for (const JsonValue& result : baseline["results"].elements)
+        {
+            if (   (result["program"].text == m.program)
+                && (result["mode"].text == m.mode))
+            {
+                base = &result;
+            }
+        }
+
+        if ((base == nullptr) || !(*base)["ok"].boolean)
+        {
+            printf("%-14s %-8s %s\n", m.program.c_str(), m.mode.c_str(),
+                   base == nullptr ? "not in the baseline"
+                                   : "failed in the baseline");
+            continue;
+        }
+
+        if (!m.ok)
+        {
+            printf("%-14s %-8s FAILED: %s\n", m.program.c_str(),
+                   m.mode.c_str(), m.error.c_str());
+            regressions++;
+            continue;
+        }
+
+        for (auto& entry : m.metrics)
+        {
+            const string& metric = entry.first;
+            const JsonValue& baseMetric = (*base)["metrics"][metric];
+            if (baseMetric.isNull()) continue;
+
+            double baseMedian = baseMetric["median"].number;
+            double baseMad    = baseMetric["mad"].number;
+            double nowMedian  = median(entry.second);
+            double nowMad     = medianAbsoluteDeviation(entry.second);
+
+            // A change must exceed both the relative tolerance
+            // and the measured noise before it counts.
+            double noise = MAD_TO_SIGMA*max(baseMad, nowMad);
+            double threshold = max(max(settings.sigmas*noise,
+                                       settings.tolerance*fabs(baseMedian)),
+                                   absoluteFloor(metric));
+            double worse = higherIsBetter(metric) ? baseMedian - nowMedian
+                                                  : nowMedian - baseMedian;
+            double change = baseMedian != 0
+                          ? 100*(nowMedian - baseMedian)/baseMedian : 0;
+
+            const char *verdict = "ok";
+            if (worse > threshold)
+            {
+                verdict = "REGRESSION";
+                regressions++;
+            }
+            else if (-worse > threshold)
+            {
+                verdict = "improved";
+            }
+
+            printf("%-14s %-8s %-19s %12.1f %12.1f %+7.1f%%  %s\n",
+                   m.program.c_str(), m.mode.c_str(), metric.c_str(),
+                   baseMedian, nowMedian, change, verdict);
+        }
+    }
+
+    return regressions;
+}
+
+/**
+ * List the benchmark programs.
+ * @param settings the harness settings.
+ * @return the program names, sorted.
+ */
+static vector<string> listPrograms(const Settings& settings)
+{
+    vector<string> names;
+    DIR *dir = opendir(settings.programsDir.c_str());
+
+    if (dir == nullptr) return names;
+
+    while (struct dirent *entry = readdir(dir))
+    {
+        string name = entry->d_name;
+        if ((name.length() > 4) && (name.substr(name.length() - 4) == ".pas"))
+        {
+            names.push_back(name.substr(0, name.length() - 4));
+        }
+    }
+
+    closedir(dir);
+    sort(names.begin(), names.end());
+
+    return names;
+}
+
+/**
+ * Parse the command line.
+ * @param argc the argument count.
+ * @param args the arguments.
+ * @param settings the settings to fill.
+ * @return true if valid.
+ */
+static bool parseArguments(int argc, const char *args[], Settings& settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+
+        if      (arg == "--record") settings.record = true;
+        else if (arg == "--pascal"    && hasValue) settings.pascal = args[++i];
+        else if (arg == "--programs"  && hasValue) settings.programsDir = args[++i];
+        else if (arg == "--runs"      && hasValue) settings.runs = atoi(args[++i]);
+        else if (arg == "--warmup"    && hasValue) settings.warmup = atoi(args[++i]);
+        else if (arg == "--cxx"       && hasValue) settings.cxx = args[++i];
+        else if (arg == "--output"    && hasValue) settings.outputFile = args[++i];
+        else if (arg == "--baseline"  && hasValue) settings.baselineFile = args[++i];
+        else if (arg == "--tolerance" && hasValue) settings.tolerance = atof(args[++i])/100;
+        else if (arg == "--sigmas"    && hasValue) settings.sigmas = atof(args[++i]);
+        else if (arg == "--modes"     && hasValue)
+        {
+            settings.modes.clear();
+            stringstream list(args[++i]);
+            string mode;
+
+            while (getline(list, mode, ','))
+            {
+                if ((mode != "execute") && (mode != "debug") && (mode != "native"))
+                {
+                    cout << "ERROR: Unknown mode \"" << mode << "\"." << endl;
+                    return false;
+                }
+                settings.modes.push_back(mode);
+            }
+        }
+        else if ((arg.length() > 0) && (arg[0] != '-'))
+        {
+            settings.names.push_back(arg);
+        }
+        else
+        {
+            cout << "ERROR: Invalid option \"" << arg << "\"." << endl;
+            return false;
+        }
+    }
+
+    return settings.runs > 0;
+}
+
+int main(int argc, const char *args[])
+{
+    Settings settings;
+    if (!parseArguments(argc, args, settings))
+    {
+        cout << "USAGE: Harness [--record] [--pascal PATH] [--programs DIR] "
+             << "[--modes LIST] [--runs N] [--warmup N] [--cxx COMPILER] "
+             << "[--output FILE] [--baseline FILE] [--tolerance PCT] "
+             << "[--sigmas K] [NAME ...]" << endl;
+        return 2;
+    }
+
+    char hostBuffer[256] = "unknown";
+    gethostname(hostBuffer, sizeof(hostBuffer));
+    string host = hostBuffer;
+
+    // Baselines are only comparable on the machine that recorded them.
+    if (settings.baselineFile.empty())
+    {
+        settings.baselineFile = "benchmarks/baselines/" + host + ".json";
+    }
+
+    if (!settings.record && (access(settings.baselineFile.c_str(), R_OK) != 0))
+    {
+        cout << "ERROR: No baseline \"" << settings.baselineFile << "\" to "
+             << "compare against. Record one with --record." << endl;
+        return 2;
+    }
+
+    vector<string> names = settings.names.empty() ? listPrograms(settings)
+                                                  : settings.names;
+    if (names.empty())
+    {
+        cout << "ERROR: No benchmark programs in \""
+             << settings.programsDir << "\"." << endl;
+        return 2;
+    }
+
+    vector<Measurement> measurements;
+
+    for (const string& name : names)
+    {
+        string sourcePath = absolutePath(settings.programsDir + "/"
+                                         + name + ".pas");
+        long statements = 0;
+
+        for (const string& mode : settings.modes)
+        {
+            Measurement m;
+            m.program = name;
+            m.mode = mode;
+
+            cout << "Running " << name << " (" << mode << ") ..." << flush;
+
+            if (mode == "native")
+            {
+                measureNative(settings, sourcePath, statements, m);
+            }
+            else
+            {
+                measureInterpreted(settings, sourcePath, m);
+                if (mode == "execute") statements = m.statements;
+            }
+
+            if (m.ok)
+            {
+                printf(" %.1f ms\n", median(m.metrics["wall_ms"]));
+            }
+            else
+            {
+                cout << " FAILED: " << m.error << endl;
+            }
+
+            measurements.push_back(m);
+        }
+    }
+
+    string outputFile = settings.record ? settings.baselineFile
+                                        : settings.outputFile;
+    if (settings.record)
+    {
+        mkdir("benchmarks/baselines", 0755);
+    }
+
+    if (!writeResults(outputFile, settings, host, measurements))
+    {
+        cout << "ERROR: Failed to write \"" << outputFile << "\"." << endl;
+        return 2;
+    }
+
+    cout << endl << "Results written to \"" << outputFile << "\"." << endl;
+    if (settings.record) return 0;
+
+    ifstream baselineStream(settings.baselineFile);
+    if (!baselineStream.is_open())
+    {
+        cout << "ERROR: Can't read the baseline \""
+             << settings.baselineFile << "\"." << endl;
+        return 2;
+    }
+
+    stringstream baselineText;
+    baselineText << baselineStream.rdbuf();
+
+    JsonValue baseline;
+    try
+    {
+        baseline = parseJson(baselineText.str());
+    }
+    catch (const runtime_error& ex)
+    {
+        cout << "ERROR: Bad baseline \"" << settings.baselineFile << "\": "
+             << ex.what() << endl;
+        return 2;
+    }
+
+    int regressions = compare(settings, baseline, measurements);
+
+    printf("\n%d regression%s.\n", regressions, regressions == 1 ? "" : "s");
+    return regressions > 0 ? 1 : 0;
+}
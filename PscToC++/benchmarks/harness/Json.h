@@ -0,0 +1,236 @@
+/**
+ * <h1>Json</h1>
+ *
+ * <p>Just enough JSON to read back the benchmark result files
+ * that the harness writes.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef BENCHMARKS_JSON_H_
+#define BENCHMARKS_JSON_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace benchmarks {
+
+using namespace std;
+
+enum class JsonKind { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+class JsonValue
+{
+public:
+    JsonKind kind = JsonKind::NUL;
+    bool boolean = false;
+    double number = 0;
+    string text;
+    vector<JsonValue> elements;
+    map<string, JsonValue> members;
+
+    /**
+     * Get an object member.
+     * @param name the member name.
+     * @return the member, or a null value if there is no such member.
+     */
+    const JsonValue& operator [](const string& name) const
+    {
+        static const JsonValue null;
+        auto it = members.find(name);
+        return it != members.end() ? it->second : null;
+    }
+
+    bool isNull() const { return kind == JsonKind::NUL; }
+};
+
+/**
+ * Parse JSON text.
+ * @param text the text.
+ * @return the parsed value.
+ * @throws runtime_error if the text is malformed.
+ */
+JsonValue parseJson(const string& text);
+
+/**
+ * Quote a string for JSON output.
+ * @param text the string.
+ * @return the quoted string.
+ */
+inline string jsonQuote(const string& text)
+{
+    string quoted = "\"";
+
+    for (char ch : text)
+    {
+        switch (ch)
+        {
+            case '"':  quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n";  break;
+            case '\t': quoted += "\\t";  break;
+            default:
+                if ((unsigned char) ch < 0x20)
+                {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", ch);
+                    quoted += escape;
+                }
+                else quoted += ch;
+        }
+    }
+
+    return quoted + "\"";
+}
+
+class JsonParser
+{
+private:
+    const string& text;
+    size_t pos;
+
+public:
+    JsonParser(const string& text) : text(text), pos(0) {}
+
+    JsonValue parseDocument()
+    {
+        JsonValue value = parseValue();
+        skipBlanks();
+        if (pos != text.length()) fail("extra text");
+        return value;
+    }
+
+private:
+    void fail(const string& message)
+    {
+        throw runtime_error("JSON " + message + " at offset "
+                            + to_string(pos));
+    }
+
+    void skipBlanks()
+    {
+        while ((pos < text.length()) && isspace((unsigned char) text[pos])) pos++;
+    }
+
+    void expect(char ch)
+    {
+        skipBlanks();
+        if ((pos >= text.length()) || (text[pos] != ch))
+        {
+            fail(string("expected '") + ch + "'");
+        }
+        pos++;
+    }
+
+    bool match(const string& word)
+    {
+        if (text.compare(pos, word.length(), word) != 0) return false;
+        pos += word.length();
+        return true;
+    }
+
+    JsonValue parseValue()
+    {
+        JsonValue value;
+        skipBlanks();
+        if (pos >= text.length()) fail("unexpected end");
+
+        char ch = text[pos];
+
+        if (ch == '{')
+        {
+            value.kind = JsonKind::OBJECT;
+            pos++;
+            skipBlanks();
+            if (text[pos] == '}') { pos++; return value; }
+
+            do
+            {
+                skipBlanks();
+                string name = parseString();
+                expect(':');
+                value.members[name] = parseValue();
+                skipBlanks();
+            } while ((text[pos] == ',') && ++pos);
+
+            expect('}');
+        }
+        else if (ch == '[')
+        {
+            value.kind = JsonKind::ARRAY;
+            pos++;
+            skipBlanks();
+            if (text[pos] == ']') { pos++; return value; }
+
+            do
+            {
+                value.elements.push_back(parseValue());
+                skipBlanks();
+            } while ((text[pos] == ',') && ++pos);
+
+            expect(']');
+        }
+        else if (ch == '"')
+        {
+            value.kind = JsonKind::STRING;
+            value.text = parseString();
+        }
+        else if (match("true"))  { value.kind = JsonKind::BOOLEAN; value.boolean = true; }
+        else if (match("false")) { value.kind = JsonKind::BOOLEAN; }
+        else if (match("null"))  {}
+        else
+        {
+            char *end;
+            value.kind = JsonKind::NUMBER;
+            value.number = strtod(text.c_str() + pos, &end);
+            if (end == text.c_str() + pos) fail("bad value");
+            pos = end - text.c_str();
+        }
+
+        return value;
+    }
+
+    string parseString()
+    {
+        if (text[pos] != '"') fail("expected a string");
+        pos++;
+
+        string result;
+        while ((pos < text.length()) && (text[pos] != '"'))
+        {
+            char ch = text[pos++];
+            if (ch != '\\') { result += ch; continue; }
+
+            if (pos >= text.length()) break;
+            ch = text[pos++];
+            switch (ch)
+            {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'u':
+                    result += (char) strtol(text.substr(pos, 4).c_str(),
+                                            nullptr, 16);
+                    pos += 4;
+                    break;
+                default: result += ch;
+            }
+        }
+
+        if (pos >= text.length()) fail("unterminated string");
+        pos++;
+        return result;
+    }
+};
+
+inline JsonValue parseJson(const string& text)
+{
+    return JsonParser(text).parseDocument();
+}
+
+} // namespace benchmarks
+
+#endif /* BENCHMARKS_JSON_H_ */
@@ -0,0 +1,212 @@
+/**
+ * <h1>Process</h1>
+ *
+ * <p>Run a child process with its standard input supplied from a string
+ * and its standard output and error captured, and measure its wall time
+ * and peak resident set size. Also helpers for the paths and the
+ * output of the programs that the harnesses run.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef BENCHMARKS_PROCESS_H_
+#define BENCHMARKS_PROCESS_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cctype>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+namespace benchmarks {
+
+using namespace std;
+using namespace std::chrono;
+
+struct ProcessResult
+{
+    bool started   = false;  // true if the program could be executed
+    bool exited    = false;  // true if it exited rather than was killed
+    bool timedOut  = false;  // true if it was killed for taking too long
+    int  exitCode  = -1;     // its exit code, if it exited
+    double wallMs  = 0;      // wall clock time in milliseconds
+    long peakRssKb = 0;      // peak resident set size in kilobytes
+    string output;           // captured standard output and error
+
+    bool succeeded() const { return started && exited && (exitCode == 0); }
+};
+
+/**
+ * Run a program and wait for it to finish.
+ * @param argv the program and its arguments.
+ * @param input the text to send to the program's standard input.
+ * @param workingDirectory the directory to run in, or "" for the current one.
+ * @param timeoutSeconds kill the program after this many seconds.
+ * @return the result.
+ */
+inline ProcessResult runProcess(const vector<string>& argv,
+                                const string& input = "",
+                                const string& workingDirectory = "",
+                                double timeoutSeconds = 300)
+{
+    ProcessResult result;
+    int inPipe[2], outPipe[2], execPipe[2];
+
+    if (pipe(inPipe) < 0) return result;
+    if (pipe(outPipe) < 0) return result;
+    if (pipe2(execPipe, O_CLOEXEC) < 0) return result;
+
+    auto start = steady_clock::now();
+    pid_t pid = fork();
+
+    if (pid < 0) return result;
+
+    if (pid == 0)
+    {
+        dup2(inPipe[0], STDIN_FILENO);
+        dup2(outPipe[1], STDOUT_FILENO);
+        dup2(outPipe[1], STDERR_FILENO);
+        close(inPipe[0]);  close(inPipe[1]);
+        close(outPipe[0]); close(outPipe[1]);
+        close(execPipe[0]);
+
+        if (!workingDirectory.empty() && (chdir(workingDirectory.c_str()) < 0))
+        {
+            _exit(127);
+        }
+
+        vector<char *> args;
+        for (const string& arg : argv) args.push_back((char *) arg.c_str());
+        args.push_back(nullptr);
+
+        execvp(args[0], args.data());
+
+        // Only reached if the exec failed.
+        char failed = 1;
+        if (write(execPipe[1], &failed, 1) < 0) {}
+        _exit(127);
+    }
+
+    close(inPipe[0]);
+    close(outPipe[1]);
+    close(execPipe[1]);
+
+    // The exec pipe closes without data if the exec succeeded.
+    char failed;
+    result.started = read(execPipe[0], &failed, 1) == 0;
+    close(execPipe[0]);
+
+    // Send the input, then read all the output.
+    signal(SIGPIPE, SIG_IGN);
+    if (!input.empty() && (write(inPipe[1], input.data(), input.size()) < 0)) {}
+    close(inPipe[1]);
+
+    char buffer[65536];
+    struct pollfd pfd = { outPipe[0], POLLIN, 0 };
+    auto deadline = start + duration<double>(timeoutSeconds);
+
+    while (true)
+    {
+        long remaining = duration_cast<milliseconds>(
+                                    deadline - steady_clock::now()).count();
+        if (remaining <= 0)
+        {
+            kill(pid, SIGKILL);
+            result.timedOut = true;
+            break;
+        }
+
+        int ready = poll(&pfd, 1, (int) remaining);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) continue;
+
+        ssize_t count = read(outPipe[0], buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+
+        result.output.append(buffer, count);
+    }
+
+    close(outPipe[0]);
+
+    int status;
+    struct rusage usage;
+    while ((wait4(pid, &status, 0, &usage) < 0) && (errno == EINTR)) {}
+
+    result.wallMs = duration<double, milli>(steady_clock::now() - start).count();
+    result.peakRssKb = usage.ru_maxrss;  // kilobytes on Linux
+    result.exited = WIFEXITED(status);
+    result.exitCode = result.exited ? WEXITSTATUS(status) : -1;
+
+    return result;
+}
+
+/**
+ * Summarize the last lines of failing output for the report.
+ * @param result the process result.
+ * @return a one-line description.
+ */
+inline string describeFailure(const ProcessResult& result)
+{
+    if (!result.started) return "could not be run";
+    if (result.timedOut) return "timed out";
+
+    string why = result.exited ? "exit code " + to_string(result.exitCode)
+                               : "killed by a signal";
+
+    string tail = result.output.substr(result.output.length() > 200
+                                       ? result.output.length() - 200 : 0);
+    replace(tail.begin(), tail.end(), '\n', ' ');
+
+    return why + ": ..." + tail;
+}
+
+/**
+ * Get an absolute path.
+ * @param path a path relative to the current directory.
+ * @return the absolute path.
+ */
+inline string absolutePath(const string& path)
+{
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) != nullptr ? resolved : path;
+}
+
+/**
+ * Find the number printed just before a label in program output,
+ * such as the 1234 in "1234 statements executed."
+ * @param output the program output.
+ * @param label the label that follows the number.
+ * @param value set to the number.
+ * @return true if found.
+ */
+inline bool findCount(const string& output, const string& label, long& value)
+{
+    size_t pos = output.rfind(label);
+    if (pos == string::npos) return false;
+
+    size_t end = pos;
+    while ((end > 0) && (output[end - 1] == ' ')) end--;
+
+    size_t start = end;
+    while ((start > 0) && isdigit((unsigned char) output[start - 1])) start--;
+    if (start == end) return false;
+
+    value = stol(output.substr(start, end - start));
+    return true;
+}
+
+} // namespace benchmarks
+
+#endif /* BENCHMARKS_PROCESS_H_ */
@@ -0,0 +1,479 @@
+/**
+ * <h1>Scaling</h1>
+ *
+ * <p>Generate programs of increasing size and run each through every
+ * backend with -timing, recording the time and peak memory of the
+ * listing, PASS 1, PASS 2, and PASS 3. For each pass, fit how its time
+ * and memory grow with the number of source lines between successive
+ * sizes, and flag any pass that grows faster than linearly.</p>
+ *
+ * <p>Build and run from the PscToC++ directory:</p>
+ *
+ * <pre>
+ *   c++ -std=c++11 -O2 -o benchmarks/harness/Scaling \
+ *       benchmarks/harness/Scaling.cpp
+ *   benchmarks/harness/Scaling
+ *   benchmarks/harness/Scaling --sizes 1000,10000 --modes execute,convert
+ * </pre>
+ *
+ * <p>Options:</p>
+ *
+ * <pre>
+ *   --pascal PATH      the PascalCpp executable (Release/PscToC++)
+ *   --sizes LIST       comma-separated statement counts
+ *                      (1000,10000,100000,1000000)
+ *   --modes LIST       comma-separated: execute,debug,convert,compile
+ *                      (all four)
+ *   --runs N           measured runs of each size in each mode (1)
+ *   --depth N          deepest nesting of control statements (3)
+ *   --routine N        statements per routine (500)
+ *   --expression N     deepest nesting of subexpressions (3)
+ *   --array N          elements in each array (100)
+ *   --timeout SECONDS  kill a run after this long (1800)
+ *   --workdir DIR      where to write the generated programs (scaling)
+ *   --output FILE      where to write the results (scaling-results.json)
+ *   --limit EXPONENT   growth exponent above which a pass is flagged (1.2)
+ * </pre>
+ *
+ * <p>Peak memory is the high-water mark of the whole process, so each
+ * pass is charged with how much it raised that mark, and the listing
+ * also with the memory of the process before it started. A native build's
+ * compiler is a child process, and its peak is reported separately.
+ * The exit status is 1 if any pass grew faster than the limit.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "Process.h"
+#include "Stats.h"
+#include "Json.h"
+#include "Generator.h"
+
+using namespace std;
+using namespace benchmarks;
+
+/**
+ * Scaling settings.
+ */
+struct Settings
+{
+    string pascal        = "Release/PscToC++";
+    vector<long> sizes   = { 1000, 10000, 100000, 1000000 };
+    vector<string> modes = { "execute", "debug", "convert", "compile" };
+    int runs             = 1;
+    int depth            = 3;
+    int routineSize      = 500;
+    int expressionDepth  = 3;
+    int arraySize        = 100;
+    double timeout       = 1800;
+    string workDir       = "scaling";
+    string outputFile    = "scaling-results.json";
+    double limit         = 1.2;
+};
+
+/**
+ * The passes that -timing reports, in order.
+ */
+static const vector<string> PASSES = { "Listing", "PASS 1", "PASS 2", "PASS 3" };
+
+/**
+ * The measurements of one pass of one size in one mode.
+ */
+struct PassTiming
+{
+    vector<double> ms;
+    vector<double> peakKb;       // the process's high-water mark after it
+    vector<double> growthKb;     // how much the pass raised the mark
+    vector<double> childPeakKb;  // the largest child process, if any
+};
+
+/**
+ * The measurements of one size in one mode.
+ */
+struct Measurement
+{
+    string mode;
+    long statements = 0;
+    long lines = 0;
+    bool ok = true;
+    string error;
+    map<string, PassTiming> passes;
+};
+
+/**
+ * Split a comma-separated list.
+ * @param text the list.
+ * @return the items.
+ */
+static vector<string> split(const string& text)
+{
+    vector<string> items;
+    stringstream stream(text);
+    string item;
+
+    while (getline(stream, item, ',')) if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+/**
+ * Find the timing line that -timing prints for a pass, such as
+ * "Timing: PASS 2 12.345 ms, peak memory 4567 KB, children 0 KB".
+ * @param output the PascalCpp output.
+ * @param pass the pass name.
+ * @param ms set to the time of the pass.
+ * @param peakKb set to the peak memory after the pass.
+ * @param childKb set to the peak memory of any child process.
+ * @return true if found.
+ */
+static bool findTiming(const string& output, const string& pass,
+                       double& ms, double& peakKb, double& childKb)
+{
+    string label = "Timing: " + pass + " ";
+    size_t pos = output.rfind(label);
+    if (pos == string::npos) return false;
+
+    long peak = 0, child = 0;
+    if (sscanf(output.c_str() + pos + label.length(),
+               "%lf ms, peak memory %ld KB, children %ld KB",
+               &ms, &peak, &child) != 3)
+    {
+        return false;
+    }
+
+    peakKb = peak;
+    childKb = child;
+    return true;
+}
+
+/**
+ * Generate the program of one size.
+ * @param settings the scaling settings.
+ * @param statements the number of statements.
+ * @param path set to the absolute path of the program.
+ * @param lines set to the number of lines of the program.
+ * @return true if generated.
+ */
+static bool generate(const Settings& settings, long statements,
+                     string& path, long& lines)
+{
+    GeneratorSettings shape;
+    shape.statements      = statements;
+    shape.depth           = settings.depth;
+    shape.routines        = (int) (statements/settings.routineSize);
+    shape.expressionDepth = settings.expressionDepth;
+    shape.arraySize       = settings.arraySize;
+    shape.name            = "Scaling" + to_string(statements);
+
+    path = settings.workDir + "/" + shape.name + ".pas";
+    ofstream out(path);
+    if (!out.is_open()) return false;
+
+    ProgramGenerator(shape).generate(out);
+    out.close();
+
+    ifstream in(path);
+    lines = count(istreambuf_iterator<char>(in),
+                  istreambuf_iterator<char>(), '\n');
+
+    path = absolutePath(path);
+    return true;
+}
+
+/**
+ * Run one size in one mode and record the timing of each pass.
+ * @param settings the scaling settings.
+ * @param path the absolute path of the program.
+ * @param m the measurement to fill.
+ */
+static void measure(const Settings& settings, const string& path,
+                    Measurement& m)
+{
+    vector<string> argv = { settings.pascal, "-" + m.mode, "-timing", path };
+
+    // With no breakpoints set, the debugger runs to the end after "go".
+    string input = m.mode == "debug" ? "go\nquit\n" : "";
+
+    for (int run = 0; run < settings.runs; run++)
+    {
+        ProcessResult result = runProcess(argv, input, settings.workDir,
+                                          settings.timeout);
+        if (!result.succeeded())
+        {
+            m.ok = false;
+            m.error = describeFailure(result);
+            return;
+        }
+
+        double previousKb = 0;
+        for (const string& pass : PASSES)
+        {
+            double ms, peakKb, childKb;
+            if (!findTiming(result.output, pass, ms, peakKb, childKb))
+            {
+                m.ok = false;
+                m.error = "no timing for " + pass;
+                return;
+            }
+
+            PassTiming& t = m.passes[pass];
+            t.ms.push_back(ms);
+            t.peakKb.push_back(peakKb);
+            t.growthKb.push_back(max(peakKb - previousKb, 0.0));
+            t.childPeakKb.push_back(childKb);
+
+            previousKb = peakKb;
+        }
+    }
+}
+
+/**
+ * The growth exponent of a metric between two sizes: 1 if it grows
+ * in proportion to the lines, 2 if with their square.
+ * @return the exponent, or NAN if either value is too small to tell.
+ */
+static double exponent(double value1, double value2, long lines1, long lines2)
+{
+    if ((value1 < 1) || (value2 < 1) || (lines1 >= lines2)) return NAN;
+    return log(value2/value1)/log((double) lines2/lines1);
+}
+
+/**
+ * Format a growth exponent for the report.
+ * @param value the exponent.
+ * @return the formatted exponent, or "-" if there is none.
+ */
+static string formatExponent(double value)
+{
+    if (std::isnan(value)) return "-";
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.2f", value);
+    return buffer;
+}
+
+/**
+ * Write the measurements as JSON.
+ * @param path the file to write.
+ * @param measurements the measurements.
+ * @return true if written.
+ */
+static bool writeResults(const string& path,
+                         const vector<Measurement>& measurements)
+{
+    ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "{\n  \"results\": [";
+
+    for (size_t i = 0; i < measurements.size(); i++)
+    {
+        const Measurement& m = measurements[i];
+
+        out << (i > 0 ? "," : "") << "\n    { \"mode\": "
+            << jsonQuote(m.mode) << ", \"statements\": " << m.statements
+            << ", \"lines\": " << m.lines;
+
+        if (!m.ok) out << ", \"error\": " << jsonQuote(m.error);
+        else
+        {
+            out << ", \"passes\": {";
+
+            for (size_t p = 0; p < PASSES.size(); p++)
+            {
+                const PassTiming& t = m.passes.at(PASSES[p]);
+                char buffer[200];
+
+                snprintf(buffer, sizeof(buffer),
+                         "\"ms\": %.3f, \"peak_kb\": %.0f, "
+                         "\"growth_kb\": %.0f, \"child_peak_kb\": %.0f",
+                         median(t.ms), median(t.peakKb),
+                         median(t.growthKb), median(t.childPeakKb));
+
+                out << (p > 0 ? ", " : " ") << jsonQuote(PASSES[p])
+                    << ": { " << buffer << " }";
+            }
+
+            out << " }";
+        }
+
+        out << " }";
+    }
+
+    out << "\n  ]\n}\n";
+    return out.good();
+}
+
+/**
+ * Parse the command line.
+ * @param argc the argument count.
+ * @param args the arguments.
+ * @param settings the settings to fill.
+ * @return true if valid.
+ */
+static bool parseArguments(int argc, const char *args[], Settings& settings)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = args[i];
+        bool hasValue = i + 1 < argc;
+
+        if      (arg == "--pascal"     && hasValue) settings.pascal = args[++i];
+        else if (arg == "--modes"      && hasValue) settings.modes = split(args[++i]);
+        else if (arg == "--runs"       && hasValue) settings.runs = atoi(args[++i]);
+        else if (arg == "--depth"      && hasValue) settings.depth = atoi(args[++i]);
+        else if (arg == "--routine"    && hasValue) settings.routineSize = atoi(args[++i]);
+        else if (arg == "--expression" && hasValue) settings.expressionDepth = atoi(args[++i]);
+        else if (arg == "--array"      && hasValue) settings.arraySize = atoi(args[++i]);
+        else if (arg == "--timeout"    && hasValue) settings.timeout = atof(args[++i]);
+        else if (arg == "--workdir"    && hasValue) settings.workDir = args[++i];
+        else if (arg == "--output"     && hasValue) settings.outputFile = args[++i];
+        else if (arg == "--limit"      && hasValue) settings.limit = atof(args[++i]);
+        else if (arg == "--sizes"      && hasValue)
+        {
+            settings.sizes.clear();
+            for (const string& size : split(args[++i]))
+            {
+                settings.sizes.push_back(atol(size.c_str()));
+            }
+        }
+        else
+        {
+            cout << "ERROR: Invalid option \"" << arg << "\"." << endl;
+            return false;
+        }
+    }
+
+    sort(settings.sizes.begin(), settings.sizes.end());
+
+    return    (settings.runs > 0) && (settings.routineSize > 0)
+           && !settings.sizes.empty() && (settings.sizes[0] > 0);
+}
+
+int main(int argc, const char *args[])
+{
+    Settings settings;
+    if (!parseArguments(argc, args, settings))
+    {
+        cout << "USAGE: Scaling [--pascal PATH] [--sizes LIST] "
+             << "[--modes LIST] [--runs N] [--depth N] [--routine N] "
+             << "[--expression N] [--array N] [--timeout SECONDS] "
+             << "[--workdir DIR] [--output FILE] [--limit EXPONENT]"
+             << endl;
+        return 2;
+    }
+
+    settings.pascal = absolutePath(settings.pascal);
+    mkdir(settings.workDir.c_str(), 0755);
+
+    vector<string> paths;
+    vector<long> lines;
+
+    for (long size : settings.sizes)
+    {
+        string path;
+        long count;
+
+        if (!generate(settings, size, path, count))
+        {
+            cout << "ERROR: Failed to generate a program in \""
+                 << settings.workDir << "\"." << endl;
+            return 2;
+        }
+
+        paths.push_back(path);
+        lines.push_back(count);
+    }
+
+    vector<Measurement> measurements;
+    int flagged = 0;
+
+    for (const string& mode : settings.modes)
+    {
+        cout << endl << "===== -" << mode << " =====" << endl << endl;
+        printf("%-8s %9s %12s %12s %10s %10s  %s\n", "Pass", "Lines", "ms",
+               "Growth KB", "Time exp", "Mem exp", "");
+        printf("%-8s %9s %12s %12s %10s %10s\n", "----", "-----", "--",
+               "---------", "--------", "-------");
+
+        vector<Measurement> row;
+
+        for (size_t s = 0; s < settings.sizes.size(); s++)
+        {
+            Measurement m;
+            m.mode = mode;
+            m.statements = settings.sizes[s];
+            m.lines = lines[s];
+
+            measure(settings, paths[s], m);
+            row.push_back(m);
+            measurements.push_back(m);
+
+            if (!m.ok)
+            {
+                printf("%-8s %9ld  %s\n", "FAILED", m.lines, m.error.c_str());
+            }
+        }
+
+        for (const string& pass : PASSES)
+        {
+            const Measurement *previous = nullptr;
+
+            for (const Measurement& m : row)
+            {
+                if (!m.ok) { previous = nullptr; continue; }
+
+                const PassTiming& t = m.passes.at(pass);
+                double ms = median(t.ms);
+                double kb = median(t.growthKb);
+                double timeExp = NAN, memExp = NAN;
+
+                if (previous != nullptr)
+                {
+                    const PassTiming& p = previous->passes.at(pass);
+                    timeExp = exponent(median(p.ms), ms,
+                                       previous->lines, m.lines);
+                    memExp  = exponent(median(p.growthKb), kb,
+                                       previous->lines, m.lines);
+                }
+
+                bool superlinear =    (timeExp > settings.limit)
+                                   || (memExp > settings.limit);
+                if (superlinear) flagged++;
+
+                printf("%-8s %9ld %12.3f %12.0f %10s %10s  %s\n",
+                       pass.c_str(), m.lines, ms, kb,
+                       formatExponent(timeExp).c_str(),
+                       formatExponent(memExp).c_str(),
+                       superlinear ? "SUPERLINEAR" : "");
+
+                previous = &m;
+            }
+        }
+    }
+
+    if (!writeResults(settings.outputFile, measurements))
+    {
+        cout << "ERROR: Failed to write \"" << settings.outputFile << "\"."
+             << endl;
+        return 2;
+    }
+
+    printf("\n%d size step%s of a pass grew faster than lines^%.2f. "
+           "Results written to \"%s\".\n",
+           flagged, flagged == 1 ? "" : "s", settings.limit,
+           settings.outputFile.c_str());
+    return flagged > 0 ? 1 : 0;
+}
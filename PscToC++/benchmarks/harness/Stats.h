@@ -0,0 +1,58 @@
+/**
+ * <h1>Stats</h1>
+ *
+ * <p>Robust summary statistics of repeated benchmark measurements.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef BENCHMARKS_STATS_H_
+#define BENCHMARKS_STATS_H_
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace benchmarks {
+
+using namespace std;
+
+/**
+ * Compute the median of a sample.
+ * @param samples the sample, which need not be sorted.
+ * @return the median, or 0 if the sample is empty.
+ */
+inline double median(vector<double> samples)
+{
+    if (samples.empty()) return 0;
+
+    sort(samples.begin(), samples.end());
+    size_t mid = samples.size()/2;
+
+    return (samples.size()%2 == 1) ? samples[mid]
+                                   : (samples[mid - 1] + samples[mid])/2;
+}
+
+/**
+ * Compute the median absolute deviation of a sample. Unlike the standard
+ * deviation, a single outlier run (a page cache miss, a context switch)
+ * barely moves it.
+ * @param samples the sample.
+ * @return the median absolute deviation.
+ */
+inline double medianAbsoluteDeviation(const vector<double>& samples)
+{
+    double center = median(samples);
+    vector<double> deviations;
+
+    for (double sample : samples) deviations.push_back(fabs(sample - center));
+    return median(deviations);
+}
+
+/**
+ * The MAD scaled to estimate the standard deviation of normal noise.
+ */
+constexpr double MAD_TO_SIGMA = 1.4826;
+
+} // namespace benchmarks
+
+#endif /* BENCHMARKS_STATS_H_ */
@@ -0,0 +1,61 @@
+/**
+ * <h1>CellValue</h1>
+ *
+ * <p>Microbenchmark of Cell::setValue and Cell::getValue, which hold
+ * each runtime value as an Object (antlrcpp::Any).</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include <string>
+
+#include "MicroBenchmark.h"
+
+#include "backend/interpreter/Cell.h"
+
+using namespace benchmarks::micro;
+using namespace backend::interpreter;
+
+int main()
+{
+    printHeading("Cell::setValue and Cell::getValue");
+
+    Cell cell(0);
+
+    measure("setValue(int)",
+        [&](long n) {
+            for (long i = 0; i < n; i++) cell.setValue((int) i);
+        });
+
+    measure("setValue(double)",
+        [&](long n) {
+            for (long i = 0; i < n; i++) cell.setValue((double) i);
+        });
+
+    cell.setValue(42);
+    measure("getValue().as<int>()",
+        [&](long n) {
+            for (long i = 0; i < n; i++) keep(cell.getValue().as<int>());
+        });
+
+    measure("getValue().as<int>() + 1, then setValue",
+        [&](long n) {
+            for (long i = 0; i < n; i++)
+            {
+                int value = cell.getValue().as<int>();
+                cell.setValue(value + 1);
+            }
+        });
+
+    // The interpreter stores a string value as a heap-allocated string.
+    cell.setValue(new string("hello, world"));
+    measure("getValue() of a string *, copied out",
+        [&](long n) {
+            for (long i = 0; i < n; i++)
+            {
+                string text = *(cell.getValue().as<string *>());
+                keep(text);
+            }
+        });
+
+    return 0;
+}
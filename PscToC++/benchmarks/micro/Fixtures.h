@@ -0,0 +1,98 @@
+/**
+ * <h1>Fixtures</h1>
+ *
+ * <p>Symbol tables and types for the runtime microbenchmarks, built
+ * directly rather than by parsing a program.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef BENCHMARKS_FIXTURES_H_
+#define BENCHMARKS_FIXTURES_H_
+
+#include <string>
+#include <vector>
+
+#include "intermediate/symtab/Symtab.h"
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/type/Typespec.h"
+
+namespace benchmarks { namespace micro {
+
+using namespace std;
+using namespace intermediate::symtab;
+using namespace intermediate::type;
+
+/**
+ * Variable names like those of typical Pascal programs. Two are longer
+ * than the 15 characters that std::string stores without allocating.
+ */
+static const vector<string> VARIABLE_NAMES =
+{
+    "i", "j", "count", "sum", "total", "x", "y",
+    "numberofiterations", "accumulatedresult",
+};
+
+/**
+ * Create a scalar type such as integer.
+ * @return the type.
+ */
+inline Typespec *scalarType()
+{
+    static Typespec *type = new Typespec(SCALAR);
+    return type;
+}
+
+/**
+ * Create an integer array type.
+ * @param count the element count.
+ * @return the type.
+ */
+inline Typespec *arrayType(int count)
+{
+    Typespec *indexType = new Typespec(SUBRANGE);
+    indexType->setSubrangeBaseType(scalarType());
+    indexType->setSubrangeMinValue(1);
+    indexType->setSubrangeMaxValue(count);
+
+    Typespec *type = new Typespec(ARRAY);
+    type->setArrayIndexType(indexType);
+    type->setArrayElementType(scalarType());
+    type->setArrayElementCount(count);
+
+    return type;
+}
+
+/**
+ * Enter scalar variables into a symbol table.
+ * @param symtab the symbol table.
+ * @param names the variable names.
+ * @param prefix a prefix for each name.
+ */
+inline void enterVariables(Symtab *symtab, const vector<string>& names,
+                           const string& prefix = "")
+{
+    for (const string& name : names)
+    {
+        SymtabEntry *id = symtab->enter(prefix + name, VARIABLE);
+        id->setType(scalarType());
+    }
+}
+
+/**
+ * Create a procedure identifier that owns a symbol table.
+ * @param name the procedure name.
+ * @param symtab the symbol table.
+ * @return the procedure's symbol table entry.
+ */
+inline SymtabEntry *routine(const string& name, Symtab *symtab)
+{
+    SymtabEntry *routineId = new SymtabEntry(name, PROCEDURE, nullptr);
+    routineId->setRoutineSymtab(symtab);
+    symtab->setOwner(routineId);
+
+    return routineId;
+}
+
+}}  // namespace benchmarks::micro
+
+#endif /* BENCHMARKS_FIXTURES_H_ */
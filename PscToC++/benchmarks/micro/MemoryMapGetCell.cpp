@@ -0,0 +1,55 @@
+/**
+ * <h1>MemoryMapGetCell</h1>
+ *
+ * <p>Microbenchmark of MemoryMap::getCell, which the interpreter calls
+ * for every variable reference.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include "MicroBenchmark.h"
+#include "Fixtures.h"
+
+#include "backend/interpreter/MemoryMap.h"
+
+using namespace benchmarks::micro;
+using namespace backend::interpreter;
+
+int main()
+{
+    printHeading("MemoryMap::getCell");
+
+    Symtab symtab(1);
+    enterVariables(&symtab, VARIABLE_NAMES);
+    MemoryMap memoryMap(&symtab);
+
+    vector<SymtabEntry *> entries = symtab.sortedEntries();
+    size_t count = entries.size();
+
+    vector<string> names;
+    for (SymtabEntry *entry : entries) names.push_back(entry->getName());
+
+    measure("getCell, short names",
+        [&](long n) {
+            for (long i = 0; i < n; i++)
+            {
+                keep(memoryMap.getCell(names[i%(count - 2)]));
+            }
+        });
+
+    measure("getCell, all names",
+        [&](long n) {
+            for (long i = 0; i < n; i++) keep(memoryMap.getCell(names[i%count]));
+        });
+
+    // The interpreter copies each name out of its symbol table entry.
+    measure("getCell, name copied from the symbol table entry",
+        [&](long n) {
+            for (long i = 0; i < n; i++)
+            {
+                string name = entries[i%count]->getName();
+                keep(memoryMap.getCell(name));
+            }
+        });
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * <h1>MicroBenchmark</h1>
+ *
+ * <p>A minimal timing loop for the interpreter runtime microbenchmarks.
+ * It reports the median nanoseconds and heap allocations per operation
+ * over several trials. Allocations are counted by replacing the global
+ * operator new, so include this header in exactly one translation unit:
+ * each benchmark is a single file of its own.</p>
+ *
+ * <p>Each benchmark is a target of benchmarks/micro/Makefile, which
+ * links it with the runtime sources it needs. From the PscToC++
+ * directory:</p>
+ *
+ * <pre>
+ *   make -C benchmarks/micro MemoryMapGetCell
+ *   benchmarks/micro/build/MemoryMapGetCell
+ * </pre>
+ *
+ * <p>or build and run all of them:</p>
+ *
+ * <pre>
+ *   make -C benchmarks/micro run
+ * </pre>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef BENCHMARKS_MICROBENCHMARK_H_
+#define BENCHMARKS_MICROBENCHMARK_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace benchmarks { namespace micro {
+
+using namespace std;
+using namespace std::chrono;
+
+long allocationCount = 0;  // heap allocations so far
+
+/**
+ * Keep the compiler from optimizing away a value that is never used.
+ * @param value the value.
+ */
+template<typename T>
+inline void keep(T const& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Measure an operation and print its cost.
+ * @param name the name of the operation.
+ * @param body a function that performs the operation a given number
+ *             of times.
+ */
+template<typename Body>
+void measure(const string& name, Body body)
+{
+    const int TRIALS = 7;
+    const double MIN_TRIAL_NS = 50e6;  // 50 milliseconds
+
+    // Find an iteration count that makes a trial long enough to time.
+    long iterations = 1;
+    while (true)
+    {
+        auto start = steady_clock::now();
+        body(iterations);
+        double ns = duration<double, nano>(steady_clock::now() - start).count();
+
+        if (ns >= MIN_TRIAL_NS) break;
+
+        double scale = ns > 0 ? 1.5*MIN_TRIAL_NS/ns : 100;
+        iterations = (long) (iterations*min(max(scale, 2.0), 100.0));
+    }
+
+    vector<double> nsPerOp;
+    vector<double> allocsPerOp;
+
+    for (int trial = 0; trial < TRIALS; trial++)
+    {
+        long allocations = allocationCount;
+        auto start = steady_clock::now();
+
+        body(iterations);
+
+        double ns = duration<double, nano>(steady_clock::now() - start).count();
+        nsPerOp.push_back(ns/iterations);
+        allocsPerOp.push_back((double) (allocationCount - allocations)
+                              /iterations);
+    }
+
+    sort(nsPerOp.begin(), nsPerOp.end());
+    sort(allocsPerOp.begin(), allocsPerOp.end());
+
+    printf("%-52s %10.1f ns/op %8.2f allocs/op\n", name.c_str(),
+           nsPerOp[TRIALS/2], allocsPerOp[TRIALS/2]);
+}
+
+/**
+ * Print the column headings.
+ * @param title the benchmark title.
+ */
+inline void printHeading(const string& title)
+{
+    printf("%s\n\n", title.c_str());
+    printf("%-52s %16s %18s\n", "Operation", "Time", "Allocations");
+    printf("%-52s %16s %18s\n", "---------", "----", "-----------");
+}
+
+}}  // namespace benchmarks::micro
+
+// Count every heap allocation.
+
+void *operator new(size_t size)
+{
+    benchmarks::micro::allocationCount++;
+
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    benchmarks::micro::allocationCount++;
+
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+#endif /* BENCHMARKS_MICROBENCHMARK_H_ */
@@ -0,0 +1,52 @@
+/**
+ * <h1>RuntimeDisplayUpdate</h1>
+ *
+ * <p>Microbenchmark of RuntimeDisplay::callUpdate and returnUpdate,
+ * which the interpreter does for every call and return.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include "MicroBenchmark.h"
+#include "Fixtures.h"
+
+#include "backend/interpreter/RuntimeDisplay.h"
+
+using namespace benchmarks::micro;
+using namespace backend::interpreter;
+
+int main()
+{
+    printHeading("RuntimeDisplay::callUpdate and returnUpdate");
+
+    Symtab programSymtab(1);
+    Symtab procSymtab(2);
+    StackFrame programFrame(routine("program", &programSymtab));
+    StackFrame procFrame(routine("proc", &procSymtab));
+    StackFrame recursiveFrame(routine("proc", &procSymtab));
+
+    RuntimeDisplay display;
+    display.callUpdate(1, &programFrame);
+
+    // A call to a routine one level deeper, such as from the main program.
+    measure("call and return, new nesting level",
+        [&](long n) {
+            for (long i = 0; i < n; i++)
+            {
+                display.callUpdate(2, &procFrame);
+                display.returnUpdate(2);
+            }
+        });
+
+    // A recursive call, which backlinks to the frame at the same level.
+    display.callUpdate(2, &procFrame);
+    measure("call and return, same nesting level (recursion)",
+        [&](long n) {
+            for (long i = 0; i < n; i++)
+            {
+                display.callUpdate(2, &recursiveFrame);
+                display.returnUpdate(2);
+            }
+        });
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * <h1>StackFrameCreate</h1>
+ *
+ * <p>Microbenchmark of StackFrame construction from a routine's symbol
+ * table, which the interpreter does for every procedure and function
+ * call.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include "MicroBenchmark.h"
+#include "Fixtures.h"
+
+#include "backend/interpreter/StackFrame.h"
+
+using namespace benchmarks::micro;
+using namespace backend::interpreter;
+
+int main()
+{
+    printHeading("StackFrame construction");
+
+    Symtab emptySymtab(1);
+    SymtabEntry *emptyId = routine("empty", &emptySymtab);
+
+    Symtab scalarSymtab(1);
+    enterVariables(&scalarSymtab, { "n", "i", "sum" });
+    SymtabEntry *scalarId = routine("scalars", &scalarSymtab);
+
+    Symtab mixedSymtab(1);
+    enterVariables(&mixedSymtab, VARIABLE_NAMES);
+    mixedSymtab.enter("table", VARIABLE)->setType(arrayType(10));
+    SymtabEntry *mixedId = routine("mixed", &mixedSymtab);
+
+    measure("StackFrame, no locals",
+        [&](long n) {
+            for (long i = 0; i < n; i++) delete new StackFrame(emptyId);
+        });
+
+    measure("StackFrame, 3 scalars",
+        [&](long n) {
+            for (long i = 0; i < n; i++) delete new StackFrame(scalarId);
+        });
+
+    // Deleting the frame frees the map's cells but not the array's.
+    measure("StackFrame, 9 scalars and a 10-element array",
+        [&](long n) {
+            for (long i = 0; i < n; i++) delete new StackFrame(mixedId);
+        });
+
+    return 0;
+}
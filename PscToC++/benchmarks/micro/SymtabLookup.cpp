@@ -0,0 +1,50 @@
+/**
+ * <h1>SymtabLookup</h1>
+ *
+ * <p>Microbenchmark of Symtab::lookup, which the semantic pass calls
+ * for every identifier.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include "MicroBenchmark.h"
+#include "Fixtures.h"
+
+using namespace benchmarks::micro;
+
+int main()
+{
+    printHeading("Symtab::lookup");
+
+    const vector<int> SIZES = { 8, 64, 512 };
+
+    for (int size : SIZES)
+    {
+        Symtab symtab(1);
+        vector<string> names;
+
+        for (int i = 0; i < size; i++)
+        {
+            names.push_back(VARIABLE_NAMES[i%VARIABLE_NAMES.size()]
+                            + to_string(i));
+        }
+        enterVariables(&symtab, names);
+
+        measure("lookup, found, " + to_string(size) + " entries",
+            [&](long n) {
+                for (long i = 0; i < n; i++)
+                {
+                    keep(symtab.lookup(names[i%size]));
+                }
+            });
+
+        measure("lookup, not found, " + to_string(size) + " entries",
+            [&](long n) {
+                for (long i = 0; i < n; i++)
+                {
+                    keep(symtab.lookup("missing"));
+                }
+            });
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * <h1>SymtabStackLookup</h1>
+ *
+ * <p>Microbenchmark of SymtabStack::lookup, which searches the local
+ * scope and then each enclosing scope in turn.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#include "MicroBenchmark.h"
+#include "Fixtures.h"
+
+#include "intermediate/symtab/SymtabStack.h"
+
+using namespace benchmarks::micro;
+
+int main()
+{
+    printHeading("SymtabStack::lookup");
+
+    const int DEPTH = 4;
+
+    // Level 0 holds the predefined identifiers; give each level
+    // some entries of its own, like nested routines would have.
+    SymtabStack symtabStack;
+    enterVariables(symtabStack.getLocalSymtab(),
+                   { "integer", "real", "boolean", "char", "string",
+                     "true", "false", "writeln", "readln", "sqrt" });
+
+    for (int level = 1; level <= DEPTH; level++)
+    {
+        symtabStack.push();
+        enterVariables(symtabStack.getLocalSymtab(), VARIABLE_NAMES,
+                       "l" + to_string(level));
+    }
+
+    for (int level = DEPTH; level >= 0; level--)
+    {
+        string name = level == 0 ? "integer"
+                                 : "l" + to_string(level) + "count";
+
+        measure("lookup from level " + to_string(DEPTH) + ", found at level "
+                    + to_string(level),
+            [&](long n) {
+                for (long i = 0; i < n; i++) keep(symtabStack.lookup(name));
+            });
+    }
+
+    measure("lookup from level " + to_string(DEPTH) + ", not found",
+        [&](long n) {
+            for (long i = 0; i < n; i++) keep(symtabStack.lookup("missing"));
+        });
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+PROGRAM DeepRecursion;
+
+{ Deep procedure recursion with VAR and value parameters:
+  stack frame creation and nonlocal variable access. }
+
+CONST
+    depth = 500;
+    rounds = 40;
+
+VAR
+    total, round : integer;
+
+PROCEDURE descend(level : integer; VAR sum : integer);
+    BEGIN
+        sum := sum + level mod 7;
+        IF level > 0 THEN descend(level - 1, sum)
+    END;
+
+BEGIN
+    total := 0;
+
+    FOR round := 1 TO rounds DO descend(depth, total);
+
+    writeln('Total: ', total:0)
+END.
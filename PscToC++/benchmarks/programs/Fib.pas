@@ -0,0 +1,18 @@
+PROGRAM Fib;
+
+{ Naive recursive Fibonacci: function call and stack frame overhead. }
+
+VAR
+    i : integer;
+
+FUNCTION fib(n : integer) : integer;
+    BEGIN
+        IF n < 2 THEN fib := n
+        ELSE fib := fib(n - 1) + fib(n - 2)
+    END;
+
+BEGIN
+    FOR i := 20 TO 24 DO BEGIN
+        writeln('fib(', i:0, ') = ', fib(i):0)
+    END
+END.
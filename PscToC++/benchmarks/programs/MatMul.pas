@@ -0,0 +1,33 @@
+PROGRAM MatMul;
+
+{ Dense matrix multiply: two-dimensional array subscripting. }
+
+CONST
+    n = 40;
+
+VAR
+    a, b, c : ARRAY [1..n, 1..n] OF real;
+    i, j, k : integer;
+    sum, trace : real;
+
+BEGIN
+    FOR i := 1 TO n DO BEGIN
+        FOR j := 1 TO n DO BEGIN
+            a[i, j] := (i + j) mod 7;
+            b[i, j] := (i*j) mod 5 - 2
+        END
+    END;
+
+    FOR i := 1 TO n DO BEGIN
+        FOR j := 1 TO n DO BEGIN
+            sum := 0;
+            FOR k := 1 TO n DO sum := sum + a[i, k]*b[k, j];
+            c[i, j] := sum
+        END
+    END;
+
+    trace := 0;
+    FOR i := 1 TO n DO trace := trace + c[i, i];
+
+    writeln('Trace: ', trace:0:1)
+END.
@@ -0,0 +1,102 @@
+PROGRAM NBody;
+
+{ Planar n-body simulation: record field access and real arithmetic. }
+
+CONST
+    bodyCount = 5;
+    steps = 600;
+    dt = 0.01;
+
+TYPE
+    Body = RECORD
+               x, y, vx, vy, mass : real
+           END;
+
+VAR
+    bodies : ARRAY [1..bodyCount] OF Body;
+    i, step : integer;
+    e : real;
+
+FUNCTION root(x : real) : real;
+    VAR
+        r, prev, diff : real;
+
+    BEGIN
+        r := 1;
+        prev := 0;
+
+        REPEAT
+            r := (x/r + r)/2;
+            diff := r - prev;
+            IF diff < 0 THEN diff := -diff;
+            prev := r
+        UNTIL diff < 1.0e-9;
+
+        root := r
+    END;
+
+PROCEDURE initialize;
+    VAR
+        k : integer;
+
+    BEGIN
+        FOR k := 1 TO bodyCount DO BEGIN
+            bodies[k].x    := k;
+            bodies[k].y    := k*0.5 - 1;
+            bodies[k].vx   := 0.1*k;
+            bodies[k].vy   := -0.05*k;
+            bodies[k].mass := 1 + k/10
+        END
+    END;
+
+PROCEDURE advance;
+    VAR
+        a, b : integer;
+        dx, dy, d2, mag : real;
+
+    BEGIN
+        FOR a := 1 TO bodyCount DO BEGIN
+            FOR b := a + 1 TO bodyCount DO BEGIN
+                dx := bodies[a].x - bodies[b].x;
+                dy := bodies[a].y - bodies[b].y;
+                d2 := dx*dx + dy*dy + 0.01;
+                mag := dt/(d2*root(d2));
+
+                bodies[a].vx := bodies[a].vx - dx*bodies[b].mass*mag;
+                bodies[a].vy := bodies[a].vy - dy*bodies[b].mass*mag;
+                bodies[b].vx := bodies[b].vx + dx*bodies[a].mass*mag;
+                bodies[b].vy := bodies[b].vy + dy*bodies[a].mass*mag
+            END
+        END;
+
+        FOR a := 1 TO bodyCount DO BEGIN
+            bodies[a].x := bodies[a].x + dt*bodies[a].vx;
+            bodies[a].y := bodies[a].y + dt*bodies[a].vy
+        END
+    END;
+
+FUNCTION energy : real;
+    VAR
+        a : integer;
+        sum : real;
+
+    BEGIN
+        sum := 0;
+        FOR a := 1 TO bodyCount DO BEGIN
+            sum := sum + 0.5*bodies[a].mass*(  bodies[a].vx*bodies[a].vx
+                                             + bodies[a].vy*bodies[a].vy)
+        END;
+        energy := sum
+    END;
+
+BEGIN
+    initialize();
+    writeln('Kinetic energy before: ', energy():12:9);
+
+    FOR step := 1 TO steps DO advance();
+
+    writeln('Kinetic energy after:  ', energy():12:9);
+    FOR i := 1 TO bodyCount DO BEGIN
+        writeln('Body ', i:0, ': ', bodies[i].x:10:5, bodies[i].y:10:5)
+    END
+END.
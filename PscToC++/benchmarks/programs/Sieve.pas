@@ -0,0 +1,36 @@
+PROGRAM Sieve;
+
+{ Sieve of Eratosthenes: array indexing and tight nested loops. }
+
+CONST
+    n = 50000;
+    rounds = 4;
+
+VAR
+    composite : ARRAY [2..n] OF boolean;
+    i, j, round, count : integer;
+
+BEGIN
+    FOR round := 1 TO rounds DO BEGIN
+        FOR i := 2 TO n DO composite[i] := false;
+
+        i := 2;
+        WHILE i*i <= n DO BEGIN
+            IF NOT composite[i] THEN BEGIN
+                j := i*i;
+                WHILE j <= n DO BEGIN
+                    composite[j] := true;
+                    j := j + i
+                END
+            END;
+            i := i + 1
+        END;
+
+        count := 0;
+        FOR i := 2 TO n DO BEGIN
+            IF NOT composite[i] THEN count := count + 1
+        END
+    END;
+
+    writeln('Primes up to ', n:0, ': ', count:0)
+END.
@@ -0,0 +1,67 @@
+PROGRAM StateMachine;
+
+{ A tokenizer-like state machine driven by CASE statements
+  over a pseudo-random input stream. }
+
+CONST
+    inputLength = 30000;
+
+VAR
+    seed, state, symbol, i : integer;
+    words, numbers, others : integer;
+
+FUNCTION nextSymbol : integer;
+    BEGIN
+        seed := (seed*1103 + 12345) mod 32768;
+        nextSymbol := seed mod 4
+    END;
+
+BEGIN
+    seed := 42;
+    state := 0;
+    words := 0;
+    numbers := 0;
+    others := 0;
+
+    FOR i := 1 TO inputLength DO BEGIN
+        symbol := nextSymbol();
+
+        { Symbols: 0 = letter, 1 = digit, 2 = blank, 3 = punctuation }
+        CASE state OF
+            0: CASE symbol OF
+                   0: state := 1;
+                   1: state := 2;
+                   2: state := 0;
+                   3: others := others + 1
+               END;
+
+            1: CASE symbol OF
+                   0, 1: state := 1;
+                   2, 3: BEGIN
+                             words := words + 1;
+                             state := 0
+                         END
+               END;
+
+            2: CASE symbol OF
+                   1:    state := 2;
+                   0:    state := 3;
+                   2, 3: BEGIN
+                             numbers := numbers + 1;
+                             state := 0
+                         END
+               END;
+
+            3: CASE symbol OF
+                   0, 1: state := 3;
+                   2, 3: BEGIN
+                             others := others + 1;
+                             state := 0
+                         END
+               END
+        END
+    END;
+
+    writeln('Words: ', words:0, ', numbers: ', numbers:0,
+            ', others: ', others:0)
+END.
@@ -0,0 +1,35 @@
+PROGRAM Strings;
+
+{ String building and comparison: string values and their copies. }
+
+CONST
+    rounds = 300;
+    pieces = 40;
+
+VAR
+    s, t, longest : string;
+    round, i, matches : integer;
+
+BEGIN
+    longest := '';
+    matches := 0;
+
+    FOR round := 1 TO rounds DO BEGIN
+        s := '';
+        t := '';
+
+        FOR i := 1 TO pieces DO BEGIN
+            IF i mod 3 = 0 THEN s := s + 'ab'
+            ELSE IF i mod 3 = 1 THEN s := s + 'cd'
+            ELSE s := s + 'ef';
+
+            t := 'ef' + t
+        END;
+
+        IF s = t THEN matches := matches + 1;
+        IF s > longest THEN longest := s
+    END;
+
+    writeln('Matches: ', matches:0);
+    writeln('Greatest: ', longest)
+END.
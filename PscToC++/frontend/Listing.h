@@ -2,10 +2,11 @@
 #define LISTING_H_
 
 #include <iostream>
-#include <fstream>
 #include <iomanip>
 #include <string>
 
+#include "SourceBuffer.h"
+
 namespace frontend {
 
 using namespace std;
@@ -13,31 +14,24 @@ using namespace std;
 class Listing
 {
 public:
-    Listing(string sourceFileName);
+    Listing(const SourceBuffer& source);
     virtual ~Listing() {}
 };
 
-inline Listing::Listing(string sourceFileName)
+inline Listing::Listing(const SourceBuffer& source)
 {
-    ifstream ifs(sourceFileName);
+    int lineCount = source.getLineCount();
 
-    if (ifs.fail())
+    for (int lineNumber = 1; lineNumber <= lineCount; lineNumber++)
     {
-        cout << "ERROR: Failed to open source file \""
-             << sourceFileName << "\"." << endl;
-        exit(-1);
-    }
+        size_t lineLength;
+        const char *line = source.getLine(lineNumber, lineLength);
 
-    int lineNumber = 0;
-    string line;
-
-    while (getline(ifs, line))
-    {
-        cout << setw(3) << setfill('0') << ++lineNumber
-             << " " << line << endl;
+        cout << setw(3) << setfill('0') << lineNumber << " ";
+        cout.write(line, lineLength) << "\n";
     }
 
-    ifs.close();
+    cout.flush();
 }
 
 } // namespace frontend
@@ -0,0 +1,549 @@
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <algorithm>
+#include <functional>
+
+#include "antlr4-runtime.h"
+#include "PascalLexer.h"
+#include "PascalParser.h"
+
+#include "intermediate/symtab/Symtab.h"
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/type/Typespec.h"
+#include "intermediate/util/Arena.h"
+#include "SourceBuffer.h"
+#include "SyntaxErrorHandler.h"
+#include "Semantics.h"
+#include "ResidentProgram.h"
+
+namespace frontend {
+
+using namespace std;
+using namespace antlr4;
+using namespace intermediate::symtab;
+using namespace intermediate::type;
+using namespace intermediate::util;
+
+ResidentProgram::ResidentProgram(BackendMode mode, string sourceFileName)
+    : mode(mode), sourceFileName(sourceFileName), arena(new Arena()),
+      tree(nullptr), resident(false), updates(0), whole(true), changed(-1),
+      byteDelta(0), lineDelta(0), oldCtx(nullptr)
+{
+}
+
+const SourceBuffer& ResidentProgram::read()
+{
+    source.reset(new SourceBuffer(sourceFileName));
+    string newText(source->getText(), source->getLength());
+
+    whole = !resident || (updates >= MAX_UPDATES) || !findChange(newText);
+    text = newText;
+
+    return *source;
+}
+
+bool ResidentProgram::findChange(const string& newText)
+{
+    changed = -1;
+    if (newText == text) return true;
+
+    // The differences lie between the longest common prefix
+    // and the longest common suffix.
+    size_t oldLength = text.length();
+    size_t newLength = newText.length();
+    size_t prefix = mismatch(text.begin(), text.begin() + min(oldLength,
+                                                              newLength),
+                             newText.begin()).first - text.begin();
+    size_t limit = min(oldLength, newLength) - prefix;
+    size_t suffix = 0;
+
+    while (   (suffix < limit)
+           && (text[oldLength - 1 - suffix] == newText[newLength - 1 - suffix]))
+    {
+        suffix++;
+    }
+
+    size_t oldEnd = oldLength - suffix;
+    size_t newEnd = newLength - suffix;
+
+    for (int i = 0; i < (int) parts.size(); i++)
+    {
+        if ((parts[i].start <= prefix) && (oldEnd <= parts[i].end))
+        {
+            changed = i;
+            break;
+        }
+    }
+
+    if ((changed < 0) || !partsHaveOwnLines()) return false;
+
+    byteDelta = (long) newLength - (long) oldLength;
+    lineDelta = count(newText.begin() + prefix, newText.begin() + newEnd, '\n')
+              - count(text.begin() + prefix, text.begin() + oldEnd, '\n');
+
+    return true;
+}
+
+int ResidentProgram::parse()
+{
+    reparsed = "";
+    dependents.clear();
+
+    if (whole) return parseAll();
+    if (changed < 0)
+    {
+        reparsed = "nothing: the source is unchanged";
+        return 0;
+    }
+
+    return parseChange();
+}
+
+int ResidentProgram::parseAll()
+{
+    // Free the old parse trees before the symbol tables and types
+    // that their nodes point to.
+    pass2.reset();
+    parses.clear();
+    parts.clear();
+    tree = nullptr;
+    arena.reset(new Arena());
+
+    whole = true;
+    resident = false;
+    updates = 0;
+
+    // Unnamed types must be renamed the same way each time.
+    Symtab::resetUnnamedIndex();
+
+    Parse *all = new Parse(source->getText(), source->getLength());
+    parses.emplace_back(all);
+
+    // Custom syntax error handler.
+    SyntaxErrorHandler syntaxErrorHandler(source.get());
+    all->lexer.removeErrorListeners();
+    all->lexer.addErrorListener(&syntaxErrorHandler);
+    all->parser.removeErrorListeners();
+    all->parser.addErrorListener(&syntaxErrorHandler);
+
+    tree = all->parser.compilationUnit();
+
+    // The handler goes away, but the lexer and parser stay.
+    all->lexer.removeErrorListeners();
+    all->parser.removeErrorListeners();
+
+    return syntaxErrorHandler.getCount();
+}
+
+int ResidentProgram::parseChange()
+{
+    Part& part = parts[changed];
+    oldCtx = part.ctx;
+    size_t length = part.end + byteDelta - part.start;
+
+    Parse *change = new Parse(text.data() + part.start, length);
+    parses.emplace_back(change);
+
+    // Lex the part with its positions in the whole source text.
+    change->lexer.setLine(oldCtx->getStart()->getLine());
+    change->lexer.setCharPositionInLine(
+                                oldCtx->getStart()->getCharPositionInLine());
+
+    SyntaxErrorHandler syntaxErrorHandler(source.get());
+    change->lexer.removeErrorListeners();
+    change->lexer.addErrorListener(&syntaxErrorHandler);
+    change->parser.removeErrorListeners();
+    change->parser.addErrorListener(&syntaxErrorHandler);
+
+    PascalParser::RoutineDefinitionContext *oldDefnCtx =
+                dynamic_cast<PascalParser::RoutineDefinitionContext *>(oldCtx);
+    PascalParser::RoutineDefinitionContext *newDefnCtx = nullptr;
+    ParserRuleContext *newCtx;
+
+    if (oldDefnCtx != nullptr)
+    {
+        newDefnCtx = change->parser.routineDefinition();
+        newCtx = newDefnCtx;
+    }
+    else newCtx = change->parser.compoundStatement();
+
+    change->lexer.removeErrorListeners();
+    change->parser.removeErrorListeners();
+
+    // The resident tree is left as it was, and the next change
+    // is translated from the start.
+    int errorCount = syntaxErrorHandler.getCount();
+    if (errorCount > 0)
+    {
+        resident = false;
+        return errorCount;
+    }
+
+    // Token indexes count code points, not bytes.
+    size_t codePoints = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if ((text[part.start + i] & 0xC0) != 0x80) codePoints++;
+    }
+
+    // Translate the whole text if the part doesn't end where its text
+    // does, such as after a new routine was added at its end,
+    // or if a routine was renamed.
+    if (   (newCtx->getStop() == nullptr)
+        || (newCtx->getStop()->getStopIndex() + 1 != codePoints)
+        || (   (newDefnCtx != nullptr)
+            && (routineName(newDefnCtx) != routineName(oldDefnCtx))))
+    {
+        return parseAll();
+    }
+
+    // The parts that call a routine whose heading changed
+    // must be checked again.
+    if (   (newDefnCtx != nullptr)
+        && (headingText(newDefnCtx) != headingText(oldDefnCtx)))
+    {
+        PascalParser::RoutineIdentifierContext *idCtx =
+                oldDefnCtx->functionHead() != nullptr
+                    ? oldDefnCtx->functionHead()->routineIdentifier()
+                    : oldDefnCtx->procedureHead()->routineIdentifier();
+
+        for (int i = 0; i < (int) parts.size(); i++)
+        {
+            if ((i != changed) && references(parts[i].ctx, idCtx->entry))
+            {
+                dependents.push_back(i);
+            }
+        }
+    }
+
+    // Replace the part's tree in its parent,
+    // and in any ancestor that it begins or ends.
+    tree::ParseTree *parent = oldCtx->parent;
+    replace(parent->children.begin(), parent->children.end(),
+            (tree::ParseTree *) oldCtx, (tree::ParseTree *) newCtx);
+    newCtx->parent = parent;
+
+    for (tree::ParseTree *node = parent; node != nullptr; node = node->parent)
+    {
+        ParserRuleContext *ancestor = dynamic_cast<ParserRuleContext *>(node);
+        if (ancestor->start == oldCtx->start) ancestor->start = newCtx->start;
+        if (ancestor->stop  == oldCtx->stop)  ancestor->stop  = newCtx->stop;
+    }
+
+    // Move the tokens after the part to their new lines.
+    if (lineDelta != 0)
+    {
+        bool after = false;
+        shiftLines(tree, newCtx, after, lineDelta);
+    }
+
+    // Move the parts after it in the text.
+    part.ctx = newCtx;
+    part.end += byteDelta;
+    for (int i = changed + 1; i < (int) parts.size(); i++)
+    {
+        parts[i].start += byteDelta;
+        parts[i].end   += byteDelta;
+    }
+
+    reparsed = "only " + describe(changed);
+    return 0;
+}
+
+Semantics *ResidentProgram::check()
+{
+    Arena::Scope scope(arena.get());
+    rechecked = "";
+
+    if (whole)
+    {
+        pass2.reset(new Semantics(mode));
+        pass2->visit(tree);
+
+        // Units' routines have no resident parse trees to update.
+        resident =    (pass2->getErrorCount() == 0)
+                   && (tree->program() != nullptr)
+                   && pass2->getUnits().empty();
+        if (resident) findParts();
+
+        return pass2.get();
+    }
+
+    if (changed < 0)
+    {
+        rechecked = "nothing";
+        return pass2.get();
+    }
+
+    // The parts to check again, in source order.
+    vector<int> indexes(dependents);
+    indexes.push_back(changed);
+    sort(indexes.begin(), indexes.end());
+
+    // Remove the cross-reference line numbers of the replaced tree
+    // and of the parts to check again, which they will append anew,
+    // and move the line numbers after the change.
+    int first = oldCtx->getStart()->getLine();
+    int last  = oldCtx->getStop()->getLine();
+    vector<pair<int, int>> lines;
+
+    for (int i : dependents)
+    {
+        lines.push_back(make_pair(parts[i].ctx->getStart()->getLine(),
+                                  parts[i].ctx->getStop()->getLine()));
+    }
+
+    SymtabEntry *programId = pass2->getProgramId();
+    set<Symtab *> visited;
+    forEachEntry(programId->getSymtab(), visited,
+        [&] (SymtabEntry *id)
+        {
+            vector<int> *lineNumbers = id->getLineNumbers();
+            vector<int> kept;
+
+            for (int lineNumber : *lineNumbers)
+            {
+                if ((lineNumber >= first) && (lineNumber <= last)) continue;
+                if (lineNumber > last) lineNumber += lineDelta;
+
+                bool dropped = false;
+                for (pair<int, int>& range : lines)
+                {
+                    if (   (lineNumber >= range.first)
+                        && (lineNumber <= range.second))
+                    {
+                        dropped = true;
+                    }
+                }
+
+                if (!dropped) kept.push_back(lineNumber);
+            }
+
+            lineNumbers->swap(kept);
+        });
+
+    vector<PascalParser::RoutineDefinitionContext *> definitions;
+    PascalParser::CompoundStatementContext *bodyCtx = nullptr;
+
+    for (int i : indexes)
+    {
+        PascalParser::RoutineDefinitionContext *defnCtx =
+            dynamic_cast<PascalParser::RoutineDefinitionContext *>(
+                                                                parts[i].ctx);
+        if (defnCtx != nullptr) definitions.push_back(defnCtx);
+        else bodyCtx =
+            dynamic_cast<PascalParser::CompoundStatementContext *>(
+                                                                parts[i].ctx);
+
+        rechecked += (rechecked.empty() ? "only " : ", ") + describe(i);
+    }
+
+    pass2->recheck(definitions, bodyCtx);
+
+    // Declarations append their line numbers without sorting them,
+    // which puts those of a routine entered again out of order.
+    visited.clear();
+    forEachEntry(programId->getSymtab(), visited,
+        [] (SymtabEntry *id)
+        {
+            vector<int> *lineNumbers = id->getLineNumbers();
+            if (!is_sorted(lineNumbers->begin(), lineNumbers->end()))
+            {
+                sort(lineNumbers->begin(), lineNumbers->end());
+            }
+        });
+
+    updates++;
+    resident = pass2->getErrorCount() == 0;
+
+    return pass2.get();
+}
+
+void ResidentProgram::findParts()
+{
+    // Token indexes count code points, so map them to byte offsets.
+    vector<size_t> offsets;
+    for (size_t i = 0; i < text.length(); i++)
+    {
+        if ((text[i] & 0xC0) != 0x80) offsets.push_back(i);
+    }
+    offsets.push_back(text.length());
+
+    PascalParser::BlockContext *blockCtx = tree->program()->block();
+    PascalParser::RoutinesPartContext *routinesCtx =
+                                        blockCtx->declarations()->routinesPart();
+    vector<ParserRuleContext *> contexts;
+
+    if (routinesCtx != nullptr)
+    {
+        for (PascalParser::RoutineDefinitionContext *defnCtx :
+                                                routinesCtx->routineDefinition())
+        {
+            contexts.push_back(defnCtx);
+        }
+    }
+
+    contexts.push_back(blockCtx->compoundStatement());
+
+    parts.clear();
+    for (ParserRuleContext *ctx : contexts)
+    {
+        parts.push_back({ ctx, offsets[ctx->getStart()->getStartIndex()],
+                               offsets[ctx->getStop()->getStopIndex() + 1] });
+    }
+}
+
+bool ResidentProgram::partsHaveOwnLines() const
+{
+    for (int i = 0; i < (int) parts.size(); i++)
+    {
+        size_t startLine = parts[i].ctx->getStart()->getLine();
+        size_t stopLine  = parts[i].ctx->getStop()->getLine();
+
+        if (lineBefore(parts[i].ctx) >= startLine) return false;
+        if (   (i + 1 < (int) parts.size())
+            && (parts[i + 1].ctx->getStart()->getLine() <= stopLine))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+string ResidentProgram::describe(int index) const
+{
+    PascalParser::RoutineDefinitionContext *defnCtx =
+        dynamic_cast<PascalParser::RoutineDefinitionContext *>(
+                                                            parts[index].ctx);
+    if (defnCtx == nullptr) return "the main program";
+
+    return string(defnCtx->functionHead() != nullptr ? "function \""
+                                                     : "procedure \"")
+           + routineName(defnCtx) + "\"";
+}
+
+void ResidentProgram::forEachEntry(Symtab *symtab, set<Symtab *>& visited,
+                                const function<void(SymtabEntry *)>& action)
+{
+    if ((symtab == nullptr) || !visited.insert(symtab).second) return;
+
+    for (SymtabEntry *id : symtab->entries())
+    {
+        action(id);
+
+        Kind kind = id->getKind();
+        if ((kind == PROGRAM) || (kind == PROCEDURE) || (kind == FUNCTION))
+        {
+            forEachEntry(id->getRoutineSymtab(), visited, action);
+        }
+
+        // The fields of a record type, or of the elements of an array.
+        Typespec *type = id->getType();
+        while ((type != nullptr) && (type->getForm() == ARRAY))
+        {
+            type = type->getArrayElementType();
+        }
+        if ((type != nullptr) && (type->getForm() == RECORD))
+        {
+            forEachEntry(type->getRecordSymtab(), visited, action);
+        }
+    }
+}
+
+bool ResidentProgram::references(tree::ParseTree *node,
+                                 SymtabEntry *routineId)
+{
+    PascalParser::ProcedureNameContext *procCtx =
+                    dynamic_cast<PascalParser::ProcedureNameContext *>(node);
+    PascalParser::FunctionNameContext *funcCtx =
+                    dynamic_cast<PascalParser::FunctionNameContext *>(node);
+    PascalParser::VariableIdentifierContext *varCtx =
+                    dynamic_cast<PascalParser::VariableIdentifierContext *>(node);
+
+    if (procCtx != nullptr) return procCtx->entry == routineId;
+    if (funcCtx != nullptr) return funcCtx->entry == routineId;
+    if (varCtx  != nullptr) return varCtx->entry  == routineId;
+
+    for (tree::ParseTree *child : node->children)
+    {
+        if (references(child, routineId)) return true;
+    }
+
+    return false;
+}
+
+void ResidentProgram::shiftLines(tree::ParseTree *node,
+                                 tree::ParseTree *changed,
+                                 bool& after, int delta)
+{
+    if (node == changed)
+    {
+        after = true;
+        return;
+    }
+
+    tree::TerminalNode *terminal = dynamic_cast<tree::TerminalNode *>(node);
+    if (terminal != nullptr)
+    {
+        WritableToken *token =
+                            dynamic_cast<WritableToken *>(terminal->getSymbol());
+        if (after && (token != nullptr))
+        {
+            token->setLine(token->getLine() + delta);
+        }
+
+        return;
+    }
+
+    for (tree::ParseTree *child : node->children)
+    {
+        shiftLines(child, changed, after, delta);
+    }
+}
+
+size_t ResidentProgram::lineBefore(ParserRuleContext *ctx)
+{
+    for (tree::ParseTree *node = ctx; node->parent != nullptr;
+         node = node->parent)
+    {
+        vector<tree::ParseTree *>& siblings = node->parent->children;
+        auto it = find(siblings.begin(), siblings.end(), node);
+
+        if (it != siblings.begin())
+        {
+            tree::ParseTree *previous = *(it - 1);
+            tree::TerminalNode *terminal =
+                                dynamic_cast<tree::TerminalNode *>(previous);
+
+            return terminal != nullptr
+                ? terminal->getSymbol()->getLine()
+                : dynamic_cast<ParserRuleContext *>(previous)->getStop()
+                                                             ->getLine();
+        }
+    }
+
+    return 0;
+}
+
+string ResidentProgram::routineName(
+                                PascalParser::RoutineDefinitionContext *ctx)
+{
+    PascalParser::RoutineIdentifierContext *idCtx =
+                ctx->functionHead() != nullptr
+                    ? ctx->functionHead()->routineIdentifier()
+                    : ctx->procedureHead()->routineIdentifier();
+
+    return toLowerCase(idCtx->IDENTIFIER()->getText());
+}
+
+string ResidentProgram::headingText(
+                                PascalParser::RoutineDefinitionContext *ctx)
+{
+    return ctx->functionHead() != nullptr ? ctx->functionHead()->getText()
+                                          : ctx->procedureHead()->getText();
+}
+
+} // namespace frontend
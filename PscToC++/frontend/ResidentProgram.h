@@ -0,0 +1,264 @@
+#ifndef RESIDENTPROGRAM_H_
+#define RESIDENTPROGRAM_H_
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <functional>
+
+#include "antlr4-runtime.h"
+#include "PascalLexer.h"
+#include "PascalParser.h"
+
+#include "intermediate/symtab/Symtab.h"
+#include "intermediate/symtab/SymtabEntry.h"
+#include "intermediate/util/Arena.h"
+#include "backend/BackendMode.h"
+#include "SourceBuffer.h"
+#include "Semantics.h"
+
+namespace frontend {
+
+using namespace std;
+using namespace antlr4;
+using namespace intermediate::symtab;
+using namespace intermediate::util;
+
+/**
+ * A program whose parse tree and symbol tables stay resident between
+ * changes to its source file, for the watch mode.
+ *
+ * The program's parts are the routines of its outermost level and its
+ * main compound statement. When an edit is confined to one part, only
+ * that part is lexed, parsed, and checked again, and so are the parts
+ * that call a routine whose heading changed. The line numbers of the
+ * tokens and of the cross-reference after the change are shifted.
+ * Any other edit, or a program that had errors or uses units,
+ * is translated from the start again.
+ */
+class ResidentProgram
+{
+private:
+    /**
+     * The lexer and parser of the whole source text, or of one changed
+     * part of it. They own the tokens and the parse tree nodes,
+     * so they live as long as the parse tree uses any of them.
+     */
+    struct Parse
+    {
+        ANTLRInputStream input;
+        PascalLexer lexer;
+        CommonTokenStream tokens;
+        PascalParser parser;
+
+        Parse(const char *text, size_t length)
+            : input(text, length), lexer(&input), tokens(&lexer),
+              parser(&tokens) {}
+    };
+
+    /**
+     * A part of the program that can be parsed and checked by itself.
+     */
+    struct Part
+    {
+        ParserRuleContext *ctx;  // RoutineDefinitionContext or the main
+                                 // CompoundStatementContext
+        size_t start;            // offset of its first byte in the text
+        size_t end;              // offset just past its last byte
+    };
+
+    // Partial updates before translating from the start again,
+    // which frees the replaced parse trees and symbol tables.
+    static const int MAX_UPDATES = 50;
+
+    BackendMode mode;
+    string sourceFileName;
+    string text;                        // the text that the tree is of
+
+    unique_ptr<Arena> arena;            // the symbol tables and types
+    unique_ptr<SourceBuffer> source;
+    vector<unique_ptr<Parse>> parses;   // the whole text's, then the parts'
+    unique_ptr<Semantics> pass2;
+    PascalParser::CompilationUnitContext *tree;
+
+    vector<Part> parts;     // in source order, the main statement last
+    bool resident;          // true if the tree and tables can be updated
+    int updates;            // partial updates since the whole translation
+
+    bool whole;             // true to translate the whole text
+    int changed;            // index of the changed part, or -1 if none
+    long byteDelta;         // change in the length of the text
+    int lineDelta;          // change in the number of lines
+    ParserRuleContext *oldCtx;   // the changed part's replaced tree
+    vector<int> dependents;      // indexes of the parts to check again
+    string reparsed;        // what pass 1 parsed
+    string rechecked;       // what pass 2 checked
+
+public:
+    /**
+     * Constructor.
+     * @param mode the backend mode.
+     * @param sourceFileName the name of the source file.
+     */
+    ResidentProgram(BackendMode mode, string sourceFileName);
+
+    /**
+     * Destructor.
+     */
+    virtual ~ResidentProgram() {}
+
+    /**
+     * Read the source file and find what changed since the last time.
+     * @return the source buffer.
+     */
+    const SourceBuffer& read();
+
+    /**
+     * Pass 1: Parse the whole source text, or only the part that changed
+     * and replace the part's parse tree.
+     * @return the number of syntax errors.
+     */
+    int parse();
+
+    /**
+     * Pass 2: Create the symbol tables and set the parse tree node
+     * datatypes, or only those of the parts that must be checked again.
+     * @return the semantics, with the count of semantic errors.
+     */
+    Semantics *check();
+
+    /**
+     * Get the parse tree.
+     * @return the CompilationUnitContext.
+     */
+    PascalParser::CompilationUnitContext *getTree() const { return tree; }
+
+    /**
+     * Get the semantics of pass 2.
+     * @return the semantics.
+     */
+    Semantics *getSemantics() const { return pass2.get(); }
+
+    /**
+     * Get the source buffer last read.
+     * @return the source buffer.
+     */
+    const SourceBuffer& getSource() const { return *source; }
+
+    /**
+     * Get the arena of the symbol tables and types.
+     * @return the arena.
+     */
+    Arena& getArena() const { return *arena; }
+
+    /**
+     * Describe what the last pass 1 parsed, if not the whole text.
+     * @return the description, or empty.
+     */
+    string getReparsed() const { return reparsed; }
+
+    /**
+     * Describe what the last pass 2 checked, if not the whole program.
+     * @return the description, or empty.
+     */
+    string getRechecked() const { return rechecked; }
+
+private:
+    /**
+     * Parse the whole source text, discarding the old parse tree,
+     * symbol tables, and types.
+     * @return the number of syntax errors.
+     */
+    int parseAll();
+
+    /**
+     * Parse the changed part and replace its parse tree.
+     * @return the number of syntax errors.
+     */
+    int parseChange();
+
+    /**
+     * Find the one part that contains all the differences between
+     * the old and new source texts, and how much the text moved.
+     * @param newText the new source text.
+     * @return true if found, false if the whole text must be translated.
+     */
+    bool findChange(const string& newText);
+
+    /**
+     * Find the parts of the program and their byte offsets in the text.
+     */
+    void findParts();
+
+    /**
+     * Determine whether every part has source lines of its own,
+     * so that the line numbers in the cross-reference can be
+     * attributed to parts.
+     * @return true if so.
+     */
+    bool partsHaveOwnLines() const;
+
+    /**
+     * Describe a part for the messages.
+     * @param index the part's index.
+     * @return the description.
+     */
+    string describe(int index) const;
+
+    /**
+     * Apply an action to each entry of a symbol table, of the symbol
+     * tables of its routines, and of the record types of its entries.
+     * @param symtab the symbol table.
+     * @param visited the symbol tables already visited.
+     * @param action the action.
+     */
+    static void forEachEntry(Symtab *symtab, set<Symtab *>& visited,
+                             const function<void(SymtabEntry *)>& action);
+
+    /**
+     * Determine whether a parse tree calls or references a routine.
+     * @param node the root of the parse tree.
+     * @param routineId the routine's symbol table entry.
+     * @return true if so.
+     */
+    static bool references(tree::ParseTree *node, SymtabEntry *routineId);
+
+    /**
+     * Add to the line numbers of the tokens after a node of a parse tree.
+     * @param node the root of the parse tree.
+     * @param changed the node.
+     * @param after set true once past the node.
+     * @param delta the amount to add.
+     */
+    static void shiftLines(tree::ParseTree *node, tree::ParseTree *changed,
+                           bool& after, int delta);
+
+    /**
+     * Get the line of the token just before a node of a parse tree.
+     * @param ctx the node.
+     * @return the line number, or 0 if it's the first token.
+     */
+    static size_t lineBefore(ParserRuleContext *ctx);
+
+    /**
+     * Get the lower-case name of a routine definition.
+     * @param ctx the RoutineDefinitionContext.
+     * @return the name.
+     */
+    static string routineName(PascalParser::RoutineDefinitionContext *ctx);
+
+    /**
+     * Get the text of a routine definition's heading without blanks.
+     * @param ctx the RoutineDefinitionContext.
+     * @return the text.
+     */
+    static string headingText(PascalParser::RoutineDefinitionContext *ctx);
+
+    ResidentProgram(const ResidentProgram&) = delete;
+    ResidentProgram& operator =(const ResidentProgram&) = delete;
+};
+
+} // namespace frontend
+
+#endif /* RESIDENTPROGRAM_H_ */
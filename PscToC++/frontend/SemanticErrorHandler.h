@@ -2,7 +2,9 @@
 #define SEMANTICERRORHANDLER_H_
 
 #include <string>
+#include <vector>
 #include <map>
+#include <algorithm>
 
 #include "antlr4-runtime.h"
 
@@ -36,7 +38,10 @@ enum class Error
     INVALID_REFERENCE_PARAMETER,
     INVALID_RETURN_TYPE,
     TOO_MANY_SUBSCRIPTS,
-    INVALID_FIELD
+    INVALID_FIELD,
+    UNIT_NOT_FOUND,
+    INVALID_HEADING,
+    MISSING_ROUTINE
 };
 
 constexpr Error UNDECLARED_IDENTIFIER       = Error::UNDECLARED_IDENTIFIER;
@@ -61,16 +66,48 @@ constexpr Error INVALID_REFERENCE_PARAMETER = Error::INVALID_REFERENCE_PARAMETER
 constexpr Error INVALID_RETURN_TYPE         = Error::INVALID_RETURN_TYPE;
 constexpr Error TOO_MANY_SUBSCRIPTS         = Error::TOO_MANY_SUBSCRIPTS;
 constexpr Error INVALID_FIELD               = Error::INVALID_FIELD;
+constexpr Error UNIT_NOT_FOUND              = Error::UNIT_NOT_FOUND;
+constexpr Error INVALID_HEADING             = Error::INVALID_HEADING;
+constexpr Error MISSING_ROUTINE             = Error::MISSING_ROUTINE;
 
 class SemanticErrorHandler
 {
 private:
+    /**
+     * A flagged error that is held to be printed later.
+     */
+    struct Message
+    {
+        int lineNumber;
+        Error error;
+        string text;
+    };
+
     int  count;
     bool first;
+    bool holding;            // true to hold messages instead of printing
+    vector<Message> held;    // held messages in the order flagged
     map<Error, string> SEMANTIC_ERROR_MESSAGES;
 
+    void print(const Message& message)
+    {
+        if (first)
+        {
+            cout << endl;
+            cout << "===== SEMANTIC ERRORS =====" << endl << endl;
+            printf("%-4s %-40s %s\n", "Line", "Message", "Found near");
+            printf("%-4s %-40s %s\n", "----", "-------", "----------");
+
+            first = false;
+        }
+
+        printf("%03d  %-40s \"%s\"\n", message.lineNumber,
+                            SEMANTIC_ERROR_MESSAGES[message.error].c_str(),
+                            message.text.c_str());
+    }
+
 public:
-    SemanticErrorHandler() : count(0), first(true)
+    SemanticErrorHandler() : count(0), first(true), holding(false)
     {
         SEMANTIC_ERROR_MESSAGES[UNDECLARED_IDENTIFIER] =
                 "Undeclared identifier";
@@ -116,33 +153,80 @@ public:
                 "Too many subscripts";
         SEMANTIC_ERROR_MESSAGES[INVALID_FIELD] =
                 "Invalid field";
+        SEMANTIC_ERROR_MESSAGES[UNIT_NOT_FOUND] =
+                "Unit interface not found";
+        SEMANTIC_ERROR_MESSAGES[INVALID_HEADING] =
+                "Heading differs from its declaration";
+        SEMANTIC_ERROR_MESSAGES[MISSING_ROUTINE] =
+                "Routine declared without a body";
     }
 
     int getCount() const { return count; }
 
     void flag(Error error, int lineNumber, string text)
     {
-        if (first)
-        {
-            cout << endl;
-            cout << "===== SEMANTIC ERRORS =====" << endl << endl;
-            printf("%-4s %-40s %s\n", "Line", "Message", "Found near");
-            printf("%-4s %-40s %s\n", "----", "-------", "----------");
-
-            first = false;
-        }
-
         count++;
 
-        printf("%03d  %-40s \"%s\"\n", lineNumber,
-                                       SEMANTIC_ERROR_MESSAGES[error].c_str(),
-                                       text.c_str());
+        Message message = { lineNumber, error, text };
+        if (holding) held.push_back(message);
+        else         print(message);
     }
 
     void flag(Error error, antlr4::ParserRuleContext *ctx)
     {
         flag(error, ctx->getStart()->getLine(), ctx->getText());
     }
+
+    /**
+     * Hold the messages of flagged errors instead of printing them.
+     */
+    void hold() { holding = true; }
+
+    /**
+     * Forget the errors flagged so far, such as before checking
+     * parts of a program again, so that the count starts from zero
+     * and the next message prints the heading again.
+     */
+    void reset()
+    {
+        count = 0;
+        first = true;
+        held.clear();
+    }
+
+    /**
+     * Take over the errors flagged by another handler, such as one
+     * that checked a routine body on another thread.
+     * @param other the other handler.
+     */
+    void merge(const SemanticErrorHandler& other)
+    {
+        count += other.count;
+
+        for (const Message& message : other.held)
+        {
+            if (holding) held.push_back(message);
+            else         print(message);
+        }
+    }
+
+    /**
+     * Print the held messages in source line order and stop holding.
+     * Messages from the same line stay in the order they were flagged.
+     */
+    void release()
+    {
+        stable_sort(held.begin(), held.end(),
+                    [] (const Message& a, const Message& b)
+                    {
+                        return a.lineNumber < b.lineNumber;
+                    });
+
+        for (const Message& message : held) print(message);
+
+        held.clear();
+        holding = false;
+    }
 };
 
 } // namespace frontend
@@ -1,5 +1,7 @@
 #include <vector>
 #include <set>
+#include <memory>
+#include <algorithm>
 
 #include "antlr4-runtime.h"
 
@@ -7,14 +9,15 @@
 #include "intermediate/symtab/Symtab.h"
 #include "intermediate/symtab/SymtabEntry.h"
 #include "intermediate/symtab/Predefined.h"
+#include "intermediate/symtab/UnitInterface.h"
 #include "intermediate/type/Typespec.h"
 #include "intermediate/type/TypeChecker.h"
-#include "intermediate/util/CrossReferencer.h"
 #include "SemanticErrorHandler.h"
 #include "Semantics.h"
 
 namespace intermediate { namespace symtab {
     int Symtab::unnamedIndex = 0;
+    string Symtab::unnamedScope;
 }}
 
 namespace frontend {
@@ -22,18 +25,21 @@ namespace frontend {
 using namespace std;
 using namespace intermediate::symtab;
 using namespace intermediate::type;
-using namespace intermediate::util;
 
 Object Semantics::visitProgram(PascalParser::ProgramContext *ctx)
 {
+    // Routine bodies are checked after the declarations that follow them,
+    // so hold the error messages to print them in source line order.
+    error.hold();
+
+    // Load the units first, into the predefined symbol table.
+    if (ctx->usesPart() != nullptr) visit(ctx->usesPart());
+
     visit(ctx->programHeader());
     visit(ctx->block()->declarations());
     visit(ctx->block()->compoundStatement());
 
-    // Print the cross-reference table.
-    CrossReferencer crossReferencer;
-    crossReferencer.print(symtabStack);
-
+    error.release();
     return nullptr;
 }
 
@@ -52,6 +58,121 @@ Object Semantics::visitProgramHeader(PascalParser::ProgramHeaderContext *ctx)
     return nullptr;
 }
 
+Object Semantics::visitUnit(PascalParser::UnitContext *ctx)
+{
+    error.hold();
+
+    PascalParser::UnitIdentifierContext *idCtx =
+                                        ctx->unitHeader()->unitIdentifier();
+    PascalParser::InterfacePartContext *interfaceCtx = ctx->interfacePart();
+    string unitName = idCtx->IDENTIFIER()->getText();  // don't shift case
+
+    // A unit doesn't load its own interface.
+    unitNames.insert(toLowerCase(unitName));
+
+    PascalParser::UsesPartContext *usesCtx = interfaceCtx->usesPart();
+    if (usesCtx != nullptr)
+    {
+        visit(usesCtx);
+        for (PascalParser::UnitNameContext *nameCtx : usesCtx->unitName())
+        {
+            uses.push_back(nameCtx->IDENTIFIER()->getText());
+        }
+    }
+
+    // The unit's declarations are at level 1, like a program's.
+    programId = symtabStack->enterLocal(unitName, UNIT);
+    programId->setRoutineSymtab(symtabStack->push());
+
+    symtabStack->setProgramId(programId);
+    symtabStack->getLocalSymtab()->setOwner(programId);
+    idCtx->entry = programId;
+
+    // Keep the unit's unnamed types apart from those of the
+    // units and programs that use it.
+    Symtab::resetUnnamedIndex(toLowerCase(unitName));
+
+    if (interfaceCtx->constantsPart() != nullptr)
+    {
+        visit(interfaceCtx->constantsPart());
+    }
+    if (interfaceCtx->typesPart() != nullptr)
+    {
+        visit(interfaceCtx->typesPart());
+    }
+    if (interfaceCtx->variablesPart() != nullptr)
+    {
+        visit(interfaceCtx->variablesPart());
+    }
+    if (interfaceCtx->routineHeadsPart() != nullptr)
+    {
+        visit(interfaceCtx->routineHeadsPart());
+    }
+
+    const vector<SymtabEntry *>& entries =
+                                    symtabStack->getLocalSymtab()->entries();
+    exports.assign(entries.begin(), entries.end());
+
+    visit(ctx->implementationPart()->declarations());
+
+    // Each routine heading in the interface needs a definition.
+    if (interfaceCtx->routineHeadsPart() != nullptr)
+    {
+        for (PascalParser::RoutineHeadContext *headCtx :
+                                interfaceCtx->routineHeadsPart()->routineHead())
+        {
+            PascalParser::RoutineIdentifierContext *routineIdCtx =
+                    headCtx->functionHead() != nullptr
+                            ? headCtx->functionHead()->routineIdentifier()
+                            : headCtx->procedureHead()->routineIdentifier();
+            SymtabEntry *routineId = routineIdCtx->entry;
+
+            if (   (routineId != nullptr)
+                && (routineId->getRoutineCode() == FORWARD))
+            {
+                error.flag(MISSING_ROUTINE, routineIdCtx);
+            }
+        }
+    }
+
+    error.release();
+    return nullptr;
+}
+
+Object Semantics::visitUsesPart(PascalParser::UsesPartContext *ctx)
+{
+    for (PascalParser::UnitNameContext *nameCtx : ctx->unitName())
+    {
+        if (!loadUnit(nameCtx->IDENTIFIER()->getText()))
+        {
+            error.flag(UNIT_NOT_FOUND, nameCtx);
+        }
+    }
+
+    return nullptr;
+}
+
+bool Semantics::loadUnit(const string& unitName)
+{
+    // A unit is loaded only once, even if several units use it.
+    if (!unitNames.insert(toLowerCase(unitName)).second) return true;
+
+    UnitInterface unitInterface;
+    if (!unitInterface.read(unitName)) return false;
+
+    for (const string& usedName : unitInterface.getUses())
+    {
+        if (!loadUnit(usedName)) return false;
+    }
+
+    // The uses parts are visited before the program or unit
+    // pushes its own symbol table, so the local one is level 0.
+    if (!unitInterface.enter(symtabStack->getLocalSymtab())) return false;
+
+    units.push_back(unitInterface.getName());
+    return true;
+}
+
 Object Semantics::visitConstantDefinition(
                                 PascalParser::ConstantDefinitionContext *ctx)
 {
@@ -87,8 +208,8 @@ Object Semantics::visitConstant(PascalParser::ConstantContext *ctx)
 {
     if (ctx->IDENTIFIER() != nullptr)
     {
-        string constantName = toLowerCase(ctx->IDENTIFIER()->getText());
-        SymtabEntry *constantId = symtabStack->lookup(constantName);
+        SymtabEntry *constantId =
+                            symtabStack->lookup(ctx->IDENTIFIER()->getText());
 
         if (constantId != nullptr)
         {
@@ -101,7 +222,7 @@ Object Semantics::visitConstant(PascalParser::ConstantContext *ctx)
             ctx->type  = constantId->getType();
             ctx->value = constantId->getValue();
 
-            constantId->appendLineNumber(ctx->getStart()->getLine());
+            appendLineNumber(constantId, ctx->getStart()->getLine());
         }
         else
         {
@@ -133,7 +254,7 @@ Object Semantics::visitConstant(PascalParser::ConstantContext *ctx)
         }
 
         ctx->type = Predefined::stringType;
-        ctx->value = new string(unquoted);
+        ctx->value = Arena::make<string>(unquoted);
     }
     else  // number
     {
@@ -178,6 +299,12 @@ Object Semantics::visitTypeDefinition(PascalParser::TypeDefinitionContext *ctx)
                                                     ctx->typeSpecification();
         visit(typeCtx);
 
+        // Name a copy of an anonymous type that other declarations share.
+        if (types->isShared(typeCtx->type))
+        {
+            typeCtx->type = Arena::make<Typespec>(*typeCtx->type);
+        }
+
         typeId = symtabStack->enterLocal(typeName, TYPE);
         typeId->setType(typeCtx->type);
         typeCtx->type->setIdentifier(typeId);
@@ -209,7 +336,7 @@ SymtabEntry *Semantics::createRecordType(
 {
     PascalParser::RecordTypeContext *recordTypeCtx =
                                             recordTypeSpecCtx->recordType();
-    Typespec *recordType = new Typespec(RECORD);
+    Typespec *recordType = Arena::make<Typespec>(RECORD);
 
     SymtabEntry *recordTypeId = symtabStack->enterLocal(recordTypeName, TYPE);
     recordTypeId->setType(recordType);
@@ -278,8 +405,7 @@ Object Semantics::visitTypeIdentifierTypespec(
 
 Object Semantics::visitTypeIdentifier(PascalParser::TypeIdentifierContext *ctx)
 {
-    string typeName = toLowerCase(ctx->IDENTIFIER()->getText());
-    SymtabEntry *typeId = symtabStack->lookup(typeName);
+    SymtabEntry *typeId = symtabStack->lookup(ctx->IDENTIFIER()->getText());
 
     if (typeId != nullptr)
     {
@@ -308,8 +434,8 @@ Object Semantics::visitTypeIdentifier(PascalParser::TypeIdentifierContext *ctx)
 Object Semantics::visitEnumerationTypespec(
                                 PascalParser::EnumerationTypespecContext *ctx)
 {
-    Typespec *enumType = new Typespec(ENUMERATION);
-    vector<SymtabEntry *> *constants = new vector<SymtabEntry *>();
+    Typespec *enumType = Arena::make<Typespec>(ENUMERATION);
+    vector<SymtabEntry *> *constants = Arena::make<vector<SymtabEntry *>>();
     int value = -1;
 
     // Loop over the enumeration constants.
@@ -350,7 +476,6 @@ Object Semantics::visitEnumerationTypespec(
 Object Semantics::visitSubrangeTypespec(
                                     PascalParser::SubrangeTypespecContext *ctx)
 {
-    Typespec *type = new Typespec(SUBRANGE);
     PascalParser::SubrangeTypeContext *subCtx = ctx->subrangeType();
     PascalParser::ConstantContext *minCtx = subCtx->constant()[0];
     PascalParser::ConstantContext *maxCtx = subCtx->constant()[1];
@@ -397,44 +522,34 @@ Object Semantics::visitSubrangeTypespec(
         maxObj  = minObj;
     }
 
-    type->setSubrangeBaseType(minType);
-    type->setSubrangeMinValue(minValue);
-    type->setSubrangeMaxValue(maxValue);
-
-    ctx->type = type;
+    ctx->type = types->subrange(minType, minValue, maxValue);
     return nullptr;
 }
 
 Object Semantics::visitArrayTypespec(PascalParser::ArrayTypespecContext *ctx)
 {
-    Typespec *arrayType = new Typespec(ARRAY);
     PascalParser::ArrayTypeContext *arrayCtx = ctx->arrayType();
-    PascalParser::ArrayDimensionListContext *listCtx =
-                                                arrayCtx->arrayDimensionList();
+    vector<PascalParser::SimpleTypeContext *> dimensions =
+                                arrayCtx->arrayDimensionList()->simpleType();
 
-    ctx->type = arrayType;
-
-    // Loop over the array dimensions.
-    int count = listCtx->simpleType().size();
-    for (int i = 0; i < count; i++)
+    // Visit the index types and then the element type.
+    for (PascalParser::SimpleTypeContext *simpleCtx : dimensions)
     {
-        PascalParser::SimpleTypeContext *simpleCtx = listCtx->simpleType()[i];
         visit(simpleCtx);
-        arrayType->setArrayIndexType(simpleCtx->type);
-        arrayType->setArrayElementCount(typeCount(simpleCtx->type));
-
-        if (i < count-1)
-        {
-            Typespec *elmtType = new Typespec(ARRAY);
-            arrayType->setArrayElementType(elmtType);
-            arrayType = elmtType;
-        }
     }
 
     visit(arrayCtx->typeSpecification());
-    Typespec *elmtType = arrayCtx->typeSpecification()->type;
-    arrayType->setArrayElementType(elmtType);
+    Typespec *arrayType = arrayCtx->typeSpecification()->type;
+
+    // Build the dimensions from the last one outwards,
+    // so that each is interned after its element type.
+    for (int i = dimensions.size() - 1; i >= 0; i--)
+    {
+        Typespec *indexType = dimensions[i]->type;
+        arrayType = types->array(indexType, arrayType, typeCount(indexType));
+    }
 
+    ctx->type = arrayType;
     return nullptr;
 }
 
@@ -499,6 +614,119 @@ Object Semantics::visitVariableDeclarations(
     return nullptr;
 }
 
+Object Semantics::visitRoutinesPart(PascalParser::RoutinesPartContext *ctx)
+{
+    vector<PascalParser::RoutineDefinitionContext *> definitions =
+                                                    ctx->routineDefinition();
+    Symtab *symtab = symtabStack->getLocalSymtab();
+    vector<SymtabEntry *> routineIds;
+    vector<int> visible;
+
+    // Enter the routines and their declarations in source order.
+    // A routine's body must not see the routines declared after it,
+    // so note how many local entries there are after each routine.
+    for (PascalParser::RoutineDefinitionContext *defnCtx : definitions)
+    {
+        routineIds.push_back(visit(defnCtx).as<SymtabEntry *>());
+        visible.push_back(symtab->size());
+    }
+
+    checkBodies(definitions, routineIds, symtab, visible);
+    return nullptr;
+}
+
+void Semantics::checkBodies(
+            const vector<PascalParser::RoutineDefinitionContext *>& definitions,
+            const vector<SymtabEntry *>& routineIds, Symtab *symtab,
+            const vector<int>& visible)
+{
+    int count = definitions.size();
+
+    // Each body only reads the enclosing scopes and annotates its own
+    // statements, so the bodies can be checked at the same time.
+    // Each allocates into its own arena.
+    vector<unique_ptr<SymtabStack>> scopes(count);
+    vector<unique_ptr<Semantics>> checkers(count);
+    vector<unique_ptr<Arena>> arenas(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (routineIds[i] == nullptr) continue;  // redeclared
+
+        scopes[i].reset(new SymtabStack(routineIds[i]));
+        scopes[i]->setHorizon(symtab, visible[i]);
+        checkers[i].reset(new Semantics(this, scopes[i].get()));
+        arenas[i].reset(new Arena());
+    }
+
+    auto check = [&] (int i)
+    {
+        if (checkers[i] != nullptr)
+        {
+            Arena::Scope scope(arenas[i].get());
+            checkers[i]->visit(definitions[i]->block()->compoundStatement());
+        }
+    };
+
+    if (count > 1)
+    {
+        if (pool == nullptr) pool = new ThreadPool();
+        pool->run(count, check);
+    }
+    else if (count == 1) check(0);
+
+    // Merge the errors, cross-reference line numbers,
+    // and allocations in source order.
+    for (int i = 0; i < count; i++)
+    {
+        if (checkers[i] == nullptr) continue;
+
+        Arena::current()->adopt(*arenas[i]);
+        error.merge(checkers[i]->error);
+        for (pair<SymtabEntry *, int>& reference : checkers[i]->references)
+        {
+            appendLineNumber(reference.first, reference.second);
+        }
+    }
+}
+
+void Semantics::recheck(
+            const vector<PascalParser::RoutineDefinitionContext *>& definitions,
+            PascalParser::CompoundStatementContext *bodyCtx)
+{
+    error.reset();
+    error.hold();
+
+    // The program's symbol table is still on top of the stack.
+    Symtab *symtab = symtabStack->getLocalSymtab();
+    const vector<SymtabEntry *>& entries = symtab->entries();
+    vector<SymtabEntry *> routineIds;
+    vector<int> visible;
+
+    // Each routine keeps its place among the program's entries,
+    // so its body sees the same routines as before.
+    for (PascalParser::RoutineDefinitionContext *defnCtx : definitions)
+    {
+        PascalParser::RoutineIdentifierContext *idCtx =
+                defnCtx->functionHead() != nullptr
+                    ? defnCtx->functionHead()->routineIdentifier()
+                    : defnCtx->procedureHead()->routineIdentifier();
+        string routineName = toLowerCase(idCtx->IDENTIFIER()->getText());
+
+        redefinedId = symtab->lookup(routineName);
+        routineIds.push_back(visit(defnCtx).as<SymtabEntry *>());
+        visible.push_back(find(entries.begin(), entries.end(), redefinedId)
+                              - entries.begin() + 1);
+    }
+
+    redefinedId = nullptr;
+    checkBodies(definitions, routineIds, symtab, visible);
+
+    if (bodyCtx != nullptr) visit(bodyCtx);
+
+    error.release();
+}
+
 Object Semantics::visitRoutineDefinition(
                                     PascalParser::RoutineDefinitionContext *ctx)
 {
@@ -507,7 +735,6 @@ Object Semantics::visitRoutineDefinition(
     PascalParser::RoutineIdentifierContext *idCtx = nullptr;
     PascalParser::ParametersContext *parameters = nullptr;
     bool functionDefinition = funcCtx != nullptr;
-    Typespec *returnType = nullptr;
     string routineName;
 
     if (functionDefinition)
@@ -524,25 +751,107 @@ Object Semantics::visitRoutineDefinition(
     routineName = toLowerCase(idCtx->IDENTIFIER()->getText());
     SymtabEntry *routineId = symtabStack->lookupLocal(routineName);
 
+    // Complete a routine whose heading a unit's interface declared.
+    if (   (routineId != nullptr)
+        && (routineId->getKind() == (functionDefinition ? FUNCTION
+                                                        : PROCEDURE))
+        && (routineId->getRoutineCode() == FORWARD))
+    {
+        routineId->setRoutineCode(DECLARED);
+        symtabStack->push(routineId->getRoutineSymtab());
+
+        idCtx->entry = routineId;
+        idCtx->type  = routineId->getType();
+        checkHeading(routineId, idCtx, parameters, funcCtx);
+    }
+    else
+    {
+        routineId = enterRoutine(idCtx, parameters, funcCtx, DECLARED);
+        if (routineId == nullptr) return (SymtabEntry *) nullptr;
+    }
+
+    Symtab *symtab = symtabStack->getLocalSymtab();
+    visit(ctx->block()->declarations());
+
+    // Enter the function's associated variable into its symbol table.
+    if (functionDefinition)
+    {
+        SymtabEntry *assocVarId =
+                            symtabStack->enterLocal(routineName, VARIABLE);
+        assocVarId->setSlotNumber(symtab->nextSlotNumber());
+        assocVarId->setType(routineId->getType());
+    }
+
+    // visitRoutinesPart() checks the body.
+    routineId->setExecutable(ctx->block()->compoundStatement());
+
+    symtabStack->pop();
+    return routineId;
+}
+
+Object Semantics::visitRoutineHead(PascalParser::RoutineHeadContext *ctx)
+{
+    PascalParser::FunctionHeadContext  *funcCtx = ctx->functionHead();
+    PascalParser::ProcedureHeadContext *procCtx = ctx->procedureHead();
+
+    // The definition in the implementation completes the routine.
+    SymtabEntry *routineId =
+        funcCtx != nullptr
+            ? enterRoutine(funcCtx->routineIdentifier(),
+                           funcCtx->parameters(), funcCtx, FORWARD)
+            : enterRoutine(procCtx->routineIdentifier(),
+                           procCtx->parameters(), nullptr, FORWARD);
+
     if (routineId != nullptr)
+    {
+        routineId->appendLineNumber(ctx->getStart()->getLine());
+        symtabStack->pop();
+    }
+
+    return nullptr;
+}
+
+SymtabEntry *Semantics::enterRoutine(
+                            PascalParser::RoutineIdentifierContext *idCtx,
+                            PascalParser::ParametersContext *parameters,
+                            PascalParser::FunctionHeadContext *funcCtx,
+                            Routine code)
+{
+    bool functionDefinition = funcCtx != nullptr;
+    string routineName = toLowerCase(idCtx->IDENTIFIER()->getText());
+    SymtabEntry *routineId = symtabStack->lookupLocal(routineName);
+
+    if ((routineId != nullptr) && (routineId != redefinedId))
     {
         error.flag(REDECLARED_IDENTIFIER,
-                   ctx->getStart()->getLine(), routineName);
+                   idCtx->getStart()->getLine(), routineName);
         return nullptr;
     }
 
-    routineId = symtabStack->enterLocal(
+    // A routine entered again keeps its entry, which the rest of the
+    // program references, but starts without parameters or subroutines.
+    if (routineId != nullptr)
+    {
+        routineId->setKind(functionDefinition ? FUNCTION : PROCEDURE);
+        routineId->setType(nullptr);
+        routineId->getRoutineParameters()->clear();
+        routineId->getSubroutines()->clear();
+    }
+    else
+    {
+        routineId = symtabStack->enterLocal(
                     routineName, functionDefinition ? FUNCTION : PROCEDURE);
-    routineId->setRoutineCode(DECLARED);
-    idCtx->entry = routineId;
 
-    // Append to the parent routine's list of subroutines.
-    SymtabEntry *parentId = symtabStack->getLocalSymtab()->getOwner();
-    parentId->appendSubroutine(routineId);
+        // Append to the parent routine's list of subroutines.
+        SymtabEntry *parentId = symtabStack->getLocalSymtab()->getOwner();
+        parentId->appendSubroutine(routineId);
+    }
 
-    routineId->setRoutineSymtab(symtabStack->push());
+    routineId->setRoutineCode(code);
     idCtx->entry = routineId;
 
+    routineId->setRoutineSymtab(symtabStack->push());
+
     Symtab *symtab = symtabStack->getLocalSymtab();
     symtab->setOwner(routineId);
 
@@ -564,7 +873,7 @@ Object Semantics::visitRoutineDefinition(
         PascalParser::TypeIdentifierContext *typeIdCtx =
                                                 funcCtx->typeIdentifier();
         visit(typeIdCtx);
-        returnType = typeIdCtx->type;
+        Typespec *returnType = typeIdCtx->type;
 
         if (returnType->getForm() != SCALAR)
         {
@@ -580,28 +889,70 @@ Object Semantics::visitRoutineDefinition(
         idCtx->type = nullptr;
     }
 
-    visit(ctx->block()->declarations());
+    return routineId;
+}
 
-    // Enter the function's associated variable into its symbol table.
-    if (functionDefinition)
+void Semantics::checkHeading(SymtabEntry *routineId,
+                             PascalParser::RoutineIdentifierContext *idCtx,
+                             PascalParser::ParametersContext *parameters,
+                             PascalParser::FunctionHeadContext *funcCtx)
+{
+    vector<SymtabEntry *> *parmIds = routineId->getRoutineParameters();
+    size_t index = 0;
+    bool same = true;
+
+    if (parameters != nullptr)
     {
-        SymtabEntry *assocVarId =
-                            symtabStack->enterLocal(routineName, VARIABLE);
-        assocVarId->setSlotNumber(symtab->nextSlotNumber());
-        assocVarId->setType(returnType);
+        for (PascalParser::ParameterDeclarationsContext *dclCtx :
+                parameters->parameterDeclarationsList()->parameterDeclarations())
+        {
+            Kind kind = dclCtx->VAR() != nullptr ? REFERENCE_PARAMETER
+                                                 : VALUE_PARAMETER;
+            visit(dclCtx->typeIdentifier());
+            Typespec *parmType = dclCtx->typeIdentifier()->type;
+
+            for (PascalParser::ParameterIdentifierContext *parmCtx :
+                            dclCtx->parameterIdentifierList()->parameterIdentifier())
+            {
+                string parmName = toLowerCase(parmCtx->IDENTIFIER()->getText());
+                SymtabEntry *parmId = index < parmIds->size()
+                                                ? (*parmIds)[index] : nullptr;
+                index++;
+
+                if (   (parmId == nullptr) || (parmId->getName() != parmName)
+                    || (parmId->getKind() != kind)
+                    || (parmId->getType() != parmType))
+                {
+                    same = false;
+                    continue;
+                }
+
+                parmCtx->entry = parmId;
+                parmCtx->type  = parmType;
+                parmId->appendLineNumber(parmCtx->getStart()->getLine());
+            }
+        }
     }
 
-    visit(ctx->block()->compoundStatement());
-    routineId->setExecutable(ctx->block()->compoundStatement());
+    if (index != parmIds->size()) same = false;
 
-    symtabStack->pop();
-    return nullptr;
+    if (funcCtx != nullptr)
+    {
+        visit(funcCtx->typeIdentifier());
+        if (funcCtx->typeIdentifier()->type != routineId->getType())
+        {
+            same = false;
+        }
+    }
+
+    if (!same) error.flag(INVALID_HEADING, idCtx);
 }
 
 Object Semantics::visitParameterDeclarationsList(
                             PascalParser::ParameterDeclarationsListContext *ctx)
 {
-    vector<SymtabEntry *> *parameterList = new vector<SymtabEntry *>();
+    vector<SymtabEntry *> *parameterList =
+                                    Arena::make<vector<SymtabEntry *>>();
 
     // Loop over the parameter declarations.
     for (PascalParser::ParameterDeclarationsContext *dclCtx :
@@ -849,8 +1200,7 @@ Object Semantics::visitProcedureCallStatement(
 {
     PascalParser::ProcedureNameContext *nameCtx = ctx->procedureName();
     PascalParser::ArgumentListContext *listCtx = ctx->argumentList();
-    string name = toLowerCase(ctx->procedureName()->getText());
-    SymtabEntry *procedureId = symtabStack->lookup(name);
+    SymtabEntry *procedureId = symtabStack->lookup(nameCtx->getText());
     bool badName = false;
 
     if (procedureId == nullptr)
@@ -890,8 +1240,7 @@ Object Semantics::visitFunctionCallFactor(
     PascalParser::FunctionCallContext *callCtx = ctx->functionCall();
     PascalParser::FunctionNameContext *nameCtx = callCtx->functionName();
     PascalParser::ArgumentListContext *listCtx = callCtx->argumentList();
-    string name = toLowerCase(callCtx->functionName()->getText());
-    SymtabEntry *functionId = symtabStack->lookup(name);
+    SymtabEntry *functionId = symtabStack->lookup(nameCtx->getText());
     bool badName = false;
 
     ctx->type = Predefined::integerType;
@@ -1290,15 +1639,14 @@ Object Semantics::visitVariableIdentifier(
                                 PascalParser::VariableIdentifierContext *ctx)
 {
 
-    string variableName = toLowerCase(ctx->IDENTIFIER()->getText());
-    SymtabEntry *variableId = symtabStack->lookup(variableName);
+    SymtabEntry *variableId = symtabStack->lookup(ctx->IDENTIFIER()->getText());
 
     if (variableId != nullptr)
     {
         int lineNumber = ctx->getStart()->getLine();
         ctx->type = variableId->getType();
         ctx->entry = variableId;
-        variableId->appendLineNumber(lineNumber);
+        appendLineNumber(variableId, lineNumber);
 
         Kind kind = variableId->getKind();
         switch (kind)
@@ -1323,6 +1671,22 @@ Object Semantics::visitVariableIdentifier(
     return nullptr;
 }
 
+void Semantics::appendLineNumber(SymtabEntry *id, int lineNumber)
+{
+    if (deferring)
+    {
+        references.push_back(make_pair(id, lineNumber));
+        return;
+    }
+
+    // A routine body's line numbers are merged after the declarations
+    // that follow it, so they can belong before ones already appended.
+    vector<int> *lineNumbers = id->getLineNumbers();
+    lineNumbers->insert(upper_bound(lineNumbers->begin(), lineNumbers->end(),
+                                    lineNumber),
+                        lineNumber);
+}
+
 Typespec *Semantics::variableDatatype(PascalParser::VariableContext *varCtx,
                                       Typespec *varType)
 {
@@ -1365,16 +1729,15 @@ Typespec *Semantics::variableDatatype(PascalParser::VariableContext *varCtx,
             {
                 Symtab *symtab = type->getRecordSymtab();
                 PascalParser::FieldContext *fieldCtx = modCtx->field();
-                string fieldName =
-                                toLowerCase(fieldCtx->IDENTIFIER()->getText());
-                SymtabEntry *fieldId = symtab->lookup(fieldName);
+                SymtabEntry *fieldId =
+                                symtab->lookup(fieldCtx->IDENTIFIER()->getText());
 
                 if (fieldId != nullptr)
                 {
                     type = fieldId->getType();
                     fieldCtx->entry = fieldId;
                     fieldCtx->type = type;
-                    fieldId->appendLineNumber(modCtx->getStart()->getLine());
+                    appendLineNumber(fieldId, modCtx->getStart()->getLine());
                 }
                 else
                 {
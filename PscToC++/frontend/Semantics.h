@@ -2,6 +2,9 @@
 #define SEMANTICS_H_
 
 #include <map>
+#include <set>
+#include <vector>
+#include <utility>
 
 #include "PascalBaseVisitor.h"
 #include "antlr4-runtime.h"
@@ -10,6 +13,9 @@
 #include "intermediate/symtab/SymtabEntry.h"
 #include "intermediate/symtab/Predefined.h"
 #include "intermediate/type/Typespec.h"
+#include "intermediate/type/TypeInterner.h"
+#include "intermediate/util/ThreadPool.h"
+#include "intermediate/util/Arena.h"
 #include "backend/BackendMode.h"
 #include "SemanticErrorHandler.h"
 
@@ -18,6 +24,7 @@ namespace frontend {
 using namespace std;
 using namespace intermediate::symtab;
 using namespace intermediate::type;
+using namespace intermediate::util;
 
 class Semantics : public PascalBaseVisitor
 {
@@ -28,6 +35,96 @@ private:
     SemanticErrorHandler error;
 
     map<string, Typespec *> *typeTable;
+    TypeInterner *types;  // the anonymous subrange and array types
+
+    ThreadPool *pool;    // checks routine bodies, created when first needed
+    bool deferring;      // true to defer appending cross-reference lines
+    vector<pair<SymtabEntry *, int>> references;  // deferred line numbers
+    SymtabEntry *redefinedId;  // routine being entered again, or null
+
+    vector<string> units;        // loaded units, each after those it uses
+    set<string> unitNames;       // lower-case names of units seen
+    vector<string> uses;         // units that a unit's interface uses
+    vector<SymtabEntry *> exports;  // entries that a unit's interface declares
+
+    /**
+     * Constructor to check the body of a routine on another thread.
+     * It shares the type tables of the semantics that entered the
+     * routine's declarations and holds its errors and line numbers
+     * for that semantics to merge.
+     * @param parent the semantics that entered the declarations.
+     * @param scope the symbol table stack of the routine's scope.
+     */
+    Semantics(Semantics *parent, SymtabStack *scope)
+        : mode(parent->mode), symtabStack(scope),
+          programId(parent->programId), typeTable(parent->typeTable),
+          types(parent->types), pool(nullptr), deferring(true),
+          redefinedId(nullptr)
+    {
+        error.hold();
+    }
+
+    /**
+     * Load the interface file of a unit into the predefined symbol table,
+     * after first loading those of the units that its interface uses.
+     * @param unitName the name of the unit.
+     * @return true if loaded or already loaded.
+     */
+    bool loadUnit(const string& unitName);
+
+    /**
+     * Enter a routine and its parameters into the local symbol table,
+     * and set a function's return type.
+     * @param idCtx the RoutineIdentifierContext.
+     * @param parameters the ParametersContext, or null if none.
+     * @param funcCtx the FunctionHeadContext, or null if a procedure.
+     * @param code the routine code, FORWARD if only the heading is declared.
+     * @return the routine's symbol table entry, or null if redeclared.
+     * The routine's symbol table is left pushed onto the stack.
+     */
+    SymtabEntry *enterRoutine(PascalParser::RoutineIdentifierContext *idCtx,
+                              PascalParser::ParametersContext *parameters,
+                              PascalParser::FunctionHeadContext *funcCtx,
+                              Routine code);
+
+    /**
+     * Check the bodies of routines whose declarations have been entered,
+     * at the same time, and merge their errors, cross-reference line
+     * numbers, and allocations in source order.
+     * @param definitions the routines' RoutineDefinitionContexts.
+     * @param routineIds the routines' symbol table entries, null if
+     *                   redeclared.
+     * @param symtab the symbol table that the routines are entered in.
+     * @param visible for each routine, how many entries of that symbol
+     *                table its body can see.
+     */
+    void checkBodies(
+            const vector<PascalParser::RoutineDefinitionContext *>& definitions,
+            const vector<SymtabEntry *>& routineIds, Symtab *symtab,
+            const vector<int>& visible);
+
+    /**
+     * Check that a routine definition repeats the heading that a unit's
+     * interface declared, and set the parse tree nodes of the repeated
+     * parameters to the declared ones.
+     * @param routineId the routine's symbol table entry.
+     * @param idCtx the RoutineIdentifierContext of the definition.
+     * @param parameters the ParametersContext, or null if none.
+     * @param funcCtx the FunctionHeadContext, or null if a procedure.
+     */
+    void checkHeading(SymtabEntry *routineId,
+                      PascalParser::RoutineIdentifierContext *idCtx,
+                      PascalParser::ParametersContext *parameters,
+                      PascalParser::FunctionHeadContext *funcCtx);
+
+    /**
+     * Append a line number where an identifier is referenced
+     * to the identifier's symbol table entry, keeping the numbers
+     * in order, or hold it if checking a routine body.
+     * @param id the identifier's symbol table entry.
+     * @param lineNumber the line number.
+     */
+    void appendLineNumber(SymtabEntry *id, int lineNumber);
 
     /**
      * Return the number of values in a datatype.
@@ -86,14 +183,15 @@ private:
     Symtab *createRecordSymtab(
                 PascalParser::RecordFieldsContext *ctx, SymtabEntry *ownerId);
 
-public:
-    Semantics(BackendMode mode) : mode(mode), programId(nullptr)
+    /**
+     * Create the table of the predefined datatypes
+     * and the table of anonymous types.
+     */
+    void createTypeTable()
     {
-        // Create and initialize the symbol table stack.
-        symtabStack = new SymtabStack();
-        Predefined::initialize(symtabStack);
+        types = Arena::make<TypeInterner>();
 
-        typeTable = new map<string, Typespec *>();
+        typeTable = Arena::make<map<string, Typespec *>>();
         (*typeTable)["integer"] = Predefined::integerType;
         (*typeTable)["real"]    = Predefined::realType;
         (*typeTable)["boolean"] = Predefined::booleanType;
@@ -101,18 +199,83 @@ public:
         (*typeTable)["string"]  = Predefined::stringType;
     }
 
+public:
+    Semantics(BackendMode mode)
+        : mode(mode), programId(nullptr), pool(nullptr), deferring(false),
+          redefinedId(nullptr)
+    {
+        // Create and initialize the symbol table stack.
+        symtabStack = Arena::make<SymtabStack>();
+        Predefined::initialize(symtabStack);
+
+        createTypeTable();
+    }
+
+    /**
+     * Constructor to check expressions in the scope of a routine
+     * that has already been declared, such as for the debugger.
+     * @param symtabStack the symbol table stack of the routine's scope.
+     */
+    Semantics(SymtabStack *symtabStack)
+        : mode(DEBUGGER), symtabStack(symtabStack),
+          programId(symtabStack->getProgramId()),
+          pool(nullptr), deferring(false), redefinedId(nullptr)
+    {
+        createTypeTable();
+    }
+
+    /**
+     * Destructor.
+     */
+    virtual ~Semantics() { delete pool; }
+
     /**
      * Get the symbol table entry of the program identifier.
      * @return the entry.
      */
     SymtabEntry *getProgramId() { return programId; }
 
+    /**
+     * Get the names of the units that were loaded, each after the units
+     * that its interface uses, which is the order to link them in.
+     * @return the names.
+     */
+    const vector<string>& getUnits() const { return units; }
+
+    /**
+     * Get the names of the units that a unit's interface uses.
+     * @return the names.
+     */
+    const vector<string>& getUses() const { return uses; }
+
+    /**
+     * Get the entries that a unit's interface declares.
+     * @return the entries, in the order declared.
+     */
+    const vector<SymtabEntry *>& getExports() const { return exports; }
+
     /**
      * Get the count of semantic errors.
      * @return the count.
      */
     int getErrorCount() const { return error.getCount(); }
 
+    /**
+     * Check parts of a program again after their source text changed,
+     * keeping the symbol tables of the rest of the program. Each routine
+     * keeps its symbol table entry, which references to it from the
+     * rest of the program share, but its declarations are entered into
+     * new symbol tables and its body is checked again. The errors count
+     * from zero.
+     * @param definitions the RoutineDefinitionContexts of the program's
+     *                    routines to enter again, in source order.
+     * @param bodyCtx the program's CompoundStatementContext to check
+     *                again, or null.
+     */
+    void recheck(
+            const vector<PascalParser::RoutineDefinitionContext *>& definitions,
+            PascalParser::CompoundStatementContext *bodyCtx);
+
     /**
      * Return the default value for a given datatype.
      * @param type the datatype.
@@ -121,6 +284,9 @@ public:
 
     Object visitProgram(PascalParser::ProgramContext *ctx) override;
     Object visitProgramHeader(PascalParser::ProgramHeaderContext *ctx) override;
+    Object visitUnit(PascalParser::UnitContext *ctx) override;
+    Object visitUsesPart(PascalParser::UsesPartContext *ctx) override;
+    Object visitRoutineHead(PascalParser::RoutineHeadContext *ctx) override;
     Object visitConstantDefinition(PascalParser::ConstantDefinitionContext *ctx) override;
     Object visitConstant(PascalParser::ConstantContext *ctx) override;
     Object visitTypeDefinition(PascalParser::TypeDefinitionContext *ctx) override;
@@ -132,6 +298,7 @@ public:
     Object visitSubrangeTypespec(PascalParser::SubrangeTypespecContext *ctx) override;
     Object visitArrayTypespec(PascalParser::ArrayTypespecContext *ctx) override;
     Object visitVariableDeclarations(PascalParser::VariableDeclarationsContext *ctx) override;
+    Object visitRoutinesPart(PascalParser::RoutinesPartContext *ctx) override;
     Object visitRoutineDefinition(PascalParser::RoutineDefinitionContext *ctx) override;
     Object visitParameterDeclarationsList(PascalParser::ParameterDeclarationsListContext *ctx) override;
     Object visitParameterDeclarations(PascalParser::ParameterDeclarationsContext *ctx) override;
@@ -0,0 +1,165 @@
+#ifndef SOURCEBUFFER_H_
+#define SOURCEBUFFER_H_
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace frontend {
+
+using namespace std;
+
+/**
+ * The source file, mapped into memory once and shared by the listing,
+ * the lexer's input stream, and the syntax error handler.
+ */
+class SourceBuffer
+{
+private:
+    string fileName;
+    const char *text;           // the mapped source text
+    size_t length;              // its length in bytes
+    bool mapped;                // true if text must be unmapped
+    vector<size_t> lineStarts;  // offset of the first character of each line
+
+public:
+    /**
+     * Constructor. Map the source file and index its line offsets.
+     * @param sourceFileName the name of the source file.
+     */
+    SourceBuffer(string sourceFileName);
+
+    /**
+     * Destructor.
+     */
+    virtual ~SourceBuffer()
+    {
+        if (mapped) munmap((void *) text, length);
+    }
+
+    /**
+     * Getter.
+     * @return the name of the source file.
+     */
+    string getFileName() const { return fileName; }
+
+    /**
+     * Getter.
+     * @return the source text. It is not null-terminated.
+     */
+    const char *getText() const { return text; }
+
+    /**
+     * Getter.
+     * @return the length of the source text in bytes.
+     */
+    size_t getLength() const { return length; }
+
+    /**
+     * Getter.
+     * @return the number of source lines.
+     */
+    int getLineCount() const { return lineStarts.size(); }
+
+    /**
+     * Get the start and length of a source line, without its line terminator.
+     * @param lineNumber the line number, starting from 1.
+     * @param lineLength set to the line's length.
+     * @return a pointer to the line's first character, or nullptr if
+     *         there is no such line.
+     */
+    const char *getLine(int lineNumber, size_t& lineLength) const;
+
+    /**
+     * Get the text of a source line.
+     * @param lineNumber the line number, starting from 1.
+     * @return the line, or the empty string if there is no such line.
+     */
+    string getLine(int lineNumber) const
+    {
+        size_t lineLength;
+        const char *line = getLine(lineNumber, lineLength);
+        return line != nullptr ? string(line, lineLength) : "";
+    }
+
+private:
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator =(const SourceBuffer&) = delete;
+};
+
+inline SourceBuffer::SourceBuffer(string sourceFileName)
+    : fileName(sourceFileName), text(""), length(0), mapped(false)
+{
+    int fd = open(sourceFileName.c_str(), O_RDONLY);
+    struct stat status;
+
+    if ((fd < 0) || (fstat(fd, &status) < 0))
+    {
+        cout << "ERROR: Failed to open source file \""
+             << sourceFileName << "\"." << endl;
+        exit(-1);
+    }
+
+    // An empty file cannot be mapped.
+    if (status.st_size > 0)
+    {
+        void *addr = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE,
+                          fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            cout << "ERROR: Failed to read source file \""
+                 << sourceFileName << "\"." << endl;
+            exit(-1);
+        }
+
+        // The lexer and the listing each make one sequential pass.
+        madvise(addr, status.st_size, MADV_SEQUENTIAL);
+
+        text = (const char *) addr;
+        length = status.st_size;
+        mapped = true;
+    }
+
+    close(fd);
+
+    // Index the line starts. A final line without a terminator
+    // still counts, but a trailing terminator does not start a new line.
+    size_t start = 0;
+    while (start < length)
+    {
+        lineStarts.push_back(start);
+
+        const void *nl = memchr(text + start, '\n', length - start);
+        start = (nl != nullptr) ? (const char *) nl - text + 1 : length;
+    }
+}
+
+inline const char *SourceBuffer::getLine(int lineNumber,
+                                         size_t& lineLength) const
+{
+    if ((lineNumber < 1) || (lineNumber > (int) lineStarts.size()))
+    {
+        lineLength = 0;
+        return nullptr;
+    }
+
+    size_t start = lineStarts[lineNumber - 1];
+    size_t end   = lineNumber < (int) lineStarts.size()
+                       ? lineStarts[lineNumber] : length;
+
+    if ((end > start) && (text[end - 1] == '\n')) end--;
+
+    lineLength = end - start;
+    return text + start;
+}
+
+} // namespace frontend
+
+#endif /* SOURCEBUFFER_H_ */
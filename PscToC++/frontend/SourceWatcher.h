@@ -0,0 +1,127 @@
+#ifndef SOURCEWATCHER_H_
+#define SOURCEWATCHER_H_
+
+#include <iostream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+namespace frontend {
+
+using namespace std;
+
+/**
+ * Watch a source file for changes with inotify, for the watch mode
+ * that translates it again on each change.
+ *
+ * The file's directory is watched rather than the file itself,
+ * since many editors save by writing a new file and renaming it
+ * over the old one, which would silently end a watch on the file.
+ */
+class SourceWatcher
+{
+private:
+    string directoryName;
+    string baseName;
+    int fd;    // inotify instance
+    int wd;    // watch descriptor of the directory
+
+    static const int SETTLE_MS = 50;  // wait for a save to complete
+
+public:
+    /**
+     * Constructor.
+     * @param sourceFileName the name of the source file to watch.
+     */
+    SourceWatcher(string sourceFileName);
+
+    /**
+     * Destructor.
+     */
+    virtual ~SourceWatcher() { close(fd); }
+
+    /**
+     * Block until the source file has been written or replaced.
+     */
+    void waitForChange();
+
+private:
+    /**
+     * Read the pending events.
+     * @return true if any of them is a change to the source file.
+     */
+    bool readEvents();
+};
+
+inline SourceWatcher::SourceWatcher(string sourceFileName)
+{
+    size_t slash = sourceFileName.rfind('/');
+
+    if (slash == string::npos)
+    {
+        directoryName = ".";
+        baseName = sourceFileName;
+    }
+    else
+    {
+        directoryName = slash == 0 ? "/" : sourceFileName.substr(0, slash);
+        baseName = sourceFileName.substr(slash + 1);
+    }
+
+    fd = inotify_init1(IN_CLOEXEC);
+    wd = fd < 0 ? -1
+                : inotify_add_watch(fd, directoryName.c_str(),
+                                    IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (wd < 0)
+    {
+        cout << "ERROR: Failed to watch source file \""
+             << sourceFileName << "\": " << strerror(errno) << endl;
+        exit(-1);
+    }
+}
+
+inline void SourceWatcher::waitForChange()
+{
+    while (!readEvents()) {}
+
+    // Absorb the rest of a burst of events from a single save.
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    while (poll(&pfd, 1, SETTLE_MS) > 0) readEvents();
+}
+
+inline bool SourceWatcher::readEvents()
+{
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length = read(fd, buffer, sizeof(buffer));
+
+    if (length <= 0)
+    {
+        if (errno == EINTR) return false;
+
+        cout << "ERROR: Failed to read file change events: "
+             << strerror(errno) << endl;
+        exit(-1);
+    }
+
+    bool changed = false;
+
+    for (char *p = buffer; p < buffer + length; )
+    {
+        struct inotify_event *event = (struct inotify_event *) p;
+
+        if ((event->len > 0) && (baseName == event->name)) changed = true;
+        p += sizeof(struct inotify_event) + event->len;
+    }
+
+    return changed;
+}
+
+} // namespace frontend
+
+#endif /* SOURCEWATCHER_H_ */
@@ -3,6 +3,8 @@
 
 #include "BaseErrorListener.h"
 
+#include "SourceBuffer.h"
+
 namespace frontend {
 
 using namespace std;
@@ -13,9 +15,11 @@ class SyntaxErrorHandler : public BaseErrorListener
 private:
     int  count;
     bool first;
+    const SourceBuffer *source;  // to print the offending lines, or nullptr
 
 public:
-    SyntaxErrorHandler() : count(0), first(true) {}
+    SyntaxErrorHandler(const SourceBuffer *source = nullptr)
+        : count(0), first(true), source(source) {}
 
     int getCount() const { return count; }
 
@@ -34,6 +38,37 @@ public:
 
         count++;
         printf("%03zu  %-35s\n", line, msg.c_str());
+
+        if (source != nullptr) printSourceLine(line, charPositionInLine);
+    }
+
+private:
+    /**
+     * Print a source line and mark the error position with a caret.
+     * @param line the line number.
+     * @param position the code point position within the line.
+     */
+    void printSourceLine(size_t line, size_t position)
+    {
+        size_t lineLength;
+        const char *text = source->getLine(line, lineLength);
+        if (text == nullptr) return;
+
+        // One blank per code point before the error, skipping the
+        // continuation bytes of UTF-8 sequences. Keep any tabs
+        // so that the caret lines up.
+        string marker;
+        size_t count = 0;
+        for (size_t i = 0; (count < position) && (i < lineLength); i++)
+        {
+            if ((text[i] & 0xC0) == 0x80) continue;
+
+            marker += text[i] == '\t' ? '\t' : ' ';
+            count++;
+        }
+
+        printf("     %.*s\n", (int) lineLength, text);
+        printf("     %s^\n", marker.c_str());
     }
 };
 
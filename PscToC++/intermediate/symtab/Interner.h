@@ -0,0 +1,153 @@
+/**
+ * <h1>Interner</h1>
+ *
+ * <p>Give each distinct identifier a small integer id.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef INTERNER_H_
+#define INTERNER_H_
+
+#include <string>
+#include <vector>
+#include <cctype>
+
+namespace intermediate { namespace symtab {
+
+using namespace std;
+
+/**
+ * The identifier interning table. Pascal identifiers are case-insensitive,
+ * so the table folds letters to lower case as it hashes and compares them,
+ * without making a lower-case copy, and identifiers that differ only in
+ * case get the same id. Ids are dense, starting from 0, and are never
+ * reused, so a symbol table can key its entries by id.
+ */
+class Interner
+{
+public:
+    /**
+     * Get the id of an identifier, giving it one if it has none yet.
+     * @param name the identifier, in any case.
+     * @return its id.
+     */
+    static int intern(const string& name)
+    {
+        size_t slot = probe(name);
+        if (slots()[slot] > 0) return slots()[slot] - 1;
+
+        string lowerCase(name);
+        for (char& ch : lowerCase) ch = tolower((unsigned char) ch);
+
+        names().push_back(lowerCase);
+        slots()[slot] = names().size();
+
+        // Keep the table at most half full.
+        if (2*names().size() > slots().size()) grow();
+
+        return names().size() - 1;
+    }
+
+    /**
+     * Get the id of an identifier without giving it one.
+     * @param name the identifier, in any case.
+     * @return its id, or -1 if it was never interned.
+     */
+    static int find(const string& name) { return slots()[probe(name)] - 1; }
+
+    /**
+     * Get the lower-case name of an id.
+     * @param id the id.
+     * @return the name.
+     */
+    static const string& name(const int id) { return names()[id]; }
+
+private:
+    /**
+     * The lower-case names by id.
+     */
+    static vector<string>& names()
+    {
+        static vector<string> names;
+        return names;
+    }
+
+    /**
+     * The open-addressed slots: ids + 1, or 0 if empty.
+     */
+    static vector<int>& slots()
+    {
+        static vector<int> slots(256, 0);
+        return slots;
+    }
+
+    /**
+     * Hash an identifier with its letters folded to lower case (FNV-1a).
+     * @param name the identifier.
+     * @return the hash value.
+     */
+    static size_t hash(const string& name)
+    {
+        size_t h = 2166136261u;
+
+        for (char ch : name)
+        {
+            h ^= (size_t) tolower((unsigned char) ch);
+            h *= 16777619u;
+        }
+
+        return h;
+    }
+
+    /**
+     * Find the slot of an identifier, or the empty slot where it belongs.
+     * @param name the identifier.
+     * @return the slot index.
+     */
+    static size_t probe(const string& name)
+    {
+        const vector<int>& table = slots();
+        size_t mask = table.size() - 1;
+
+        for (size_t slot = hash(name) & mask; ; slot = (slot + 1) & mask)
+        {
+            if (table[slot] == 0) return slot;
+
+            const string& candidate = names()[table[slot] - 1];
+            if (candidate.length() != name.length()) continue;
+
+            size_t i = 0;
+            while (   (i < name.length())
+                   && (candidate[i] == tolower((unsigned char) name[i])))
+            {
+                i++;
+            }
+
+            if (i == name.length()) return slot;
+        }
+    }
+
+    /**
+     * Double the number of slots and reinsert the ids.
+     */
+    static void grow()
+    {
+        vector<int>& table = slots();
+        vector<int> ids;
+        for (int id : table) if (id > 0) ids.push_back(id);
+
+        table.assign(2*table.size(), 0);
+        size_t mask = table.size() - 1;
+
+        for (int id : ids)
+        {
+            size_t slot = hash(names()[id - 1]) & mask;
+            while (table[slot] != 0) slot = (slot + 1) & mask;
+            table[slot] = id;
+        }
+    }
+};
+
+}}  // namespace intermediate::symtab
+
+#endif /* INTERNER_H_ */
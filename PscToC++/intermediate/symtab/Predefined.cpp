@@ -72,36 +72,36 @@ void Predefined::initializeTypes(SymtabStack *symtabStack)
 {
     // Type integer.
     integerId = symtabStack->enterLocal("integer", TYPE);
-    integerType = new Typespec(SCALAR);
+    integerType = Arena::make<Typespec>(SCALAR);
     integerType->setIdentifier(integerId);
     integerId->setType(integerType);
 
     // Type real.
     realId = symtabStack->enterLocal("real", TYPE);
-    realType = new Typespec(SCALAR);
+    realType = Arena::make<Typespec>(SCALAR);
     realType->setIdentifier(realId);
     realId->setType(realType);
 
     // Type boolean.
     booleanId = symtabStack->enterLocal("boolean", TYPE);
-    booleanType = new Typespec(ENUMERATION);
+    booleanType = Arena::make<Typespec>(ENUMERATION);
     booleanType->setIdentifier(booleanId);
     booleanId->setType(booleanType);
 
     // Type char.
     charId = symtabStack->enterLocal("char", TYPE);
-    charType = new Typespec(SCALAR);
+    charType = Arena::make<Typespec>(SCALAR);
     charType->setIdentifier(charId);
     charId->setType(charType);
 
     // Type string.
     stringId = symtabStack->enterLocal("string", TYPE);
-    stringType = new Typespec(SCALAR);
+    stringType = Arena::make<Typespec>(SCALAR);
     stringType->setIdentifier(stringId);
     stringId->setType(stringType);
 
     // Undefined type.
-    undefinedType = new Typespec(SCALAR);
+    undefinedType = Arena::make<Typespec>(SCALAR);
 }
 
 void Predefined::initializeConstants(SymtabStack *symtabStack)
@@ -117,7 +117,8 @@ void Predefined::initializeConstants(SymtabStack *symtabStack)
     trueId->setValue(1);
 
     // Add false and true to the boolean enumeration type.
-    vector<SymtabEntry *> *constants = new vector<SymtabEntry *>;
+    vector<SymtabEntry *> *constants =
+                                    Arena::make<vector<SymtabEntry *>>();
     constants->push_back(falseId);
     constants->push_back(trueId);
     booleanType->setEnumerationConstants(constants);
@@ -10,9 +10,11 @@
 #define SYMTABIMPL_H_
 
 #include <string>
-#include <map>
+#include <vector>
+#include <algorithm>
 
 #include "SymtabEntry.h"
+#include "Interner.h"
 
 namespace intermediate { namespace symtab {
 
@@ -29,9 +31,22 @@ private:
     int slotNumber;                       // local variables array slot number
     int maxSlotNumber;                    // max slot number value
     SymtabEntry *ownerId;                 // symbol table entry of the owner
-    map<string, SymtabEntry *> contents;  // entries
+    vector<SymtabEntry *> contents;       // entries in the order entered
+
+    /**
+     * A slot of the hash table of entries by identifier id.
+     */
+    struct Slot
+    {
+        int id;                           // identifier id, or -1 if empty
+        int order;                        // index of the entry in contents
+        SymtabEntry *entry;
+    };
+
+    vector<Slot> slots;                   // open addressing, linear probing
 
     static int unnamedIndex;              // index for unnamed type names
+    static string unnamedScope;           // unit name for unnamed type names
 
 public:
     /**
@@ -40,7 +55,7 @@ public:
      */
     Symtab(const int nestingLevel)
         : nestingLevel(nestingLevel), slotNumber(-1), maxSlotNumber(-1),
-          ownerId(nullptr) {}
+          ownerId(nullptr), slots(8, Slot { -1, -1, nullptr }) {}
 
     /**
      * Destructor.
@@ -76,7 +91,19 @@ public:
     static string generateUnnamedName()
     {
         unnamedIndex++;
-        return UNNAMED_PREFIX + to_string(unnamedIndex);
+        return UNNAMED_PREFIX + unnamedScope + to_string(unnamedIndex);
+    }
+
+    /**
+     * Restart the generated names for unnamed types, so that
+     * translating the same source again generates the same names.
+     * @param scope the name of the unit being translated, if any, so
+     * that the names don't clash with those of the units it uses.
+     */
+    static void resetUnnamedIndex(const string& scope = "")
+    {
+        unnamedIndex = 0;
+        unnamedScope = scope.empty() ? "" : scope + "_";
     }
 
     /**
@@ -93,43 +120,92 @@ public:
 	
     /**
      * Create and enter a new entry into the symbol table.
+     * It replaces any entry with the same name.
      * @param name the name of the entry.
      * @param kind the kind of entry.
      * @return the new entry.
      */
     SymtabEntry *enter(const string name, const Kind kind)
     {
-        SymtabEntry *entry = new SymtabEntry(name, kind, this);
-        contents[name] = entry;
+        SymtabEntry *entry = Arena::make<SymtabEntry>(name, kind, this);
+        int id = Interner::intern(name);
+        Slot& slot = slots[probe(id)];
+
+        if (slot.id >= 0)
+        {
+            replace(contents.begin(), contents.end(), slot.entry, entry);
+            slot.entry = entry;
+            return entry;
+        }
+
+        slot = { id, (int) contents.size(), entry };
+        contents.push_back(entry);
+
+        // Keep the table at most half full.
+        if (2*contents.size() > slots.size()) grow();
 
         return entry;
     }
 
     /**
      * Look up an existing symbol table entry.
-     * @param name the name of the entry.
+     * @param name the name of the entry, in any case.
+     * @return the entry, or null if it does not exist.
+     */
+    SymtabEntry *lookup(const string& name) const
+    {
+        int id = Interner::find(name);
+        return id >= 0 ? lookup(id) : nullptr;
+    }
+
+    /**
+     * Look up an existing symbol table entry.
+     * @param id the interned id of the entry's name.
      * @return the entry, or null if it does not exist.
      */
-    SymtabEntry *lookup(const string name)
+    SymtabEntry *lookup(const int id) const
+    {
+        return slots[probe(id)].entry;
+    }
+
+    /**
+     * Look up an existing symbol table entry among the ones entered first.
+     * @param id the interned id of the entry's name.
+     * @param visible the number of entries, in the order entered, to search.
+     * @return the entry, or null if it does not exist among them.
+     */
+    SymtabEntry *lookup(const int id, const int visible) const
     {
-        return (contents.find(name) != contents.end()) ? contents[name]
-                                                       : nullptr;
+        const Slot& slot = slots[probe(id)];
+        return slot.order < visible ? slot.entry : nullptr;
     }
 
     /**
-     * Return a vector of entries sorted by name.
+     * Get the number of entries.
+     * @return the number.
+     */
+    int size() const { return contents.size(); }
+
+    /**
+     * Get the entries in the order they were entered.
+     * @return the entries.
+     */
+    const vector<SymtabEntry *>& entries() const { return contents; }
+
+    /**
+     * Return a vector of entries sorted by name. The table is not kept
+     * sorted, so this sorts a copy of the entries each time.
      * @return the sorted vector.
      */
-    vector<SymtabEntry *> sortedEntries()
+    vector<SymtabEntry *> sortedEntries() const
     {
-        vector<SymtabEntry *> list;
-        map<string, SymtabEntry *>::iterator it;
+        vector<SymtabEntry *> list(contents);
 
-        // Iterate over the sorted entries and append them to the list.
-        for (it = contents.begin(); it != contents.end(); it++)
-        {
-            list.push_back(it->second);
-        }
+        sort(list.begin(), list.end(),
+             [] (SymtabEntry *a, SymtabEntry *b)
+             {
+                 return a->getName() < b->getName();
+             });
 
         return list;  // sorted list of entries
     }
@@ -140,16 +216,45 @@ public:
      */
     void resetVariables(Kind kind)
     {
-        vector<SymtabEntry *> list;
-        map<string, SymtabEntry *>::iterator it;
-
         // Iterate over the entries and reset their kind.
-        for (it = contents.begin(); it != contents.end(); it++)
+        for (SymtabEntry *entry : contents)
         {
-            SymtabEntry *entry = it->second;
             if (entry->getKind() == VARIABLE) entry->setKind(kind);
         }
     }
+
+private:
+    /**
+     * Find the slot of an id, or the empty slot where it belongs.
+     * @param id the id.
+     * @return the slot index.
+     */
+    size_t probe(const int id) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t slot = ((size_t) id*2654435761u) & mask;
+
+        while ((slots[slot].id >= 0) && (slots[slot].id != id))
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        return slot;
+    }
+
+    /**
+     * Double the number of slots and reinsert the entries.
+     */
+    void grow()
+    {
+        vector<Slot> old(slots);
+        slots.assign(2*slots.size(), Slot { -1, -1, nullptr });
+
+        for (const Slot& slot : old)
+        {
+            if (slot.id >= 0) slots[probe(slot.id)] = slot;
+        }
+    }
 };
 
 }}  // namespace intermediate::symtab
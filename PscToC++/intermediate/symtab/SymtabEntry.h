@@ -15,6 +15,7 @@
 #include "antlr4-runtime.h"
 
 #include "../../Object.h"
+#include "intermediate/util/Arena.h"
 
 // Forward declaration of class Typespec in namespace intermediate::type.
 namespace intermediate { namespace type {
@@ -25,6 +26,7 @@ namespace intermediate { namespace symtab {
 
 using namespace std;
 using intermediate::type::Typespec;
+using intermediate::util::Arena;
 
 // More forward class declarations but in the same namespace.
 class Symtab;
@@ -37,7 +39,7 @@ enum class Kind
 {
     CONSTANT, ENUMERATION_CONSTANT, TYPE, VARIABLE, RECORD_FIELD,
     VALUE_PARAMETER, REFERENCE_PARAMETER, PROGRAM_PARAMETER,
-    PROGRAM, PROCEDURE, FUNCTION,
+    PROGRAM, PROCEDURE, FUNCTION, UNIT,
     UNDEFINED
 };
 
@@ -45,7 +47,7 @@ static const string KIND_STRINGS[] =
 {
     "constant", "enumeration constant", "type", "variable", "record field",
     "value parameter", "reference parameter", "program parameter",
-    "PROGRAM", "PROCEDURE", "FUNCTION",
+    "PROGRAM", "PROCEDURE", "FUNCTION", "UNIT",
     "undefined"
 };
 
@@ -60,6 +62,7 @@ constexpr Kind PROGRAM_PARAMETER    = Kind::PROGRAM_PARAMETER;
 constexpr Kind PROGRAM              = Kind::PROGRAM;
 constexpr Kind PROCEDURE            = Kind::PROCEDURE;
 constexpr Kind FUNCTION             = Kind::FUNCTION;
+constexpr Kind UNIT                 = Kind::UNIT;
 constexpr Kind UNDEFINED            = Kind::UNDEFINED;
 
 /**
@@ -128,6 +131,7 @@ private:
     Typespec *typespec;       // type specification
     int slotNumber;           // local variables array slot number
     vector<int> lineNumbers;  // source line numbers
+    int debugFlags;           // debugger watchpoint flags
     EntryInfo info;           // entry information
 
 public:
@@ -139,7 +143,7 @@ public:
      */
     SymtabEntry(const string name, const Kind kind, Symtab *symtab)
         : name(name), kind(kind), symtab(symtab), typespec(nullptr),
-          slotNumber(0)
+          slotNumber(0), debugFlags(0)
     {
         switch (kind)
         {
@@ -154,9 +158,12 @@ public:
             case Kind::PROGRAM:
             case Kind::PROCEDURE:
             case Kind::FUNCTION:
+            case Kind::UNIT:
                 info.routine.symtab = nullptr;
-                info.routine.parameters  = new vector<SymtabEntry *>();
-                info.routine.subroutines = new vector<SymtabEntry *>();
+                info.routine.parameters  =
+                                    Arena::make<vector<SymtabEntry *>>();
+                info.routine.subroutines =
+                                    Arena::make<vector<SymtabEntry *>>();
                 break;
 
             default: break;
@@ -231,6 +238,24 @@ public:
         lineNumbers.push_back(_number);
     }
 
+    /**
+     * Getter.
+     * @return the debugger flags set on this entry.
+     */
+    int getDebugFlags() const { return debugFlags; }
+
+    /**
+     * Set debugger flags on this entry.
+     * @param flags the flags to set.
+     */
+    void setDebugFlags(int flags) { debugFlags |= flags; }
+
+    /**
+     * Clear debugger flags on this entry.
+     * @param flags the flags to clear.
+     */
+    void clearDebugFlags(int flags) { debugFlags &= ~flags; }
+
     /**
      * Get the data value stored with this entry.
      * @return the data value.
@@ -241,7 +266,7 @@ public:
      * Set the data value into this entry.
      * @parm value the value to set.
      */
-    void setValue(Object value) { info.data.value = new Object(value); }
+    void setValue(Object value) { info.data.value = Arena::make<Object>(value); }
 
     /**
      * Get the routine code.
@@ -315,7 +340,7 @@ public:
      */
     void setExecutable(Object executable)
     {
-        info.routine.executable = new Object(executable);
+        info.routine.executable = Arena::make<Object>(executable);
     }
 };
 
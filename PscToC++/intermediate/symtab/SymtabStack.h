@@ -27,23 +27,54 @@ private:
 
     vector<Symtab *> stack;
 
+    Symtab *horizon_symtab;     // symbol table with entries not yet visible
+    int horizon;                // how many of its entries are visible
+
 public:
     /**
      * Constructor.
      */
-    SymtabStack() : current_nesting_level(0), program_id(nullptr)
+    SymtabStack()
+        : current_nesting_level(0), program_id(nullptr),
+          horizon_symtab(nullptr), horizon(0)
     {
-        stack.push_back(new Symtab(0));
+        stack.push_back(Arena::make<Symtab>(0));
     }
 
     /**
-     * Destructor.
+     * Constructor for the scope of a routine that has already been
+     * declared, such as to check an expression typed into the debugger.
+     * The stack shares the symbol tables of the routine and its enclosing
+     * routines.
+     * @param routineId the symbol table entry of the routine.
      */
-    virtual ~SymtabStack()
+    SymtabStack(SymtabEntry *routineId)
+        : current_nesting_level(0), program_id(nullptr),
+          horizon_symtab(nullptr), horizon(0)
     {
-        for (Symtab *symtab : stack) if (symtab != nullptr) delete symtab;
+        // Collect the scopes from the innermost outwards.
+        for (SymtabEntry *id = routineId; id != nullptr; )
+        {
+            Symtab *enclosing = id->getSymtab();
+            stack.insert(stack.begin(), id->getRoutineSymtab());
+
+            if (enclosing->getNestingLevel() == 0)
+            {
+                stack.insert(stack.begin(), enclosing);
+                program_id = id;
+                id = nullptr;
+            }
+            else id = enclosing->getOwner();
+        }
+
+        current_nesting_level = stack.size() - 1;
     }
 
+    /**
+     * Destructor. The symbol tables belong to the arena.
+     */
+    virtual ~SymtabStack() {}
+
     /**
      * Getter.
      * @return the current nesting level.
@@ -74,7 +105,7 @@ public:
      */
     Symtab *push()
     {
-        Symtab *symtab = new Symtab(++current_nesting_level);
+        Symtab *symtab = Arena::make<Symtab>(++current_nesting_level);
         stack.push_back(symtab);
 
         return symtab;
@@ -119,20 +150,45 @@ public:
 
     /**
      * Look up an existing symbol table entry in the local symbol table.
-     * @param name the name of the entry.
+     * @param name the name of the entry, in any case.
      * @return the entry, or null if it does not exist.
      */
-    SymtabEntry *lookupLocal(const string name) const
+    SymtabEntry *lookupLocal(const string& name) const
     {
         return stack[current_nesting_level]->lookup(name);
     }
 
+    /**
+     * Make lookups throughout the stack see only the first entries
+     * entered into a symbol table, such as to check a routine's body
+     * after the routines declared after it have also been entered.
+     * @param symtab the symbol table.
+     * @param visible the number of its entries to see.
+     */
+    void setHorizon(Symtab *symtab, int visible)
+    {
+        horizon_symtab = symtab;
+        horizon = visible;
+    }
+
     /**
      * Look up an existing symbol table entry throughout the stack.
-     * @param name the name of the entry.
+     * @param name the name of the entry, in any case.
+     * @return the entry, or null if it does not exist.
+     */
+    SymtabEntry *lookup(const string& name) const
+    {
+        // Hash the name once for all the scopes.
+        int id = Interner::find(name);
+        return id >= 0 ? lookup(id) : nullptr;
+    }
+
+    /**
+     * Look up an existing symbol table entry throughout the stack.
+     * @param id the interned id of the entry's name.
      * @return the entry, or null if it does not exist.
      */
-    SymtabEntry *lookup(const string name) const
+    SymtabEntry *lookup(const int id) const
     {
         SymtabEntry *found_entry = nullptr;
 
@@ -140,7 +196,9 @@ public:
         for (int i = current_nesting_level;
              (i >= 0) && (found_entry == nullptr); --i)
         {
-            found_entry = stack[i]->lookup(name);
+            found_entry = stack[i] != horizon_symtab
+                                ? stack[i]->lookup(id)
+                                : stack[i]->lookup(id, horizon);
         }
 
         return found_entry;
@@ -0,0 +1,639 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "intermediate/symtab/Predefined.h"
+#include "intermediate/util/Arena.h"
+#include "UnitInterface.h"
+
+namespace intermediate { namespace symtab {
+
+using namespace std;
+using namespace intermediate::type;
+using intermediate::util::Arena;
+
+// The file starts with the magic bytes, the last of which is the version
+// of the format. Change the version whenever the format changes.
+static const char MAGIC[] = { 'P', 'U', 'I', 1 };
+
+// Type references: -1 for none, the index of a predefined type,
+// or FIRST_TYPE plus the index in the interface's type table.
+static const int FIRST_TYPE = 16;
+
+enum TypeTag { NAMED_TYPE, ENUMERATION_TYPE, SUBRANGE_TYPE, ARRAY_TYPE,
+               RECORD_TYPE };
+
+enum ValueTag { NO_VALUE, INTEGER_VALUE, REAL_VALUE, CHAR_VALUE,
+                BOOLEAN_VALUE, STRING_VALUE };
+
+/**
+ * @return the predefined types, in the order of their references.
+ */
+static vector<Typespec *> predefinedTypes()
+{
+    return { Predefined::integerType, Predefined::realType,
+             Predefined::booleanType, Predefined::charType,
+             Predefined::stringType,  Predefined::undefinedType };
+}
+
+/**
+ * Number the entries and types that the exports of a unit refer to.
+ */
+class Tables
+{
+public:
+    vector<SymtabEntry *> entries;
+    vector<Typespec *> types;
+
+    Tables() : predefined(predefinedTypes()) {}
+
+    /**
+     * Get the index of an entry, adding it and what it refers to
+     * to the tables if it isn't there yet.
+     */
+    int entry(SymtabEntry *id)
+    {
+        auto it = entryIndex.find(id);
+        if (it != entryIndex.end()) return it->second;
+
+        int index = entries.size();
+        entries.push_back(id);
+        entryIndex[id] = index;
+
+        type(id->getType());
+
+        Kind kind = id->getKind();
+        if ((kind == PROCEDURE) || (kind == FUNCTION))
+        {
+            for (SymtabEntry *parmId : *id->getRoutineParameters())
+            {
+                type(parmId->getType());
+            }
+        }
+
+        return index;
+    }
+
+    /**
+     * Get the reference to a type, adding it and what it refers to
+     * to the tables if it isn't there yet.
+     */
+    int type(Typespec *typespec)
+    {
+        if (typespec == nullptr) return -1;
+
+        for (size_t i = 0; i < predefined.size(); i++)
+        {
+            if (typespec == predefined[i]) return i;
+        }
+
+        auto it = typeIndex.find(typespec);
+        if (it != typeIndex.end()) return FIRST_TYPE + it->second;
+
+        int index = types.size();
+        types.push_back(typespec);
+        typeIndex[typespec] = index;
+
+        // A type from another unit is referred to only by name.
+        if (isForeign(typespec)) return FIRST_TYPE + index;
+
+        if (typespec->getIdentifier() != nullptr)
+        {
+            entry(typespec->getIdentifier());
+        }
+
+        switch (typespec->getForm())
+        {
+            case Form::ENUMERATION:
+                for (SymtabEntry *constantId :
+                                    *typespec->getEnumerationConstants())
+                {
+                    entry(constantId);
+                }
+                break;
+
+            case Form::SUBRANGE:
+                type(typespec->getSubrangeBaseType());
+                break;
+
+            case Form::ARRAY:
+                type(typespec->getArrayIndexType());
+                type(typespec->getArrayElementType());
+                break;
+
+            case Form::RECORD:
+                for (SymtabEntry *fieldId :
+                                typespec->getRecordSymtab()->entries())
+                {
+                    entry(fieldId);
+                }
+                break;
+
+            default: break;
+        }
+
+        return FIRST_TYPE + index;
+    }
+
+    /**
+     * Determine whether a type was declared by another unit,
+     * whose exports are entered at nesting level 0.
+     */
+    static bool isForeign(Typespec *typespec)
+    {
+        SymtabEntry *typeId = typespec->getIdentifier();
+        return    (typeId != nullptr)
+               && (typeId->getSymtab()->getNestingLevel() == 0);
+    }
+
+private:
+    vector<Typespec *> predefined;
+    unordered_map<SymtabEntry *, int> entryIndex;
+    unordered_map<Typespec *, int> typeIndex;
+};
+
+/**
+ * Encode the parts of an interface file.
+ */
+class Encoder
+{
+public:
+    string data;
+
+    void writeInt(int value)
+    {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void writeDouble(double value)
+    {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void writeString(const string& value)
+    {
+        writeInt(value.length());
+        data.append(value);
+    }
+
+    void writeValue(Object value)
+    {
+        if (value.isNull())             writeInt(NO_VALUE);
+        else if (value.is<int>())
+        {
+            writeInt(INTEGER_VALUE);
+            writeInt(value.as<int>());
+        }
+        else if (value.is<double>())
+        {
+            writeInt(REAL_VALUE);
+            writeDouble(value.as<double>());
+        }
+        else if (value.is<char>())
+        {
+            writeInt(CHAR_VALUE);
+            writeInt(value.as<char>());
+        }
+        else if (value.is<bool>())
+        {
+            writeInt(BOOLEAN_VALUE);
+            writeInt(value.as<bool>());
+        }
+        else if (value.is<string *>())
+        {
+            writeInt(STRING_VALUE);
+            writeString(*value.as<string *>());
+        }
+        else writeInt(NO_VALUE);
+    }
+};
+
+bool UnitInterface::write(SymtabEntry *unitId,
+                          const vector<SymtabEntry *>& exports,
+                          const vector<string>& uses)
+{
+    Tables tables;
+    for (SymtabEntry *id : exports) tables.entry(id);
+
+    unordered_set<SymtabEntry *> exported(exports.begin(), exports.end());
+    Encoder out;
+
+    out.data.append(MAGIC, sizeof(MAGIC));
+    out.writeString(unitId->getName());
+    out.writeInt(uses.size());
+    for (const string& unitName : uses) out.writeString(unitName);
+
+    // The types.
+    out.writeInt(tables.types.size());
+    for (Typespec *typespec : tables.types)
+    {
+        SymtabEntry *typeId = typespec->getIdentifier();
+
+        if (Tables::isForeign(typespec))
+        {
+            out.writeInt(NAMED_TYPE);
+            out.writeString(typeId->getName());
+            continue;
+        }
+
+        switch (typespec->getForm())
+        {
+            case Form::ENUMERATION:
+                out.writeInt(ENUMERATION_TYPE);
+                break;
+            case Form::SUBRANGE:
+                out.writeInt(SUBRANGE_TYPE);
+                break;
+            case Form::ARRAY:
+                out.writeInt(ARRAY_TYPE);
+                break;
+            default:
+                out.writeInt(RECORD_TYPE);
+                break;
+        }
+
+        out.writeInt(typeId != nullptr ? tables.entry(typeId) : -1);
+
+        switch (typespec->getForm())
+        {
+            case Form::ENUMERATION:
+            {
+                vector<SymtabEntry *> *constants =
+                                        typespec->getEnumerationConstants();
+                out.writeInt(constants->size());
+                for (SymtabEntry *constantId : *constants)
+                {
+                    out.writeInt(tables.entry(constantId));
+                }
+                break;
+            }
+
+            case Form::SUBRANGE:
+                out.writeInt(tables.type(typespec->getSubrangeBaseType()));
+                out.writeInt(typespec->getSubrangeMinValue());
+                out.writeInt(typespec->getSubrangeMaxValue());
+                break;
+
+            case Form::ARRAY:
+                out.writeInt(tables.type(typespec->getArrayIndexType()));
+                out.writeInt(tables.type(typespec->getArrayElementType()));
+                out.writeInt(typespec->getArrayElementCount());
+                break;
+
+            default:
+                out.writeString(typespec->getRecordTypePath());
+                out.writeInt(typespec->getRecordSymtab()->getNestingLevel());
+                break;
+        }
+    }
+
+    // The entries. An exported entry goes into the symbol table that
+    // the interface is loaded into, and a field into its record's table.
+    out.writeInt(tables.entries.size());
+    for (SymtabEntry *id : tables.entries)
+    {
+        Kind kind = id->getKind();
+        int container = -1;
+
+        if (exported.find(id) == exported.end())
+        {
+            SymtabEntry *ownerId = id->getSymtab()->getOwner();
+            if (   (ownerId != nullptr) && (ownerId->getType() != nullptr)
+                && (ownerId->getType()->getForm() == RECORD))
+            {
+                container = tables.type(ownerId->getType()) - FIRST_TYPE;
+            }
+        }
+
+        out.writeString(id->getName());
+        out.writeInt((int) kind);
+        out.writeInt(container);
+        out.writeInt(tables.type(id->getType()));
+
+        if ((kind == CONSTANT) || (kind == ENUMERATION_CONSTANT))
+        {
+            out.writeValue(id->getValue());
+        }
+        else if ((kind == PROCEDURE) || (kind == FUNCTION))
+        {
+            vector<SymtabEntry *> *parms = id->getRoutineParameters();
+
+            out.writeInt(id->getRoutineSymtab()->getNestingLevel());
+            out.writeInt(parms->size());
+            for (SymtabEntry *parmId : *parms)
+            {
+                out.writeString(parmId->getName());
+                out.writeInt((int) parmId->getKind());
+                out.writeInt(tables.type(parmId->getType()));
+            }
+        }
+    }
+
+    // Write a temporary file and rename it, so that
+    // no one who loads the interface sees a partial file.
+    string name = fileName(unitId->getName());
+    string temporaryName = name + "." + to_string((long) getpid());
+
+    ofstream file(temporaryName, ios::binary | ios::trunc);
+    file.write(out.data.data(), out.data.length());
+    file.close();
+
+    if (!file || (rename(temporaryName.c_str(), name.c_str()) < 0))
+    {
+        unlink(temporaryName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool UnitInterface::read(const string& unitName)
+{
+    ifstream file(fileName(unitName), ios::binary);
+    if (!file.is_open()) return false;
+
+    stringstream buffer;
+    buffer << file.rdbuf();
+    data = buffer.str();
+    position = 0;
+    valid = true;
+
+    if (   (data.length() < sizeof(MAGIC))
+        || (memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0))
+    {
+        return false;
+    }
+    position = sizeof(MAGIC);
+
+    name = readString();
+
+    uses.clear();
+    int count = readInt();
+    for (int i = 0; valid && (i < count); i++) uses.push_back(readString());
+
+    return valid && (toLowerCase(name) == toLowerCase(unitName));
+}
+
+int UnitInterface::readInt()
+{
+    int value = 0;
+
+    if (position + sizeof(value) > data.length()) valid = false;
+    else
+    {
+        memcpy(&value, data.data() + position, sizeof(value));
+        position += sizeof(value);
+    }
+
+    return value;
+}
+
+double UnitInterface::readDouble()
+{
+    double value = 0;
+
+    if (position + sizeof(value) > data.length()) valid = false;
+    else
+    {
+        memcpy(&value, data.data() + position, sizeof(value));
+        position += sizeof(value);
+    }
+
+    return value;
+}
+
+string UnitInterface::readString()
+{
+    int length = readInt();
+
+    if ((length < 0) || (position + length > data.length()))
+    {
+        valid = false;
+        return "";
+    }
+
+    string value = data.substr(position, length);
+    position += length;
+
+    return value;
+}
+
+Typespec *UnitInterface::resolve(int ref, const vector<Typespec *>& types)
+{
+    static const int PREDEFINED_COUNT = 6;
+
+    if ((ref >= 0) && (ref < PREDEFINED_COUNT)) return predefinedTypes()[ref];
+    if ((ref >= FIRST_TYPE) && (ref - FIRST_TYPE < (int) types.size()))
+    {
+        return types[ref - FIRST_TYPE];
+    }
+
+    return nullptr;
+}
+
+bool UnitInterface::enter(Symtab *symtab)
+{
+    /**
+     * A type as it was read, to fill in once all the types
+     * and entries have been created.
+     */
+    struct TypeRecord
+    {
+        int tag;
+        int identifier = -1;
+        vector<int> refs;   // component types, or enumeration constants
+        int low = 0, high = 0;
+    };
+
+    // Create the types first, since entries and types refer to each other.
+    int typeCount = readInt();
+    vector<Typespec *> types;
+    vector<TypeRecord> records;
+
+    for (int i = 0; valid && (i < typeCount); i++)
+    {
+        TypeRecord record;
+        record.tag = readInt();
+        Typespec *typespec = nullptr;
+
+        if (record.tag == NAMED_TYPE)
+        {
+            SymtabEntry *typeId = symtab->lookup(readString());
+            if ((typeId == nullptr) || (typeId->getKind() != TYPE)) return false;
+
+            typespec = typeId->getType();
+        }
+        else
+        {
+            record.identifier = readInt();
+
+            switch (record.tag)
+            {
+                case ENUMERATION_TYPE:
+                {
+                    typespec = Arena::make<Typespec>(ENUMERATION);
+                    int count = readInt();
+                    for (int j = 0; valid && (j < count); j++)
+                    {
+                        record.refs.push_back(readInt());
+                    }
+                    break;
+                }
+
+                case SUBRANGE_TYPE:
+                    typespec = Arena::make<Typespec>(SUBRANGE);
+                    record.refs.push_back(readInt());
+                    record.low  = readInt();
+                    record.high = readInt();
+                    break;
+
+                case ARRAY_TYPE:
+                    typespec = Arena::make<Typespec>(ARRAY);
+                    record.refs.push_back(readInt());
+                    record.refs.push_back(readInt());
+                    record.low = readInt();
+                    break;
+
+                case RECORD_TYPE:
+                {
+                    typespec = Arena::make<Typespec>(RECORD);
+                    typespec->setRecordTypePath(readString());
+                    typespec->setRecordSymtab(Arena::make<Symtab>(readInt()));
+                    break;
+                }
+
+                default: return false;
+            }
+        }
+
+        types.push_back(typespec);
+        records.push_back(record);
+    }
+
+    // Create the entries.
+    int entryCount = readInt();
+    vector<SymtabEntry *> entries;
+
+    for (int i = 0; valid && (i < entryCount); i++)
+    {
+        string entryName = readString();
+        Kind kind = (Kind) readInt();
+        int container = readInt();
+        Typespec *typespec = resolve(readInt(), types);
+
+        Symtab *table = symtab;
+        if (container >= 0)
+        {
+            if (   (container >= (int) types.size())
+                || (types[container]->getForm() != RECORD))
+            {
+                return false;
+            }
+
+            table = types[container]->getRecordSymtab();
+        }
+
+        SymtabEntry *id = table->enter(entryName, kind);
+        id->setType(typespec);
+
+        if ((kind == CONSTANT) || (kind == ENUMERATION_CONSTANT))
+        {
+            switch (readInt())
+            {
+                case INTEGER_VALUE: id->setValue(readInt()); break;
+                case REAL_VALUE:    id->setValue(readDouble()); break;
+                case CHAR_VALUE:    id->setValue((char) readInt()); break;
+                case BOOLEAN_VALUE: id->setValue((bool) readInt()); break;
+                case STRING_VALUE:
+                    id->setValue(Arena::make<string>(readString()));
+                    break;
+                default: id->setValue(0); break;
+            }
+        }
+        else if ((kind == PROCEDURE) || (kind == FUNCTION))
+        {
+            Symtab *routineSymtab = Arena::make<Symtab>(readInt());
+            vector<SymtabEntry *> *parms = Arena::make<vector<SymtabEntry *>>();
+
+            int count = readInt();
+            for (int j = 0; valid && (j < count); j++)
+            {
+                string parmName = readString();
+                Kind parmKind = (Kind) readInt();
+
+                SymtabEntry *parmId = routineSymtab->enter(parmName, parmKind);
+                parmId->setType(resolve(readInt(), types));
+                parmId->setSlotNumber(routineSymtab->nextSlotNumber());
+                parms->push_back(parmId);
+            }
+
+            routineSymtab->setOwner(id);
+            id->setRoutineCode(DECLARED);
+            id->setRoutineSymtab(routineSymtab);
+            id->setRoutineParameters(parms);
+        }
+
+        entries.push_back(id);
+    }
+
+    if (!valid) return false;
+
+    auto entryAt = [&entries] (int index)
+    {
+        return (index >= 0) && (index < (int) entries.size())
+                                    ? entries[index] : nullptr;
+    };
+
+    // Fill in the types.
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        TypeRecord& record = records[i];
+        Typespec *typespec = types[i];
+
+        if (record.tag == NAMED_TYPE) continue;
+
+        SymtabEntry *typeId = entryAt(record.identifier);
+        if (typeId != nullptr) typespec->setIdentifier(typeId);
+
+        switch (record.tag)
+        {
+            case ENUMERATION_TYPE:
+            {
+                vector<SymtabEntry *> *constants =
+                                        typespec->getEnumerationConstants();
+                for (int ref : record.refs)
+                {
+                    if (entryAt(ref) != nullptr) constants->push_back(entryAt(ref));
+                }
+                break;
+            }
+
+            case SUBRANGE_TYPE:
+                typespec->setSubrangeBaseType(resolve(record.refs[0], types));
+                typespec->setSubrangeMinValue(record.low);
+                typespec->setSubrangeMaxValue(record.high);
+                break;
+
+            case ARRAY_TYPE:
+                typespec->setArrayIndexType(resolve(record.refs[0], types));
+                typespec->setArrayElementType(resolve(record.refs[1], types));
+                typespec->setArrayElementCount(record.low);
+                break;
+
+            case RECORD_TYPE:
+                typespec->getRecordSymtab()->setOwner(typeId);
+                break;
+        }
+    }
+
+    return true;
+}
+
+}}  // namespace intermediate::symtab
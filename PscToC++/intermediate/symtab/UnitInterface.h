@@ -0,0 +1,106 @@
+/**
+ * <h1>UnitInterface</h1>
+ *
+ * <p>The precompiled interface of a unit: the symbol table entries and
+ * type specifications that the unit exports, in a binary file that a
+ * program or another unit loads instead of analyzing the unit's source.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef UNITINTERFACE_H_
+#define UNITINTERFACE_H_
+
+#include <string>
+#include <vector>
+
+#include "Symtab.h"
+#include "SymtabEntry.h"
+#include "intermediate/type/Typespec.h"
+
+namespace intermediate { namespace symtab {
+
+using namespace std;
+using intermediate::type::Typespec;
+
+/**
+ * The file holds the unit's name, the names of the units its interface
+ * uses, a table of the types that the exports refer to, and a table of
+ * the entries: the exports themselves, then the fields of exported
+ * record types. Entries and types refer to one another by their
+ * indexes in the tables. A predefined type is referred to by a fixed
+ * index, and a type exported by another unit by its name, which must
+ * already be entered when the interface is loaded.
+ */
+class UnitInterface
+{
+public:
+    /**
+     * Get the name of the interface file of a unit.
+     * @param unitName the name of the unit, in any case.
+     * @return the file name.
+     */
+    static string fileName(const string& unitName)
+    {
+        return toLowerCase(unitName) + ".pui";
+    }
+
+    /**
+     * Write the interface file of a unit.
+     * @param unitId the symbol table entry of the unit identifier.
+     * @param exports the entries the unit exports, in the order declared.
+     * @param uses the names of the units that the interface uses.
+     * @return true if written.
+     */
+    static bool write(SymtabEntry *unitId, const vector<SymtabEntry *>& exports,
+                      const vector<string>& uses);
+
+    /**
+     * Read the interface file of a unit.
+     * @param unitName the name of the unit.
+     * @return true if it was read and is valid.
+     */
+    bool read(const string& unitName);
+
+    /**
+     * Get the name of the unit as it was declared.
+     * @return the name.
+     */
+    const string& getName() const { return name; }
+
+    /**
+     * Get the names of the units that the interface uses. They must be
+     * loaded before this one.
+     * @return the names.
+     */
+    const vector<string>& getUses() const { return uses; }
+
+    /**
+     * Enter the exports that were read into a symbol table.
+     * @param symtab the symbol table.
+     * @return true if every type referred to by name was found.
+     */
+    bool enter(Symtab *symtab);
+
+private:
+    string name;
+    vector<string> uses;
+    string data;      // the rest of the file: the types and entries
+    size_t position;  // the next byte of data to decode
+    bool valid;       // false once any decoding ran past the data
+
+    int readInt();
+    double readDouble();
+    string readString();
+
+    /**
+     * Find the type that a reference refers to.
+     * @param ref the reference.
+     * @param types the types of this interface.
+     * @return the type, or null.
+     */
+    static Typespec *resolve(int ref, const vector<Typespec *>& types);
+};
+
+}}  // namespace intermediate::symtab
+
+#endif /* UNITINTERFACE_H_ */
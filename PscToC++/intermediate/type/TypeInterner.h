@@ -0,0 +1,148 @@
+/**
+ * <h1>TypeInterner</h1>
+ *
+ * <p>Share one type specification among all the anonymous subrange
+ * and array types with the same structure.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef TYPEINTERNER_H_
+#define TYPEINTERNER_H_
+
+#include <unordered_map>
+#include <functional>
+
+#include "intermediate/type/Typespec.h"
+#include "intermediate/util/Arena.h"
+
+namespace intermediate { namespace type {
+
+using namespace std;
+using intermediate::util::Arena;
+
+/**
+ * The hash-consing table of anonymous types. A type is built from its
+ * component types after they are interned, so two types have the same
+ * structure exactly when their forms, component pointers, and bounds
+ * are equal, and a type check only needs to compare pointers.
+ * Enumeration and record types are not interned, since each one
+ * declares its own constants or fields.
+ */
+class TypeInterner
+{
+public:
+    /**
+     * Get the anonymous subrange type with the given base type and bounds.
+     * @param baseType the base type.
+     * @param minValue the minimum value.
+     * @param maxValue the maximum value.
+     * @return the type.
+     */
+    Typespec *subrange(Typespec *baseType, int minValue, int maxValue)
+    {
+        Typespec *&type = table[Key { SUBRANGE, baseType, nullptr,
+                                      minValue, maxValue }];
+        if (type == nullptr)
+        {
+            type = Arena::make<Typespec>(SUBRANGE);
+            type->setSubrangeBaseType(baseType);
+            type->setSubrangeMinValue(minValue);
+            type->setSubrangeMaxValue(maxValue);
+        }
+
+        return type;
+    }
+
+    /**
+     * Get the anonymous one-dimensional array type with the given
+     * index and element types.
+     * @param indexType the index type.
+     * @param elementType the element type.
+     * @param elementCount the number of elements.
+     * @return the type.
+     */
+    Typespec *array(Typespec *indexType, Typespec *elementType,
+                    int elementCount)
+    {
+        Typespec *&type = table[Key { ARRAY, indexType, elementType,
+                                      elementCount, 0 }];
+        if (type == nullptr)
+        {
+            type = Arena::make<Typespec>(ARRAY);
+            type->setArrayIndexType(indexType);
+            type->setArrayElementType(elementType);
+            type->setArrayElementCount(elementCount);
+        }
+
+        return type;
+    }
+
+    /**
+     * Determine whether a type is shared by the anonymous types
+     * with its structure, and so must not be given a name.
+     * @param type the type.
+     * @return true if shared.
+     */
+    bool isShared(Typespec *type) const
+    {
+        Key key;
+
+        switch (type->getForm())
+        {
+            case Form::SUBRANGE:
+                key = { SUBRANGE, type->getSubrangeBaseType(), nullptr,
+                        type->getSubrangeMinValue(),
+                        type->getSubrangeMaxValue() };
+                break;
+
+            case Form::ARRAY:
+                key = { ARRAY, type->getArrayIndexType(),
+                        type->getArrayElementType(),
+                        type->getArrayElementCount(), 0 };
+                break;
+
+            default: return false;
+        }
+
+        auto it = table.find(key);
+        return (it != table.end()) && (it->second == type);
+    }
+
+private:
+    /**
+     * The structure of a type.
+     */
+    struct Key
+    {
+        Form form;
+        Typespec *first;   // subrange base type or array index type
+        Typespec *second;  // array element type
+        int low;           // subrange minimum or array element count
+        int high;          // subrange maximum
+
+        bool operator ==(const Key& other) const
+        {
+            return    (form == other.form) && (first == other.first)
+                   && (second == other.second)
+                   && (low == other.low) && (high == other.high);
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator ()(const Key& key) const
+        {
+            size_t h = hash<Typespec *>()(key.first);
+            h = 31*h + hash<Typespec *>()(key.second);
+            h = 31*h + (size_t) key.low;
+            h = 31*h + (size_t) key.high;
+            return 31*h + (size_t) key.form;
+        }
+    };
+
+    unordered_map<Key, Typespec *, KeyHash> table;
+};
+
+}}  // namespace intermediate::type
+
+#endif /* TYPEINTERNER_H_ */
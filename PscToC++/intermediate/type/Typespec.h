@@ -14,11 +14,13 @@
 
 #include "../../Object.h"
 #include "intermediate/symtab/Symtab.h"
+#include "intermediate/util/Arena.h"
 
 namespace intermediate { namespace type {
 
 using namespace std;
 using namespace intermediate::symtab;
+using intermediate::util::Arena;
 
 /**
  * The form of the datatype.
@@ -59,6 +61,7 @@ private:
             Typespec *baseType;
             int minValue;
             int maxValue;
+            unsigned span;  // maxValue - minValue, for range checks
         } subrange;
 
         struct
@@ -95,12 +98,14 @@ public:
         switch (form)
         {
             case Form::ENUMERATION:
-                info.enumeration.constants = new vector<SymtabEntry *>();
+                info.enumeration.constants =
+                                    Arena::make<vector<SymtabEntry *>>();
                 break;
 
             case Form::SUBRANGE:
                 info.subrange.minValue = 0;
                 info.subrange.maxValue = 0;
+                info.subrange.span = 0;
                 info.subrange.baseType = nullptr;
                 break;
 
@@ -191,6 +196,8 @@ public:
     void setSubrangeMinValue(const int min_value)
     {
         info.subrange.minValue = min_value;
+        info.subrange.span = (unsigned) info.subrange.maxValue
+                                                    - (unsigned) min_value;
     }
 
     /**
@@ -206,6 +213,21 @@ public:
     void setSubrangeMaxValue(const int max_value)
     {
         info.subrange.maxValue = max_value;
+        info.subrange.span = (unsigned) max_value
+                                        - (unsigned) info.subrange.minValue;
+    }
+
+    /**
+     * Determine whether a value is within the subrange. A value below
+     * the minimum wraps around to a large unsigned offset, so one
+     * comparison checks both bounds.
+     * @param value the value.
+     * @return true if within the subrange.
+     */
+    bool inSubrange(const int value) const
+    {
+        return    (unsigned) value - (unsigned) info.subrange.minValue
+               <= info.subrange.span;
     }
 
     /**
@@ -314,7 +336,7 @@ public:
      */
     void setRecordTypePath(string typePath)
     {
-        info.record.typePath = new string(typePath);
+        info.record.typePath = Arena::make<string>(typePath);
     }
 };
 
@@ -0,0 +1,128 @@
+#include <cstdlib>
+#include <cstdint>
+
+#include "Arena.h"
+
+namespace intermediate { namespace util {
+
+thread_local Arena *Arena::active = nullptr;
+
+Arena::Arena(size_t blockSize)
+    : blockSize(blockSize), blocks(nullptr), firstBlock(nullptr),
+      cursor(nullptr), limit(nullptr), cleanups(nullptr),
+      firstCleanup(nullptr), objectCount(0), used(0), reserved(0),
+      blockCount(0), peak(0)
+{
+}
+
+Arena *Arena::current()
+{
+    // Never destroyed, so that it outlives every static that points into it.
+    static Arena *process = new Arena();
+
+    return active != nullptr ? active : process;
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+    uintptr_t address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1)
+                                                        & ~(alignment - 1);
+
+    if ((cursor == nullptr) || (address + size > (uintptr_t) limit))
+    {
+        grow(size, alignment);
+        address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1)
+                                                        & ~(alignment - 1);
+    }
+
+    cursor = reinterpret_cast<char *>(address + size);
+    used += size;
+
+    return reinterpret_cast<void *>(address);
+}
+
+void Arena::grow(size_t size, size_t alignment)
+{
+    // An allocation larger than a block gets a block of its own.
+    size_t needed = sizeof(Block) + alignment + size;
+    size_t total = needed > blockSize ? needed : blockSize;
+
+    Block *block = static_cast<Block *>(malloc(total));
+    if (block == nullptr) throw bad_alloc();
+
+    block->size = total;
+    block->next = blocks;
+    if (blocks == nullptr) firstBlock = block;
+    blocks = block;
+
+    cursor = reinterpret_cast<char *>(block + 1);
+    limit = reinterpret_cast<char *>(block) + total;
+
+    reserved += total;
+    blockCount++;
+}
+
+void Arena::adopt(Arena& other)
+{
+    if (other.blocks == nullptr) return;
+
+    // The other arena's objects were created after this one's.
+    if (other.cleanups != nullptr)
+    {
+        other.firstCleanup->next = cleanups;
+        if (cleanups == nullptr) firstCleanup = other.firstCleanup;
+        cleanups = other.cleanups;
+    }
+
+    // Keep allocating from this arena's most recent block.
+    if (blocks == nullptr)
+    {
+        blocks = other.blocks;
+        firstBlock = other.firstBlock;
+        cursor = other.cursor;
+        limit = other.limit;
+    }
+    else
+    {
+        other.firstBlock->next = blocks->next;
+        if (blocks->next == nullptr) firstBlock = other.firstBlock;
+        blocks->next = other.blocks;
+    }
+
+    objectCount += other.objectCount;
+    used        += other.used;
+    reserved    += other.reserved;
+    blockCount  += other.blockCount;
+    if (other.peak > peak) peak = other.peak;
+
+    other.blocks = other.firstBlock = nullptr;
+    other.cleanups = other.firstCleanup = nullptr;
+    other.cursor = other.limit = nullptr;
+    other.objectCount = other.used = other.reserved = other.blockCount = 0;
+}
+
+void Arena::release()
+{
+    for (Cleanup *cleanup = cleanups; cleanup != nullptr; )
+    {
+        Cleanup *next = cleanup->next;  // in the arena, so read it first
+        cleanup->destroy(cleanup->object);
+        cleanup = next;
+    }
+
+    for (Block *block = blocks; block != nullptr; )
+    {
+        Block *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    peak = getPeak();
+
+    blocks = firstBlock = nullptr;
+    cleanups = firstCleanup = nullptr;
+    cursor = limit = nullptr;
+    objectCount = used = reserved = blockCount = 0;
+}
+
+}}  // namespace intermediate::util
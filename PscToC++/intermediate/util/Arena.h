@@ -0,0 +1,191 @@
+/**
+ * <h1>Arena</h1>
+ *
+ * <p>Allocate the symbol tables, their entries, and the type
+ * specifications of one translation from large blocks, and free
+ * them all at once when the translation is done.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace intermediate { namespace util {
+
+using namespace std;
+
+class Arena
+{
+public:
+    /**
+     * Make an arena current on this thread for as long as
+     * the scope lasts, then restore the previous one.
+     */
+    class Scope
+    {
+    public:
+        Scope(Arena *arena) : previous(active) { active = arena; }
+        ~Scope() { active = previous; }
+
+    private:
+        Arena *previous;
+    };
+
+    /**
+     * Constructor.
+     * @param blockSize the size of each block to allocate from.
+     */
+    Arena(size_t blockSize = 64*1024);
+
+    /**
+     * Destructor. Destroy the objects and free the blocks.
+     */
+    virtual ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator =(const Arena&) = delete;
+
+    /**
+     * Get the arena current on this thread. Objects created when no
+     * arena is current are allocated in one that lasts as long as
+     * the process.
+     * @return the arena.
+     */
+    static Arena *current();
+
+    /**
+     * Create an object in the current arena.
+     * @param args the constructor arguments.
+     * @return the object.
+     */
+    template <class T, class... Args>
+    static T *make(Args&&... args)
+    {
+        return current()->create<T>(forward<Args>(args)...);
+    }
+
+    /**
+     * Create an object in this arena. Its destructor runs when
+     * the arena is released, unless it has nothing to do.
+     * @param args the constructor arguments.
+     * @return the object.
+     */
+    template <class T, class... Args>
+    T *create(Args&&... args)
+    {
+        T *object = new (allocate(sizeof(T), alignof(T)))
+                                                T(forward<Args>(args)...);
+        objectCount++;
+
+        if (!is_trivially_destructible<T>::value)
+        {
+            Cleanup *cleanup = new (allocate(sizeof(Cleanup),
+                                             alignof(Cleanup))) Cleanup;
+            cleanup->object = object;
+            cleanup->destroy = [] (void *p) { static_cast<T *>(p)->~T(); };
+            cleanup->next = cleanups;
+            if (cleanups == nullptr) firstCleanup = cleanup;
+            cleanups = cleanup;
+        }
+
+        return object;
+    }
+
+    /**
+     * Allocate uninitialized memory.
+     * @param size the number of bytes.
+     * @param alignment the alignment, a power of two.
+     * @return the memory.
+     */
+    void *allocate(size_t size, size_t alignment);
+
+    /**
+     * Take over the objects and blocks of another arena, such as one
+     * that a thread allocated into, which is left empty.
+     * @param other the other arena.
+     */
+    void adopt(Arena& other);
+
+    /**
+     * Destroy the objects in the reverse order of their creation
+     * and free the blocks. The arena can be used again.
+     */
+    void release();
+
+    /**
+     * @return the number of objects created since the last release.
+     */
+    size_t getObjectCount() const { return objectCount; }
+
+    /**
+     * @return the number of bytes allocated since the last release.
+     */
+    size_t getUsed() const { return used; }
+
+    /**
+     * @return the number of bytes in the blocks.
+     */
+    size_t getReserved() const { return reserved; }
+
+    /**
+     * @return the number of blocks.
+     */
+    size_t getBlockCount() const { return blockCount; }
+
+    /**
+     * @return the most bytes ever allocated between releases.
+     */
+    size_t getPeak() const { return used > peak ? used : peak; }
+
+private:
+    /**
+     * The header of each block. The memory follows it.
+     */
+    struct Block
+    {
+        Block *next;
+        size_t size;
+    };
+
+    /**
+     * How to destroy an object when the arena is released.
+     */
+    struct Cleanup
+    {
+        Cleanup *next;
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    size_t blockSize;     // the usual size of a block
+    Block *blocks;        // the most recent first
+    Block *firstBlock;    // the last of the list
+    char *cursor;         // the next free byte of the most recent block
+    char *limit;          // the end of the most recent block
+    Cleanup *cleanups;    // the most recently created object first
+    Cleanup *firstCleanup;  // the last of the list
+
+    size_t objectCount;
+    size_t used;
+    size_t reserved;
+    size_t blockCount;
+    size_t peak;
+
+    static thread_local Arena *active;
+
+    /**
+     * Start a new block large enough for an allocation.
+     * @param size the size of the allocation.
+     * @param alignment its alignment.
+     */
+    void grow(size_t size, size_t alignment);
+};
+
+}}  // namespace intermediate::util
+
+#endif /* ARENA_H_ */
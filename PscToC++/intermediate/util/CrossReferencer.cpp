@@ -7,8 +7,11 @@
  * <p>For instructional purposes only.  No warranties.</p>
  */
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cstdio>
 
 #include "antlr4-runtime.h"
 
@@ -27,34 +30,28 @@ using namespace intermediate::type;
 
 const int CrossReferencer::NAME_WIDTH = 16;
 
-const string CrossReferencer::NAME_FORMAT = string("%-") +
-                                            to_string(NAME_WIDTH) +
-                                            string("s");
 const string CrossReferencer::NUMBERS_LABEL = " Line numbers    ";
 const string CrossReferencer::NUMBERS_UNDERLINE = " ------------    ";
 const string CrossReferencer::NUMBER_FORMAT = " %03d";
-const string CrossReferencer::ENUM_CONST_FORMAT = string("%") +
-                                                  to_string(NAME_WIDTH) +
-                                                  string("s = %s");
 
 const int CrossReferencer::LABEL_WIDTH  = NUMBERS_LABEL.length();
 const int CrossReferencer::INDENT_WIDTH = NAME_WIDTH + LABEL_WIDTH;
 
 const string CrossReferencer::INDENT = string(INDENT_WIDTH, ' ');
 
-void CrossReferencer::print(const SymtabStack *symtabStack) const
+void CrossReferencer::print(SymtabEntry *programId)
 {
-    cout << "\n===== CROSS-REFERENCE TABLE =====" << endl;
+    out << "\n===== CROSS-REFERENCE TABLE =====\n";
 
-    SymtabEntry *programId = symtabStack->getProgramId();
     printRoutine(programId);
+    out.flush();
 }
 
-void CrossReferencer::printRoutine(SymtabEntry *routineId) const
+void CrossReferencer::printRoutine(SymtabEntry *routineId)
 {
     Kind kind = routineId->getKind();
-    cout << endl << "*** " << KIND_STRINGS[(int) kind]
-         << " " << routineId->getName() << " ***" << endl;
+    out << "\n*** " << KIND_STRINGS[(int) kind]
+        << " " << routineId->getName() << " ***\n";
     printColumnHeadings();
 
     // Print the entries in the routine's symbol table.
@@ -73,48 +70,66 @@ void CrossReferencer::printRoutine(SymtabEntry *routineId) const
     }
 }
 
-void CrossReferencer::printColumnHeadings() const
+void CrossReferencer::printColumnHeadings()
 {
-    cout << endl;
-    printf(NAME_FORMAT.c_str(), "Identifier");
-    cout << NUMBERS_LABEL     << "Type specification" << endl;
-    printf(NAME_FORMAT.c_str(), "----------");
-    cout << NUMBERS_UNDERLINE << "------------------" << endl;
+    out << "\n";
+    printName("Identifier");
+    out << NUMBERS_LABEL     << "Type specification\n";
+    printName("----------");
+    out << NUMBERS_UNDERLINE << "------------------\n";
+}
+
+void CrossReferencer::printName(const string& name)
+{
+    out << name;
+    if ((int) name.length() < NAME_WIDTH)
+    {
+        out.write(INDENT.data(), NAME_WIDTH - name.length());
+    }
 }
 
 void CrossReferencer::printSymtab(Symtab *symtab,
-                                  vector<Typespec *>& recordTypes) const
+                                  vector<Typespec *>& recordTypes)
 {
+    // Sort the entries by name. The vector is reused for each table,
+    // and a table's entries are all printed before the next is sorted.
+    const vector<SymtabEntry *>& entries = symtab->entries();
+    sorted.assign(entries.begin(), entries.end());
+    sort(sorted.begin(), sorted.end(),
+         [] (SymtabEntry *a, SymtabEntry *b)
+         {
+             return a->getName() < b->getName();
+         });
+
     // Loop over the sorted list of symbol table entries.
-    vector<SymtabEntry *> sorted = symtab->sortedEntries();
     for (SymtabEntry *entry : sorted)
     {
         vector<int> *line_numbers = entry->getLineNumbers();
 
         // For each entry, print the identifier name
         // followed by the line numbers.
-        printf(NAME_FORMAT.c_str(), entry->getName().c_str());
-        if (line_numbers->size() > 0)
+        printName(entry->getName());
+        for (int line_number : *line_numbers)
         {
-            for (int line_number : *line_numbers)
-            {
-                printf(NUMBER_FORMAT.c_str(), line_number);
-            }
+            char text[16];
+            int length = snprintf(text, sizeof(text),
+                                  NUMBER_FORMAT.c_str(), line_number);
+            out.write(text, length);
         }
 
         // Print the symbol table entry.
-        cout << endl;
+        out << "\n";
         printEntry(entry, recordTypes);
     }
 }
 
 void CrossReferencer::printEntry(SymtabEntry *entry,
-                                 vector<Typespec *>& recordTypes) const
+                                 vector<Typespec *>& recordTypes)
 {
     Kind kind = entry->getKind();
     int nestingLevel = entry->getSymtab()->getNestingLevel();
-    cout << INDENT << "Defined as: " << KIND_STRINGS[(int) kind] << endl;
-    cout << INDENT << "Scope nesting level: " << nestingLevel << endl;
+    out << INDENT << "Defined as: " << KIND_STRINGS[(int) kind] << "\n";
+    out << INDENT << "Scope nesting level: " << nestingLevel << "\n";
 
     // Print the type specification.
     Typespec *type = entry->getType();
@@ -125,7 +140,7 @@ void CrossReferencer::printEntry(SymtabEntry *entry,
         case Kind::CONSTANT:
         {
             Object value = entry->getValue();
-            cout << INDENT << "Value: " << toString(value, type) << endl;
+            out << INDENT << "Value: " << toString(value, type) << "\n";
 
             // Print the type details only if the type is unnamed.
             if (type->getIdentifier() == nullptr)
@@ -139,7 +154,7 @@ void CrossReferencer::printEntry(SymtabEntry *entry,
         case Kind::ENUMERATION_CONSTANT:
         {
             Object value = entry->getValue();
-            cout << INDENT << "Value = " << toString(value, type) << endl;
+            out << INDENT << "Value = " << toString(value, type) << "\n";
 
             break;
         }
@@ -170,7 +185,7 @@ void CrossReferencer::printEntry(SymtabEntry *entry,
     }
 }
 
-void CrossReferencer::printType(Typespec *typespec) const
+void CrossReferencer::printType(Typespec *typespec)
 {
     if (typespec != nullptr)
     {
@@ -179,14 +194,13 @@ void CrossReferencer::printType(Typespec *typespec) const
         string type_name = type_id != nullptr ? type_id->getName()
                                               : "<unnamed>";
 
-        cout << INDENT << "Type form = " << FORM_STRINGS[(int) form]
-             << ", Type id = " << type_name << endl;
+        out << INDENT << "Type form = " << FORM_STRINGS[(int) form]
+            << ", Type id = " << type_name << "\n";
     }
 }
 
 void CrossReferencer::printTypeDetail(Typespec *type,
                                       vector<Typespec *>& recordTypes)
-    const
 {
     Form form = type->getForm();
 
@@ -196,7 +210,7 @@ void CrossReferencer::printTypeDetail(Typespec *type,
         {
             vector<SymtabEntry *> *constant_ids = type->getEnumerationConstants();
 
-            cout << INDENT << "--- Enumeration constants ---" << endl;
+            out << INDENT << "--- Enumeration constants ---\n";
 
             // Print each enumeration constant and its value.
             for (SymtabEntry *constant_id : *constant_ids)
@@ -204,10 +218,12 @@ void CrossReferencer::printTypeDetail(Typespec *type,
                 string name = constant_id->getName();
                 Object value = constant_id->getValue();
 
-                cout << INDENT;
-                printf(ENUM_CONST_FORMAT.c_str(), name.c_str(),
-                       toString(value, type).c_str());
-                cout << endl;
+                out << INDENT;
+                if ((int) name.length() < NAME_WIDTH)
+                {
+                    out.write(INDENT.data(), NAME_WIDTH - name.length());
+                }
+                out << name << " = " << toString(value, type) << "\n";
             }
 
             break;
@@ -219,7 +235,7 @@ void CrossReferencer::printTypeDetail(Typespec *type,
             int max_value = type->getSubrangeMaxValue();
             Typespec *baseTypespec = type->baseType();
 
-            cout << INDENT + "--- Base type ---" << endl;
+            out << INDENT + "--- Base type ---\n";
             printType(baseTypespec);
 
             // Print the base type details only if the type is unnamed.
@@ -228,8 +244,8 @@ void CrossReferencer::printTypeDetail(Typespec *type,
                 printTypeDetail(baseTypespec, recordTypes);
             }
 
-            cout << INDENT << "Range = ";
-            cout << min_value << ".." << max_value << endl;
+            out << INDENT << "Range = ";
+            out << min_value << ".." << max_value << "\n";
 
             break;
         }
@@ -240,7 +256,7 @@ void CrossReferencer::printTypeDetail(Typespec *type,
             Typespec *elementType = type->getArrayElementType();
             int count = type->getArrayElementCount();
 
-            cout << INDENT << "--- INDEX TYPE ---" << endl;
+            out << INDENT << "--- INDEX TYPE ---\n";
             printType(indexType);
 
             // Print the index type details only if the type is unnamed.
@@ -249,9 +265,9 @@ void CrossReferencer::printTypeDetail(Typespec *type,
                 printTypeDetail(indexType, recordTypes);
             }
 
-            cout << INDENT << "--- ELEMENT TYPE ---" << endl;
+            out << INDENT << "--- ELEMENT TYPE ---\n";
             printType(elementType);
-            cout << INDENT << count << " elements" << endl;
+            out << INDENT << count << " elements\n";
 
             // Print the element type details only if the type is unnamed.
             if (elementType->getIdentifier() == nullptr)
@@ -272,7 +288,7 @@ void CrossReferencer::printTypeDetail(Typespec *type,
     }
 }
 
-void CrossReferencer::printRecords(vector<Typespec *>& recordTypes) const
+void CrossReferencer::printRecords(vector<Typespec *>& recordTypes)
 {
     for (Typespec *recordType : recordTypes)
     {
@@ -280,7 +296,7 @@ void CrossReferencer::printRecords(vector<Typespec *>& recordTypes) const
         string name = record_id != nullptr ? record_id->getName()
                                            : "<unnamed>";
 
-        cout << endl << "--- RECORD " << name << " ---" << endl;
+        out << "\n--- RECORD " << name << " ---\n";
         printColumnHeadings();
 
         // Print the entries in the record's symbol table.
@@ -306,4 +322,87 @@ string CrossReferencer::toString(Object value, Typespec *type) const
     else  /* enumeration constant */          return to_string(value.as<int>());
 }
 
+string CrossReferencer::writeJson(SymtabEntry *programId)
+{
+    string fileName = programId->getName() + ".xref.json";
+    ofstream json(fileName);
+
+    if (!json)
+    {
+        cout << "ERROR: Failed to open cross-reference index \""
+             << fileName << "\"." << endl;
+        exit(-1);
+    }
+
+    // One object per line, in the order the symbols were entered.
+    bool first = true;
+    json << "{\"program\": \"" << programId->getName()
+         << "\", \"symbols\": [";
+    writeJsonRoutine(json, programId, first);
+    json << "\n]}\n";
+
+    return fileName;
+}
+
+void CrossReferencer::writeJsonRoutine(ostream& json, SymtabEntry *routineId,
+                                       bool& first) const
+{
+    writeJsonSymtab(json, routineId->getRoutineSymtab(),
+                    routineId->getName(), first);
+
+    vector<SymtabEntry *> *routineIds = routineId->getSubroutines();
+    if (routineIds != nullptr)
+    {
+        for (SymtabEntry *id : *routineIds) writeJsonRoutine(json, id, first);
+    }
+}
+
+void CrossReferencer::writeJsonSymtab(ostream& json, Symtab *symtab,
+                                      const string& scope, bool& first) const
+{
+    for (SymtabEntry *entry : symtab->entries())
+    {
+        Typespec *type = entry->getType();
+
+        json << (first ? "\n" : ",\n");
+        json << "{\"name\": \"" << entry->getName()
+             << "\", \"scope\": \"" << scope
+             << "\", \"level\": " << symtab->getNestingLevel()
+             << ", \"kind\": \"" << KIND_STRINGS[(int) entry->getKind()]
+             << "\", \"type\": ";
+        first = false;
+
+        // A named datatype by its name, else by its form.
+        if (type == nullptr) json << "null";
+        else if (type->getIdentifier() != nullptr)
+        {
+            json << "\"" << type->getIdentifier()->getName() << "\"";
+        }
+        else json << "\"" << FORM_STRINGS[(int) type->getForm()] << "\"";
+
+        json << ", \"lines\": [";
+        const char *separator = "";
+        for (int lineNumber : *entry->getLineNumbers())
+        {
+            json << separator << lineNumber;
+            separator = ", ";
+        }
+        json << "]}";
+    }
+
+    // The fields of the record types defined in this table.
+    for (SymtabEntry *entry : symtab->entries())
+    {
+        Typespec *type = entry->getType();
+
+        if (   (entry->getKind() == Kind::TYPE) && (type != nullptr)
+            && (type->getForm() == Form::RECORD)
+            && (type->getIdentifier() == entry))
+        {
+            writeJsonSymtab(json, type->getRecordSymtab(),
+                            type->getRecordTypePath(), first);
+        }
+    }
+}
+
 }}  // namespace intermediate ::util
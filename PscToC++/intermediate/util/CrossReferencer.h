@@ -9,6 +9,7 @@
 #ifndef CROSSREFERENCER_H_
 #define CROSSREFERENCER_H_
 
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -24,23 +25,49 @@ using namespace std;
 using namespace intermediate::symtab;
 using namespace intermediate::type;
 
+/**
+ * What cross-reference output to produce after semantic analysis.
+ */
+struct CrossReferenceOptions
+{
+    bool table = false;  // print the cross-reference table
+    bool json = false;   // write the index of symbols as a JSON file
+};
+
 class CrossReferencer
 {
 public:
+    /**
+     * Constructor.
+     * @param out the stream to print the cross-reference table to.
+     */
+    CrossReferencer(ostream& out = cout) : out(out) {}
+
     /**
      * Print the cross-reference table.
-     * @param symtab_stack the symbol table stack.
+     * @param programId the symbol table entry of the program identifier.
+     */
+    void print(SymtabEntry *programId);
+
+    /**
+     * Write an index of every symbol, with its scope, kind, datatype,
+     * and line numbers, to the JSON file programName.xref.json.
+     * Entries are written in the order they were entered.
+     * @param programId the symbol table entry of the program identifier.
+     * @return the name of the file.
      */
-    void print(const SymtabStack *symtab_stack) const;
+    string writeJson(SymtabEntry *programId);
 
 private:
+    ostream& out;
+    vector<SymtabEntry *> sorted;  // reused to sort each symbol table
+
+
     static const int NAME_WIDTH;
 
-    static const string NAME_FORMAT;
     static const string NUMBERS_LABEL;
     static const string NUMBERS_UNDERLINE;
     static const string NUMBER_FORMAT;
-    static const string ENUM_CONST_FORMAT;
 
     static const int LABEL_WIDTH;
     static const int INDENT_WIDTH;
@@ -51,12 +78,12 @@ private:
      * Print a cross-reference table for a routine.
      * @param routineId the routine identifier's symbol table entry.
      */
-    void printRoutine(SymtabEntry *routineId) const;
+    void printRoutine(SymtabEntry *routineId);
 
     /**
      * Print column headings.
      */
-    void printColumnHeadings() const;
+    void printColumnHeadings();
 
     /**
      * Print the entries in a symbol table.
@@ -64,20 +91,20 @@ private:
      * @param recordTypes the list to fill with RECORD type specifications.
      */
     void printSymtab(Symtab *symtab,
-                     vector<Typespec *>& recordTypes) const;
+                     vector<Typespec *>& recordTypes);
 
     /**
      * Print a symbol table entry.
      * @param entry the symbol table entry.
      * @param recordTypes the list to fill with RECORD type specifications.
      */
-    void printEntry(SymtabEntry *entry, vector<Typespec *>& recordTypes) const;
+    void printEntry(SymtabEntry *entry, vector<Typespec *>& recordTypes);
 
     /**
      * Print a type specification.
      * @param typespec the type specification.
      */
-    void printType(Typespec *typespec) const;
+    void printType(Typespec *typespec);
 
     /**
      * Print the details of a type specification.
@@ -85,13 +112,13 @@ private:
      * @param recordTypes the list to fill with RECORD type specifications.
      */
     void printTypeDetail(Typespec *typespec,
-                         vector<Typespec *>& recordTypes) const;
+                         vector<Typespec *>& recordTypes);
 
     /**
      * Print cross-reference tables for records defined in the routine.
      * @param recordTypes the list to fill with RECORD type specifications.
      */
-    void printRecords(vector<Typespec *>& recordTypes) const;
+    void printRecords(vector<Typespec *>& recordTypes);
 
     /**
      * Convert a value to a string.
@@ -100,6 +127,33 @@ private:
      * @return the string.
      */
     string toString(Object dataValue, Typespec *type) const;
+
+    /**
+     * Print an identifier name left-justified in the name column.
+     * @param name the name.
+     */
+    void printName(const string& name);
+
+    /**
+     * Write the JSON objects of the entries of a symbol table,
+     * followed by those of the fields of the record types it defines.
+     * @param json the JSON file.
+     * @param symtab the symbol table.
+     * @param scope the name of the routine or record type path.
+     * @param first true until the first object is written.
+     */
+    void writeJsonSymtab(ostream& json, Symtab *symtab, const string& scope,
+                         bool& first) const;
+
+    /**
+     * Write the JSON objects of the entries of a routine's symbol table
+     * and of its subroutines.
+     * @param json the JSON file.
+     * @param routineId the routine identifier's symbol table entry.
+     * @param first true until the first object is written.
+     */
+    void writeJsonRoutine(ostream& json, SymtabEntry *routineId,
+                          bool& first) const;
 };
 
 }}  // namespace wci::util
@@ -0,0 +1,80 @@
+#include "ThreadPool.h"
+
+namespace intermediate { namespace util {
+
+ThreadPool::ThreadPool()
+    : task(nullptr), count(0), next(0), busy(0), batch(0), stopping(false)
+{
+    int size = thread::hardware_concurrency();
+
+    for (int i = 1; i < size; i++)
+    {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (thread& worker : workers) worker.join();
+}
+
+void ThreadPool::run(int count, const function<void (int)>& task)
+{
+    // Not worth waking the workers.
+    if (workers.empty() || (count < 2))
+    {
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        this->task  = &task;
+        this->count = count;
+        next = 0;
+        busy = workers.size();
+        batch++;
+    }
+    wake.notify_all();
+
+    drain();
+
+    unique_lock<mutex> guard(lock);
+    finished.wait(guard, [this] { return busy == 0; });
+    this->task = nullptr;
+}
+
+void ThreadPool::work()
+{
+    int seen = 0;
+
+    for (;;)
+    {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard,
+                      [this, seen] { return stopping || (batch != seen); });
+
+            if (stopping) return;
+            seen = batch;
+        }
+
+        drain();
+
+        lock_guard<mutex> guard(lock);
+        if (--busy == 0) finished.notify_one();
+    }
+}
+
+void ThreadPool::drain()
+{
+    for (int i = next++; i < count; i = next++) (*task)(i);
+}
+
+}}  // namespace intermediate::util
@@ -0,0 +1,77 @@
+/**
+ * <h1>ThreadPool</h1>
+ *
+ * <p>A fixed set of worker threads that run batches of independent tasks.</p>
+ *
+ * <p>For instructional purposes only.  No warranties.</p>
+ */
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace intermediate { namespace util {
+
+using namespace std;
+
+class ThreadPool
+{
+public:
+    /**
+     * Constructor. The thread that calls run() also runs tasks,
+     * so the pool starts one worker fewer than the hardware threads.
+     */
+    ThreadPool();
+
+    /**
+     * Destructor. Stop and join the workers.
+     */
+    virtual ~ThreadPool();
+
+    /**
+     * Get the number of threads that run tasks, including the caller's.
+     * @return the number of threads.
+     */
+    int getSize() const { return workers.size() + 1; }
+
+    /**
+     * Run a batch of tasks and wait for all of them to finish.
+     * The tasks are handed out in index order, but they can
+     * finish in any order.
+     * @param count the number of tasks.
+     * @param task the task to run, called with each index from 0 to count-1.
+     */
+    void run(int count, const function<void (int)>& task);
+
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake;       // signals a new batch or stopping
+    condition_variable finished;   // signals the last busy worker is done
+
+    const function<void (int)> *task;  // the current batch
+    int count;                         // its number of tasks
+    atomic<int> next;                  // index of the next task to hand out
+    int busy;                          // workers still on the batch
+    int batch;                         // number of batches started
+    bool stopping;
+
+    /**
+     * The loop of each worker thread.
+     */
+    void work();
+
+    /**
+     * Run tasks of the current batch until none are left.
+     */
+    void drain();
+};
+
+}}  // namespace intermediate::util
+
+#endif /* THREADPOOL_H_ */